@@ -3,3 +3,6 @@
 
 /* Define if libgit2 is available */
 #cmakedefine01 HAVE_LIBGIT2
+
+/* Define to record tracing spans on hot paths (see tracing.h) */
+#cmakedefine01 ENABLE_TRACING
@@ -0,0 +1,556 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "batch.h"
+
+#include <archive.h>
+#include <backgroundmanager.h>
+#include <basketcache.h>
+#include <basketscene.h>
+#include <decoratedbasket.h>
+#include <global.h>
+#include <htmlexporter.h>
+#include <settings.h>
+#include <softwareimporters.h>
+#include <tag.h>
+#include <xmlwork.h>
+
+#include <KConfig>
+#include <KLocalizedString>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QScopedPointer>
+#include <QSet>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QXmlStreamReader>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtXml/QDomDocument>
+
+namespace
+{
+QString errorMessage(const Archive::IOErrorCode code)
+{
+    switch (code) {
+    case Archive::IOErrorCode::FailedToOpenResource:
+        return i18n("Failed to open a file resource.");
+    case Archive::IOErrorCode::NotABasketArchive:
+        return i18n("This file is not a basket archive.");
+    case Archive::IOErrorCode::CorruptedBasketArchive:
+        return i18n("This file is corrupted. It can not be opened.");
+    case Archive::IOErrorCode::DestinationExists:
+        return i18n("The destination path already exists.");
+    case Archive::IOErrorCode::IncompatibleBasketVersion:
+        return i18n("This file supplied file format is not supported");
+    case Archive::IOErrorCode::PossiblyCompatibleBasketVersion:
+        return i18n("This file was created with a more recent version of BasKet Note Pads. It might not be fully supported");
+    case Archive::IOErrorCode::NoError:
+        break;
+    }
+    return {};
+}
+
+Batch::Result archiveResult(const QString &input, Archive::IOErrorCode code, const QElapsedTimer &timer)
+{
+    Batch::Result result;
+    result.input = input;
+    result.elapsedMs = timer.elapsed();
+    result.success = (code == Archive::IOErrorCode::NoError || code == Archive::IOErrorCode::PossiblyCompatibleBasketVersion);
+    QString message = errorMessage(code);
+    if (!message.isEmpty())
+        result.messages.append(message);
+    return result;
+}
+
+/// The folder names of every basket of a baskets.xml tree, children included:
+QStringList basketFolders(const QString &basketTreePath, bool *ok)
+{
+    QStringList folders;
+    QFile basketTree(basketTreePath);
+    *ok = basketTree.open(QIODevice::ReadOnly);
+    if (!*ok)
+        return folders;
+
+    QXmlStreamReader xml(&basketTree);
+    while (!xml.atEnd()) {
+        if (xml.readNext() == QXmlStreamReader::StartElement && xml.name() == QStringLiteral("basket")) {
+            QString folderName = xml.attributes().value(QStringLiteral("folderName")).toString();
+            if (!folderName.isEmpty())
+                folders.append(folderName);
+        }
+    }
+    *ok = !xml.hasError();
+    return folders;
+}
+
+/// What the check of a single basket found:
+struct BasketCheck {
+    Batch::Result result;
+    QSet<QString> referencedFiles; // eg. "basket1/note3.html"
+    bool parsed = false;
+};
+
+BasketCheck checkBasket(const QString &basketsFolder, const QString &folderName)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    BasketCheck check;
+    check.result.input = folderName;
+    check.result.success = true;
+
+    if (!QFileInfo(basketsFolder + folderName).isDir()) {
+        check.result.messages.append(i18n("The folder %1 does not exist.", folderName));
+        check.result.success = false;
+    }
+
+    QFile basketFile(basketsFolder + folderName + QStringLiteral(".basket"));
+    if (!basketFile.open(QIODevice::ReadOnly)) {
+        check.result.messages.append(i18n("The .basket file of %1 does not exist.", folderName));
+        check.result.success = false;
+        check.result.elapsedMs = timer.elapsed();
+        return check;
+    }
+
+    // Note contents are stored in a file for every type but these:
+    static const QSet<QString> typesWithoutFile = {QStringLiteral("link"), QStringLiteral("cross_reference"), QStringLiteral("color")};
+
+    QXmlStreamReader xml(&basketFile);
+    bool inFileNote = false;
+    int notesCount = 0;
+    while (!xml.atEnd()) {
+        QXmlStreamReader::TokenType token = xml.readNext();
+        if (token == QXmlStreamReader::StartElement) {
+            // Keep compatible with 0.6.0 Alpha 1 ("item" instead of "note"):
+            if (xml.name() == QStringLiteral("note") || xml.name() == QStringLiteral("item")) {
+                ++notesCount;
+                inFileNote = !typesWithoutFile.contains(xml.attributes().value(QStringLiteral("type")).toString());
+            } else if (inFileNote && xml.name() == QStringLiteral("content")) {
+                QString fileName = xml.readElementText();
+                if (!fileName.isEmpty()) {
+                    check.referencedFiles.insert(folderName + fileName);
+                    if (!QFileInfo::exists(basketsFolder + folderName + fileName)) {
+                        check.result.messages.append(i18n("%1 NOT FOUND!", folderName + fileName));
+                        check.result.success = false;
+                    }
+                }
+            }
+        } else if (token == QXmlStreamReader::EndElement && (xml.name() == QStringLiteral("note") || xml.name() == QStringLiteral("item"))) {
+            inFileNote = false;
+        }
+    }
+
+    if (xml.hasError()) {
+        // Probably an encrypted basket: we cannot know which files it uses, so none of them will be considered orphaned.
+        check.result.messages.append(i18n("Could not parse the .basket file of %1 (encrypted?): %2", folderName, xml.errorString()));
+    } else {
+        check.parsed = true;
+        check.result.messages.append(i18np("%1 note", "%1 notes", notesCount));
+    }
+
+    check.result.elapsedMs = timer.elapsed();
+    return check;
+}
+}
+
+Batch::Batch(QCommandLineParser *parser,
+             const QCommandLineOption &extract,
+             const QCommandLineOption &pack,
+             const QCommandLineOption &check,
+             const QCommandLineOption &cleanup,
+             const QCommandLineOption &exportHtml,
+             const QCommandLineOption &exportTo,
+             const QCommandLineOption &importText,
+             const QCommandLineOption &importInto,
+             const QCommandLineOption &separator,
+             const QCommandLineOption &folder,
+             const QCommandLineOption &output,
+             const QCommandLineOption &jobs,
+             const QCommandLineOption &force)
+    : m_parser(parser)
+    , m_extract(extract)
+    , m_pack(pack)
+    , m_check(check)
+    , m_cleanup(cleanup)
+    , m_exportHtml(exportHtml)
+    , m_exportTo(exportTo)
+    , m_importText(importText)
+    , m_importInto(importInto)
+    , m_separator(separator)
+    , m_folder(folder)
+    , m_output(output)
+    , m_jobs(jobs)
+    , m_force(force)
+{
+}
+
+Batch::~Batch()
+{
+    qDeleteAll(m_baskets);
+    delete Global::backgroundManager;
+    Global::backgroundManager = nullptr;
+    BasketCache::waitForRebuilds(); // Do not quit in the middle of writing a cache
+}
+
+int Batch::runMain()
+{
+    if (!m_parser->isSet(m_extract) && !m_parser->isSet(m_pack) && !m_parser->isSet(m_check) && !m_parser->isSet(m_exportHtml)
+        && !m_parser->isSet(m_importText)) {
+        qCritical().noquote() << i18n("You need to provide at least one --extract/-x, --pack/-c, --check, --export-html or --import-text option");
+        return 1;
+    }
+
+    if (m_parser->isSet(m_output) && !QFileInfo(m_parser->value(m_output)).isDir()) {
+        qCritical().noquote() << i18n("Output directory does not exist.");
+        return 1;
+    }
+
+    if (m_parser->isSet(m_jobs)) {
+        bool ok = false;
+        int jobs = m_parser->value(m_jobs).toInt(&ok);
+        if (!ok || jobs <= 0) {
+            qCritical().noquote() << i18n("The number of jobs must be a positive number.");
+            return 1;
+        }
+        QThreadPool::globalInstance()->setMaxThreadCount(jobs);
+    }
+
+    bool ret = true;
+
+    if (m_parser->isSet(m_extract)) {
+        ret = extractAll() && ret;
+    }
+    if (m_parser->isSet(m_pack)) {
+        ret = packAll() && ret;
+    }
+    if (m_parser->isSet(m_check)) {
+        ret = check() && ret;
+    }
+    if (m_parser->isSet(m_importText) || m_parser->isSet(m_exportHtml)) {
+        if (!loadBaskets()) {
+            ret = false;
+        } else {
+            if (m_parser->isSet(m_importText)) {
+                ret = importAll() && ret;
+            }
+            if (m_parser->isSet(m_exportHtml)) {
+                ret = exportAll() && ret;
+            }
+        }
+    }
+
+    return ret ? 0 : 1;
+}
+
+QString Batch::destinationFor(const QString &input, const QString &suffix) const
+{
+    QString folder;
+    if (m_parser->isSet(m_output)) {
+        folder = m_parser->value(m_output);
+    } else {
+        QDir inputPath(QFileInfo(input).absoluteFilePath());
+        inputPath.cdUp();
+        folder = inputPath.absolutePath();
+    }
+    return folder + QDir::separator() + QFileInfo(input).baseName() + suffix;
+}
+
+bool Batch::extractAll()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool protectDestination = !m_parser->isSet(m_force);
+    const QList<Result> results = QtConcurrent::blockingMapped<QList<Result>>(m_parser->values(m_extract), [this, protectDestination](const QString &input) {
+        QElapsedTimer jobTimer;
+        jobTimer.start();
+        Archive::IOErrorCode code = Archive::extractArchive(input, destinationFor(input, QStringLiteral("_baskets")), protectDestination);
+        return archiveResult(input, code, jobTimer);
+    });
+
+    return report(i18n("Extract"), results, timer.elapsed());
+}
+
+bool Batch::packAll()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool protectDestination = !m_parser->isSet(m_force);
+    const QList<Result> results = QtConcurrent::blockingMapped<QList<Result>>(m_parser->values(m_pack), [this, protectDestination](const QString &input) {
+        QElapsedTimer jobTimer;
+        jobTimer.start();
+        Archive::IOErrorCode code =
+            Archive::createArchiveFromSource(input, QString(), destinationFor(input, QStringLiteral(".baskets")), protectDestination);
+        return archiveResult(input, code, jobTimer);
+    });
+
+    return report(i18n("Pack"), results, timer.elapsed());
+}
+
+bool Batch::check()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QString basketsFolder = QDir::cleanPath(m_parser->value(m_check)) + QStringLiteral("/baskets/");
+    bool ok = false;
+    const QStringList folders = basketFolders(basketsFolder + QStringLiteral("baskets.xml"), &ok);
+    if (!ok) {
+        qCritical().noquote() << i18n("Could not read %1", basketsFolder + QStringLiteral("baskets.xml"));
+        return false;
+    }
+
+    // List what is on disk, like BNPView::checkCleanup() does:
+    QStringList dirList;
+    QStringList fileList;
+    QDir topDir(basketsFolder, QString(), QDir::Name | QDir::IgnoreCase, QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot);
+    for (const QFileInfo &topEntry : topDir.entryInfoList()) {
+        if (topEntry.isDir()) {
+            dirList << topEntry.fileName() + QLatin1Char('/');
+            QDir basketDir(topEntry.absoluteFilePath(), QString(), QDir::Name | QDir::IgnoreCase, QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot);
+            for (const QString &subEntry : basketDir.entryList())
+                fileList << topEntry.fileName() + QLatin1Char('/') + subEntry;
+        } else if (topEntry.fileName() != QStringLiteral("baskets.xml")) {
+            fileList << topEntry.fileName();
+        }
+    }
+
+    // Parse every basket in parallel:
+    const QList<BasketCheck> checks = QtConcurrent::blockingMapped<QList<BasketCheck>>(folders, [&basketsFolder](const QString &folderName) {
+        return checkBasket(basketsFolder, folderName);
+    });
+
+    QList<Result> results;
+    QSet<QString> knownFolders;
+    QSet<QString> referencedFiles;
+    QSet<QString> unparsedFolders;
+    for (const BasketCheck &basketCheck : checks) {
+        results.append(basketCheck.result);
+        knownFolders.insert(basketCheck.result.input);
+        referencedFiles.unite(basketCheck.referencedFiles);
+        referencedFiles.insert(basketCheck.result.input + QStringLiteral(".basket"));
+        if (!basketCheck.parsed)
+            unparsedFolders.insert(basketCheck.result.input);
+    }
+
+    // What remains does not belong to any basket or note:
+    QElapsedTimer orphansTimer;
+    orphansTimer.start();
+    Result orphans;
+    orphans.input = i18n("Orphans");
+    orphans.success = true;
+    QStringList orphanedPaths;
+    for (const QString &dir : std::as_const(dirList)) {
+        if (!knownFolders.contains(dir)) {
+            orphans.messages.append(i18n("%1 does not belong to any basket!", dir));
+            orphanedPaths.append(dir);
+        }
+    }
+    for (const QString &file : std::as_const(fileList)) {
+        int slashIndex = file.indexOf(QLatin1Char('/'));
+        if (slashIndex < 0) {
+            orphans.messages.append(i18n("%1 does not belong to any basket!", file));
+            orphanedPaths.append(file);
+            continue;
+        }
+        // Files of orphaned folders are trashed with their folder, and we cannot tell what files an encrypted basket uses:
+        QString folder = file.left(slashIndex + 1);
+        if (!knownFolders.contains(folder) || unparsedFolders.contains(folder))
+            continue;
+        if (!referencedFiles.contains(file)) {
+            orphans.messages.append(i18n("%1 does not belong to any note!", file));
+            orphanedPaths.append(file);
+        }
+    }
+
+    if (m_parser->isSet(m_cleanup)) {
+        for (const QString &path : std::as_const(orphanedPaths)) {
+            if (QFile::moveToTrash(basketsFolder + path)) {
+                orphans.messages.append(i18n("%1 trashed!", path));
+            } else {
+                orphans.messages.append(i18n("Could not trash %1", path));
+                orphans.success = false;
+            }
+        }
+    }
+    orphans.elapsedMs = orphansTimer.elapsed();
+    results.append(orphans);
+
+    QTextStream(stdout) << i18n("Directories found: %1", dirList.count()) << '\n' << i18n("Files found: %1", fileList.count()) << '\n';
+    return report(i18n("Check"), results, timer.elapsed());
+}
+
+bool Batch::valuesWithDestination(const QCommandLineOption &option, const QCommandLineOption &destination, QList<QPair<QString, QString>> *values) const
+{
+    const QStringList inputs = m_parser->values(option);
+    const QStringList destinations = m_parser->values(destination);
+    if (inputs.count() != destinations.count()) {
+        qCritical().noquote() << i18n("Every --%1 needs its --%2.", option.names().constFirst(), destination.names().constFirst());
+        return false;
+    }
+    for (int i = 0; i < inputs.count(); ++i)
+        values->append({inputs[i], destinations[i]});
+    return true;
+}
+
+bool Batch::loadBaskets()
+{
+    if (m_parser->isSet(m_folder))
+        Global::setCustomSavesFolder(QDir::cleanPath(m_parser->value(m_folder)) + QLatin1Char('/'));
+
+    // Read the configuration like the main window does (eg. the saves folder and the link looks), but never write it back:
+    Settings::loadConfig();
+    Global::config()->markAsClean();
+    Global::backgroundManager = new BackgroundManager();
+    if (QFile::exists(Global::savesFolder() + QStringLiteral("tags.xml")))
+        Tag::loadTags(); // Unlike the main window, do not create the default tags
+
+    QScopedPointer<QDomDocument> doc(XMLWork::openFile(QStringLiteral("basketTree"), Global::basketsFolder() + QStringLiteral("baskets.xml")));
+    if (!doc) {
+        qCritical().noquote() << i18n("Could not load the baskets of %1", Global::savesFolder());
+        return false;
+    }
+    loadBaskets(doc->documentElement(), nullptr);
+    return true;
+}
+
+void Batch::loadBaskets(const QDomElement &baskets, BasketScene *parent)
+{
+    for (QDomElement element = baskets.firstChildElement(QStringLiteral("basket")); !element.isNull();
+         element = element.nextSiblingElement(QStringLiteral("basket"))) {
+        const QString folderName = element.attribute(QStringLiteral("folderName"));
+        if (folderName.isEmpty())
+            continue;
+        auto *decoration = new DecoratedBasket(nullptr, folderName);
+        m_baskets.append(decoration);
+        BasketScene *basket = decoration->basket();
+        basket->loadProperties(XMLWork::getElement(element, QStringLiteral("properties")));
+        if (parent)
+            m_subBaskets[parent].append(basket);
+        loadBaskets(element, basket);
+    }
+}
+
+BasketScene *Batch::basketForFolderName(const QString &folderName) const
+{
+    const QString wanted = (folderName.endsWith(QLatin1Char('/')) ? folderName : folderName + QLatin1Char('/'));
+    for (DecoratedBasket *decoration : m_baskets) {
+        if (decoration->basket()->folderName() == wanted)
+            return decoration->basket();
+    }
+    return nullptr;
+}
+
+bool Batch::exportAll()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QList<QPair<QString, QString>> exports;
+    if (!valuesWithDestination(m_exportHtml, m_exportTo, &exports))
+        return false;
+
+    QList<Result> results;
+    for (const QPair<QString, QString> &exported : exports) {
+        QElapsedTimer jobTimer;
+        jobTimer.start();
+
+        Result result;
+        result.input = exported.first;
+        const QString destination = exported.second.isEmpty() ? QString() : QFileInfo(exported.second).absoluteFilePath();
+        BasketScene *basket = basketForFolderName(exported.first);
+        if (!basket) {
+            result.messages.append(i18n("There is no basket in the folder %1.", exported.first));
+        } else if (destination.isEmpty()) {
+            result.messages.append(i18n("You need to provide the HTML file to export %1 to.", exported.first));
+        } else if (QFileInfo::exists(destination) && !m_parser->isSet(m_force)) {
+            result.messages.append(i18n("The destination path already exists."));
+        } else {
+            HTMLExporter exporter(basket, destination, m_subBaskets);
+            result.success = exporter.succeeded;
+            result.messages.append(destination);
+        }
+        result.elapsedMs = jobTimer.elapsed();
+        results.append(result);
+    }
+
+    return report(i18n("Export"), results, timer.elapsed());
+}
+
+bool Batch::importAll()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QList<QPair<QString, QString>> imports;
+    if (!valuesWithDestination(m_importText, m_importInto, &imports))
+        return false;
+
+    // Separators are easier to type escaped, eg. "\n-":
+    QString separator = QStringLiteral("\n\n");
+    if (m_parser->isSet(m_separator))
+        separator = m_parser->value(m_separator).replace(QStringLiteral("\\n"), QStringLiteral("\n"));
+
+    QList<Result> results;
+    for (const QPair<QString, QString> &imported : imports) {
+        QElapsedTimer jobTimer;
+        jobTimer.start();
+
+        Result result;
+        result.input = imported.first;
+        BasketScene *basket = imported.second.isEmpty() ? nullptr : basketForFolderName(imported.second);
+        if (!basket) {
+            result.messages.append(i18n("There is no basket in the folder %1.", imported.second));
+        } else {
+            basket->load();
+            const int countBefore = basket->count();
+            result.success = SoftwareImporters::importTextFile(imported.first, separator, basket);
+            if (result.success)
+                result.messages.append(i18np("%1 note imported", "%1 notes imported", basket->count() - countBefore));
+            else
+                result.messages.append(i18n("Failed to open a file resource."));
+        }
+        result.elapsedMs = jobTimer.elapsed();
+        results.append(result);
+    }
+
+    return report(i18n("Import"), results, timer.elapsed());
+}
+
+bool Batch::report(const QString &operation, const QList<Result> &results, qint64 totalElapsedMs)
+{
+    QTextStream out(stdout);
+    int failures = 0;
+    qint64 summedElapsedMs = 0;
+    qint64 slowestMs = 0;
+
+    for (const Result &result : results) {
+        out << (result.success ? "[ OK ] " : "[FAIL] ") << result.input << " (" << result.elapsedMs << " ms)\n";
+        for (const QString &message : result.messages)
+            out << "         " << message << '\n';
+        if (!result.success)
+            ++failures;
+        summedElapsedMs += result.elapsedMs;
+        slowestMs = qMax(slowestMs, result.elapsedMs);
+    }
+
+    out << i18n("%1: %2 item(s), %3 failed, %4 ms wall time, %5 ms cumulated, %6 ms slowest, %7 thread(s)",
+                operation,
+                results.count(),
+                failures,
+                totalElapsedMs,
+                summedElapsedMs,
+                slowestMs,
+                QThreadPool::globalInstance()->maxThreadCount())
+        << '\n';
+    out.flush();
+
+    return failures == 0;
+}
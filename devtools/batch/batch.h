@@ -0,0 +1,141 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+class BasketScene;
+class DecoratedBasket;
+class QDomElement;
+
+/**
+ * @brief The Batch class runs bulk operations on baskets without any user interface
+ *
+ * Every input is processed by a worker thread, and the time spent on each of them is printed, so the tool can be used
+ * from scripts, CI jobs and cron to extract or create @c .baskets archives and to check a saves folder.
+ * Exporting to HTML and importing text files need loaded baskets: they run one after the other in the main thread,
+ * on baskets created on the offscreen platform from baskets.xml, without the main window, and without saving the configuration.
+ */
+class Batch
+{
+public:
+    Batch(QCommandLineParser *parser,
+          const QCommandLineOption &extract,
+          const QCommandLineOption &pack,
+          const QCommandLineOption &check,
+          const QCommandLineOption &cleanup,
+          const QCommandLineOption &exportHtml,
+          const QCommandLineOption &exportTo,
+          const QCommandLineOption &importText,
+          const QCommandLineOption &importInto,
+          const QCommandLineOption &separator,
+          const QCommandLineOption &folder,
+          const QCommandLineOption &output,
+          const QCommandLineOption &jobs,
+          const QCommandLineOption &force);
+    ~Batch();
+
+    /**
+     * This method processes the given command line options and runs every requested operation.
+     * @return the exit code of the process: 0 if every operation succeeded
+     */
+    int runMain();
+
+    /**
+     * @brief The outcome of one operation on one input
+     */
+    struct Result {
+        QString input;
+        bool success = false;
+        qint64 elapsedMs = 0;
+        QStringList messages;
+    };
+
+private:
+    /**
+     * Decodes every given @c .baskets file, in parallel.
+     */
+    bool extractAll();
+
+    /**
+     * Encodes every given baskets directory to a @c .baskets file, in parallel.
+     */
+    bool packAll();
+
+    /**
+     * Looks for files and folders of the saves folder that do not belong to any basket or note, and for note files
+     * that are missing. The @c .basket files are parsed in parallel.
+     * With --cleanup, the orphaned files and folders are moved to the trash, like "Check & Cleanup" does.
+     */
+    bool check();
+
+    /**
+     * Exports every given basket, and its sub-baskets, to an HTML file.
+     */
+    bool exportAll();
+
+    /**
+     * Imports every given text file into a basket, like "Import > Text File..." does.
+     */
+    bool importAll();
+
+    /**
+     * Reads the configuration, the tags, and creates the baskets of the tree of baskets.xml. The baskets are loaded when used.
+     * @return @c false if the tree could not be read
+     */
+    bool loadBaskets();
+    void loadBaskets(const QDomElement &baskets, BasketScene *parent);
+
+    /**
+     * @return the basket stored in @p folderName (eg. "basket1" or "basket1/"), or @c nullptr if there is none
+     */
+    BasketScene *basketForFolderName(const QString &folderName) const;
+
+    /**
+     * The values of @p option, each one paired with the value of @p destination given at the same position, eg. a basket
+     * and the HTML file to export it to.
+     * @return @c false if both options are not given the same number of times
+     */
+    bool valuesWithDestination(const QCommandLineOption &option, const QCommandLineOption &destination, QList<QPair<QString, QString>> *values) const;
+
+    /**
+     * Prints the messages and the time spent on every result, followed by a summary of the whole operation.
+     * @return @c true if all operations succeeded
+     */
+    static bool report(const QString &operation, const QList<Result> &results, qint64 totalElapsedMs);
+
+    QString destinationFor(const QString &input, const QString &suffix) const;
+
+    QCommandLineParser *const m_parser;
+
+    QCommandLineOption m_extract;
+    QCommandLineOption m_pack;
+    QCommandLineOption m_check;
+    QCommandLineOption m_cleanup;
+    QCommandLineOption m_exportHtml;
+    QCommandLineOption m_exportTo;
+    QCommandLineOption m_importText;
+    QCommandLineOption m_importInto;
+    QCommandLineOption m_separator;
+    QCommandLineOption m_folder;
+    QCommandLineOption m_output;
+    QCommandLineOption m_jobs;
+    QCommandLineOption m_force;
+
+    QList<DecoratedBasket *> m_baskets;
+    QHash<BasketScene *, QList<BasketScene *>> m_subBaskets;
+};
+
+#endif // BATCH_H
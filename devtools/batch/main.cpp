@@ -0,0 +1,120 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "batch.h"
+
+#include <basket_version.h>
+
+#include <KAboutData>
+#include <KLocalizedString>
+
+#include <QApplication>
+
+#include <cstring>
+#include <memory>
+
+namespace
+{
+/// Exporting and importing go through baskets, which need widgets: they are created on an offscreen platform
+bool needsBaskets(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--export-html", 13) == 0 || std::strncmp(argv[i], "--import-text", 13) == 0)
+            return true;
+    }
+    return false;
+}
+}
+
+int main(int argc, char **argv)
+{
+    std::unique_ptr<QCoreApplication> app;
+    if (needsBaskets(argc, argv)) {
+        if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        app = std::make_unique<QApplication>(argc, argv);
+    } else {
+        app = std::make_unique<QCoreApplication>(argc, argv);
+    }
+
+    KAboutData aboutData(QStringLiteral("basketbatch"), i18n("basketbatch"), QStringLiteral(BASKET_VERSION_STRING));
+    aboutData.setShortDescription(i18n("Runs bulk operations on baskets without user interface"));
+
+    KAboutData::setApplicationData(aboutData);
+
+    QCommandLineParser parser;
+    parser.addVersionOption();
+    parser.addHelpOption();
+
+    QCommandLineOption extract(QStringList() << QStringLiteral("x") << QStringLiteral("extract"),
+                               i18n("Decodes the .baskets <file>. Can be given several times, the files are decoded in parallel."),
+                               QStringLiteral("file"));
+    parser.addOption(extract);
+
+    QCommandLineOption pack(QStringList() << QStringLiteral("c") << QStringLiteral("pack"),
+                            i18n("Encodes the baskets <directory> to a .baskets file. Can be given several times, the directories are encoded in parallel."),
+                            QStringLiteral("directory"));
+    parser.addOption(pack);
+
+    QCommandLineOption check(QStringList() << QStringLiteral("check"),
+                             i18n("Checks the saves <folder> for files that do not belong to any basket or note, and for missing note files."),
+                             QStringLiteral("folder"));
+    parser.addOption(check);
+
+    QCommandLineOption cleanup(QStringList() << QStringLiteral("cleanup"),
+                               i18n("With --check, move the files that do not belong to any basket or note to the trash."));
+    parser.addOption(cleanup);
+
+    QCommandLineOption exportHtml(QStringList() << QStringLiteral("export-html"),
+                                  i18n("Exports the basket <folder> (eg. basket1) and its sub-baskets to the HTML file of the matching --to. "
+                                       "Can be given several times."),
+                                  QStringLiteral("folder"));
+    parser.addOption(exportHtml);
+
+    QCommandLineOption exportTo(QStringList() << QStringLiteral("to"),
+                                i18n("The HTML <file> to export the basket of the matching --export-html to."),
+                                QStringLiteral("file"));
+    parser.addOption(exportTo);
+
+    QCommandLineOption importText(QStringList() << QStringLiteral("import-text"),
+                                  i18n("Imports the text <file> into the basket of the matching --into. Can be given several times."),
+                                  QStringLiteral("file"));
+    parser.addOption(importText);
+
+    QCommandLineOption importInto(QStringList() << QStringLiteral("into"),
+                                  i18n("The basket <folder> (eg. basket1) to import the text file of the matching --import-text into."),
+                                  QStringLiteral("folder"));
+    parser.addOption(importInto);
+
+    QCommandLineOption separator(QStringList() << QStringLiteral("separator"),
+                                 i18n("With --import-text, the text separating the notes of the file. Defaults to an empty line."),
+                                 QStringLiteral("text"));
+    parser.addOption(separator);
+
+    QCommandLineOption folder(QStringList() << QStringLiteral("folder"),
+                              i18n("With --export-html and --import-text, the saves folder of the baskets. Defaults to the one of BasKet."),
+                              QStringLiteral("folder"));
+    parser.addOption(folder);
+
+    QCommandLineOption output(QStringList() << QStringLiteral("o") << QStringLiteral("output"),
+                              i18n("Destination directory. Optional."),
+                              QStringLiteral("directory"));
+    parser.addOption(output);
+
+    QCommandLineOption jobs(QStringList() << QStringLiteral("j") << QStringLiteral("jobs"),
+                            i18n("Number of worker threads. Defaults to the number of processors."),
+                            QStringLiteral("count"));
+    parser.addOption(jobs);
+
+    QCommandLineOption forceOption(QStringList() << QStringLiteral("f") << QStringLiteral("force"), i18n("Overwrite existing files."));
+    parser.addOption(forceOption);
+
+    parser.process(*app);
+
+    Batch batch(&parser, extract, pack, check, cleanup, exportHtml, exportTo, importText, importInto, separator, folder, output, jobs, forceOption);
+
+    return batch.runMain();
+}
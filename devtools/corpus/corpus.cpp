@@ -0,0 +1,140 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "corpus.h"
+
+#include <corpusgenerator.h>
+
+#include <KLocalizedString>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+Corpus::Corpus(QCommandLineParser *parser)
+    : m_parser(parser)
+    , m_output(QStringList() << QStringLiteral("o") << QStringLiteral("output"), i18n("Saves folder to write. Mandatory."), QStringLiteral("directory"))
+    , m_seed(QStringList() << QStringLiteral("s") << QStringLiteral("seed"), i18n("Seed of the random generator. Defaults to 1."), QStringLiteral("number"))
+    , m_depth(QStringList() << QStringLiteral("depth"), i18n("Number of levels of the basket tree. Defaults to 1."), QStringLiteral("count"))
+    , m_baskets(QStringList() << QStringLiteral("baskets"),
+                i18n("Number of top-level baskets, and of sub-baskets of every basket. Defaults to 1."),
+                QStringLiteral("count"))
+    , m_notes(QStringList() << QStringLiteral("n") << QStringLiteral("notes"), i18n("Number of notes of every basket. Defaults to 100."), QStringLiteral("count"))
+    , m_columns(QStringList() << QStringLiteral("columns"), i18n("Number of columns of every basket. Defaults to 3."), QStringLiteral("count"))
+    , m_groupDepth(QStringList() << QStringLiteral("group-depth"),
+                   i18n("Number of levels of groups in every column. Defaults to 0: the notes are directly in the columns."),
+                   QStringLiteral("count"))
+    , m_mix(QStringList() << QStringLiteral("mix"),
+            i18n("Relative weights of the HTML, image, link and file notes, separated by commas. Defaults to 70,10,15,5."),
+            QStringLiteral("weights"))
+    , m_tags(QStringList() << QStringLiteral("tags"), i18n("Number of tags. Defaults to 8."), QStringLiteral("count"))
+    , m_tagged(QStringList() << QStringLiteral("tagged"), i18n("Percentage of the notes having tags. Defaults to 30."), QStringLiteral("percent"))
+    , m_maxTags(QStringList() << QStringLiteral("max-tags"),
+                i18n("Maximum number of tags of a tagged note. The first tags are used more often than the last ones. Defaults to 3."),
+                QStringLiteral("count"))
+    , m_textSize(QStringList() << QStringLiteral("text-size"), i18n("Mean number of characters of the HTML notes. Defaults to 400."), QStringLiteral("characters"))
+    , m_imageSize(QStringList() << QStringLiteral("image-size"), i18n("Width and height of the images. Defaults to 64."), QStringLiteral("pixels"))
+    , m_fileSize(QStringList() << QStringLiteral("file-size"), i18n("Size of the files of the file notes. Defaults to 4096."), QStringLiteral("bytes"))
+    , m_force(QStringList() << QStringLiteral("f") << QStringLiteral("force"), i18n("Write the corpus even if the output directory is not empty."))
+{
+    m_parser->addOptions({m_output,
+                          m_seed,
+                          m_depth,
+                          m_baskets,
+                          m_notes,
+                          m_columns,
+                          m_groupDepth,
+                          m_mix,
+                          m_tags,
+                          m_tagged,
+                          m_maxTags,
+                          m_textSize,
+                          m_imageSize,
+                          m_fileSize,
+                          m_force});
+}
+
+bool Corpus::readNumber(const QCommandLineOption &option, int defaultValue, int *value) const
+{
+    *value = defaultValue;
+    if (!m_parser->isSet(option))
+        return true;
+
+    bool ok = false;
+    *value = m_parser->value(option).toInt(&ok);
+    if (!ok || *value < 0) {
+        qCritical().noquote() << i18n("The value of --%1 must be a positive number.", option.names().last());
+        return false;
+    }
+    return true;
+}
+
+int Corpus::runMain()
+{
+    if (!m_parser->isSet(m_output)) {
+        qCritical().noquote() << i18n("You need to provide the --output/-o directory");
+        return 1;
+    }
+
+    const QString output = QDir::cleanPath(m_parser->value(m_output)) + QLatin1Char('/');
+    const QDir outputDir(output);
+    if (outputDir.exists() && !outputDir.isEmpty() && !m_parser->isSet(m_force)) {
+        qCritical().noquote() << i18n("The output directory is not empty. Use --force to write the corpus anyway.");
+        return 1;
+    }
+
+    CorpusGenerator::Parameters parameters;
+    int seed;
+    bool ok = readNumber(m_seed, 1, &seed);
+    parameters.seed = quint32(seed);
+    ok = ok && readNumber(m_depth, parameters.treeDepth, &parameters.treeDepth);
+    ok = ok && readNumber(m_baskets, parameters.basketsPerLevel, &parameters.basketsPerLevel);
+    ok = ok && readNumber(m_notes, parameters.notesPerBasket, &parameters.notesPerBasket);
+    ok = ok && readNumber(m_columns, parameters.columnsPerBasket, &parameters.columnsPerBasket);
+    ok = ok && readNumber(m_groupDepth, parameters.groupDepth, &parameters.groupDepth);
+    ok = ok && readNumber(m_tags, parameters.tagCount, &parameters.tagCount);
+    ok = ok && readNumber(m_tagged, parameters.taggedPercent, &parameters.taggedPercent);
+    ok = ok && readNumber(m_maxTags, parameters.maxTagsPerNote, &parameters.maxTagsPerNote);
+    ok = ok && readNumber(m_textSize, parameters.textSize, &parameters.textSize);
+    ok = ok && readNumber(m_imageSize, parameters.imageSize, &parameters.imageSize);
+    ok = ok && readNumber(m_fileSize, parameters.fileSize, &parameters.fileSize);
+    if (!ok)
+        return 1;
+
+    if (m_parser->isSet(m_mix)) {
+        const QStringList weights = m_parser->value(m_mix).split(QLatin1Char(','));
+        int *const fields[] = {&parameters.htmlWeight, &parameters.imageWeight, &parameters.linkWeight, &parameters.fileWeight};
+        bool valid = (weights.count() == 4);
+        for (int i = 0; valid && i < 4; ++i) {
+            *fields[i] = weights[i].trimmed().toInt(&valid);
+            valid = valid && *fields[i] >= 0;
+        }
+        if (!valid) {
+            qCritical().noquote() << i18n("--mix takes four positive weights separated by commas, eg. 70,10,15,5");
+            return 1;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    CorpusGenerator generator(parameters);
+    if (!generator.generate(output)) {
+        qCritical().noquote() << i18n("Could not write the corpus to %1", output);
+        return 1;
+    }
+
+    const CorpusGenerator::Statistics &statistics = generator.statistics();
+    QTextStream(stdout) << i18n("%1: %2 basket(s), %3 note(s), %4 group(s), %5 bytes, %6 ms",
+                                output,
+                                statistics.baskets,
+                                statistics.notes,
+                                statistics.groups,
+                                statistics.bytes,
+                                timer.elapsed())
+                        << '\n';
+    return 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+
+/**
+ * @brief The Corpus class writes a synthetic saves folder from the command line options
+ *
+ * The generation is deterministic: the same options, seed included, always produce the same files, so benchmarks,
+ * tests and profiling sessions can share corpora by sharing their command line.
+ */
+class Corpus
+{
+public:
+    /**
+     * Adds the options of the tool to @p parser.
+     */
+    explicit Corpus(QCommandLineParser *parser);
+
+    /**
+     * This method checks the given command line options and writes the corpus.
+     * @return the exit code of the process: 0 if the corpus has been written
+     */
+    int runMain();
+
+private:
+    /**
+     * Reads the positive number given to @p option, or @p defaultValue if the option is not set.
+     * @return false, after printing an error, if the value is not a positive number
+     */
+    bool readNumber(const QCommandLineOption &option, int defaultValue, int *value) const;
+
+    QCommandLineParser *const m_parser;
+
+    QCommandLineOption m_output;
+    QCommandLineOption m_seed;
+    QCommandLineOption m_depth;
+    QCommandLineOption m_baskets;
+    QCommandLineOption m_notes;
+    QCommandLineOption m_columns;
+    QCommandLineOption m_groupDepth;
+    QCommandLineOption m_mix;
+    QCommandLineOption m_tags;
+    QCommandLineOption m_tagged;
+    QCommandLineOption m_maxTags;
+    QCommandLineOption m_textSize;
+    QCommandLineOption m_imageSize;
+    QCommandLineOption m_fileSize;
+    QCommandLineOption m_force;
+};
+
+#endif // CORPUS_H
@@ -0,0 +1,32 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "corpus.h"
+
+#include <basket_version.h>
+
+#include <KAboutData>
+#include <KLocalizedString>
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    KAboutData aboutData(QStringLiteral("basketcorpus"), i18n("basketcorpus"), QStringLiteral(BASKET_VERSION_STRING));
+    aboutData.setShortDescription(i18n("Generates synthetic baskets to benchmark, test and profile BasKet"));
+
+    KAboutData::setApplicationData(aboutData);
+
+    QCommandLineParser parser;
+    parser.addVersionOption();
+    parser.addHelpOption();
+
+    Corpus corpus(&parser);
+
+    parser.process(app);
+
+    return corpus.runMain();
+}
@@ -4,11 +4,117 @@
  */
 
 #include "animation.h"
+
+#include "debugwindow.h"
 #include "note.h"
 
-NoteAnimation::NoteAnimation(Note *target, const QByteArray &propertyName, QObject *parent)
-    : QPropertyAnimation(qobject_cast<QObject *>(target), propertyName, parent)
+BasketAnimations::BasketAnimations(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setInterval(FRAME_INTERVAL);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &BasketAnimations::tick);
+    m_clock.start();
+}
+
+void BasketAnimations::animateX(Note *note, qreal x)
+{
+    start(m_movesX, note, note->x(), x);
+}
+
+void BasketAnimations::animateY(Note *note, qreal y)
+{
+    start(m_movesY, note, note->y(), y);
+}
+
+void BasketAnimations::start(QHash<Note *, Move> &moves, Note *note, qreal from, qreal to)
+{
+    if (from == to) {
+        moves.remove(note);
+        return;
+    }
+
+    moves.insert(note, Move{from, to, m_clock.elapsed()});
+    if (!m_timer.isActive())
+        m_timer.start();
+}
+
+void BasketAnimations::stopX(Note *note)
+{
+    m_movesX.remove(note);
+}
+
+void BasketAnimations::stopY(Note *note)
+{
+    m_movesY.remove(note);
+}
+
+void BasketAnimations::stop(Note *note)
+{
+    m_movesX.remove(note);
+    m_movesY.remove(note);
+}
+
+void BasketAnimations::finish()
+{
+    // Note::setX() and Note::setY() would cancel the moves: place the items directly
+    for (auto it = m_movesX.cbegin(); it != m_movesX.cend(); ++it)
+        static_cast<QGraphicsItem *>(it.key())->setX(it->to);
+    for (auto it = m_movesY.cbegin(); it != m_movesY.cend(); ++it)
+        static_cast<QGraphicsItem *>(it.key())->setY(it->to);
+    m_movesX.clear();
+    m_movesY.clear();
+    m_timer.stop();
+}
+
+void BasketAnimations::tick()
+{
+    int movingNotes = qMax(m_movesX.size(), m_movesY.size());
+
+    // Too many notes are moving (eg. when filtering a big basket): don't animate them at all
+    if (movingNotes > MAX_MOVING_NOTES) {
+        QElapsedTimer frameTimer;
+        frameTimer.start();
+        finish();
+        reportFrame(frameTimer.elapsed(), movingNotes, /*skipped=*/true);
+        return;
+    }
+
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+    const qint64 now = m_clock.elapsed();
+
+    auto advance = [now](QHash<Note *, Move> &moves, void (QGraphicsItem::*setter)(qreal)) {
+        for (auto it = moves.begin(); it != moves.end();) {
+            qreal progress = qMin(qreal(1), qreal(now - it->startTime) / DURATION);
+            (static_cast<QGraphicsItem *>(it.key())->*setter)(it->from + (it->to - it->from) * progress);
+            if (progress >= 1)
+                it = moves.erase(it);
+            else
+                ++it;
+        }
+    };
+    advance(m_movesX, &QGraphicsItem::setX);
+    advance(m_movesY, &QGraphicsItem::setY);
+
+    qint64 frameTime = frameTimer.elapsed();
+    bool skipped = false;
+    // The frame was too slow to look like an animation anyway: place the remaining notes
+    if (frameTime > MAX_FRAME_TIME && (!m_movesX.isEmpty() || !m_movesY.isEmpty())) {
+        finish();
+        skipped = true;
+    }
+    if (m_movesX.isEmpty() && m_movesY.isEmpty())
+        m_timer.stop();
+
+    reportFrame(frameTime, movingNotes, skipped);
+}
+
+void BasketAnimations::reportFrame(qint64 frameTime, int movingNotes, bool skipped)
 {
+    if (Global::debugWindow)
+        Global::debugWindow->setCounter(QStringLiteral("Animation frame"),
+                                        QStringLiteral("%1 ms, %2 moving notes%3").arg(frameTime).arg(movingNotes).arg(skipped ? QStringLiteral(" (skipped)") : QString()));
 }
 
 #include "moc_animation.cpp"
@@ -6,35 +6,57 @@
 #ifndef ANIMATION_H
 #define ANIMATION_H
 
-#include <QParallelAnimationGroup>
-#include <QPropertyAnimation>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
 
 class Note;
 
 /**
+ * Moves the notes of a basket to their new positions after a relayout.
+ * Every moving note is driven by the same timer, so one tick moves all of them and the scene repaints once per frame.
+ * When too many notes move at once, or when a frame takes too long, the notes jump to their final positions instead.
  * @author Dominik Kummer
  */
 
-class BasketAnimations : public QParallelAnimationGroup
+class BasketAnimations : public QObject
 {
     Q_OBJECT
 public:
     /// CONSTRUCTOR AND DESTRUCTOR:
-    BasketAnimations(QObject *parent = nullptr)
-        : QParallelAnimationGroup(parent) {};
+    explicit BasketAnimations(QObject *parent = nullptr);
     ~BasketAnimations() override = default;
-};
-
-class NoteAnimation : public QPropertyAnimation
-{
-    Q_OBJECT
-public:
-    /// CONSTRUCTOR AND DESTRUCTOR:
-    NoteAnimation(Note *target, const QByteArray &propertyName, QObject *parent = nullptr);
-    ~NoteAnimation() override = default;
 
-Q_SIGNALS:
-    void valueChanged(const QVariant &value);
+    /// ANIMATING NOTES:
+    void animateX(Note *note, qreal x); /// << Start moving @p note horizontally from its current position to @p x
+    void animateY(Note *note, qreal y); /// << Start moving @p note vertically from its current position to @p y
+    void stopX(Note *note); /// << Forget the horizontal move of @p note, leaving it where it is now (eg. when it is placed without animation)
+    void stopY(Note *note); /// << Idem, for the vertical move
+    void stop(Note *note); /// << Forget both moves of @p note (eg. when it is deleted)
+    void finish(); /// << Move every note to its final position now (eg. when the animations of the basket are disabled)
+
+    static const int DURATION = 250; /// << Duration of a move, in ms
+    static const int FRAME_INTERVAL = 16; /// << Time between two ticks, in ms
+    static const int MAX_MOVING_NOTES = 300; /// << Above that many moving notes, they are placed directly
+    static const int MAX_FRAME_TIME = 40; /// << If moving the notes of one frame took longer than that, in ms, the remaining moves are finished directly
+
+private Q_SLOTS:
+    void tick();
+
+private:
+    struct Move {
+        qreal from;
+        qreal to;
+        qint64 startTime;
+    };
+    void start(QHash<Note *, Move> &moves, Note *note, qreal from, qreal to);
+    void reportFrame(qint64 frameTime, int movingNotes, bool skipped);
+
+    QHash<Note *, Move> m_movesX;
+    QHash<Note *, Move> m_movesY;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
 };
 
 #endif // ANIMATION_H
@@ -39,12 +39,14 @@
 #include "global.h"
 #include "tag.h"
 #include "tools.h"
+#include "tracing.h"
 #include "xmlwork.h"
 
 #include <array>
 
 void Archive::save(BasketScene *basket, bool withSubBaskets, const QString &destination)
 {
+    BASKET_TRACE("Archive::save");
     QDir dir;
     QProgressDialog dialog;
     dialog.setWindowTitle(i18n("Save as Basket Archive"));
@@ -256,6 +258,7 @@ void Archive::listUsedTags(BasketScene *basket, bool recursive, QList<Tag *> &li
 
 void Archive::open(const QString &path)
 {
+    BASKET_TRACE("Archive::open");
     // Use the temporary folder:
     QString tempFolder = Global::savesFolder() + QStringLiteral("temp-archive/");
 
@@ -313,6 +316,7 @@ void Archive::open(const QString &path)
 
 Archive::IOErrorCode Archive::extractArchive(const QString &path, const QString &destination, const bool protectDestination)
 {
+    BASKET_TRACE("Archive::extractArchive");
     IOErrorCode retCode = IOErrorCode::NoError;
 
     QString l_destination;
@@ -472,6 +476,7 @@ Archive::IOErrorCode Archive::extractArchive(const QString &path, const QString
 Archive::IOErrorCode
 Archive::createArchiveFromSource(const QString &sourcePath, const QString &previewImage, const QString &destination, const bool protectDestination)
 {
+    BASKET_TRACE("Archive::createArchiveFromSource");
     QDir source(sourcePath);
     QFileInfo destinationFile(destination);
 
@@ -752,8 +757,9 @@ void Archive::renameMergedStates(QDomNode notes, QMap<QString, QString> &mergedS
                     QStringList tagNames = tags.split(QLatin1Char(';'));
                     for (QStringList::Iterator it = tagNames.begin(); it != tagNames.end(); ++it) {
                         QString &tag = *it;
-                        if (mergedStates.contains(tag)) {
-                            tag = mergedStates[tag];
+                        QMap<QString, QString>::const_iterator merged = mergedStates.constFind(tag);
+                        if (merged != mergedStates.constEnd()) {
+                            tag = merged.value();
                         }
                     }
                     QString newTags = tagNames.join(QStringLiteral(";"));
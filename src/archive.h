@@ -28,7 +28,7 @@ class KTar;
 class Archive
 {
 public:
-    static void save(BasketScene *basket, bool withSubBaskets, const QString &destination);
+    BASKET_EXPORT static void save(BasketScene *basket, bool withSubBaskets, const QString &destination);
     static void open(const QString &path);
 
     /**
@@ -5,10 +5,13 @@
 
 #include "backgroundmanager.h"
 
+#include "debugwindow.h"
+
 #include <KConfig>
 #include <KConfigGroup>
 
 #include <QDir>
+#include <QGuiApplication>
 #include <QImage>
 #include <QPainter>
 #include <QPixmap>
@@ -23,6 +26,7 @@ BackgroundEntry::BackgroundEntry(const QString &location)
     name = QUrl::fromLocalFile(location).fileName();
     tiled = false;
     pixmap = nullptr;
+    tile = nullptr;
     preview = nullptr;
     customersCount = 0;
 }
@@ -30,6 +34,7 @@ BackgroundEntry::BackgroundEntry(const QString &location)
 BackgroundEntry::~BackgroundEntry()
 {
     delete pixmap;
+    delete tile;
     delete preview;
 }
 
@@ -96,6 +101,54 @@ BackgroundEntry *BackgroundManager::backgroundEntryFor(const QString &image)
     return nullptr;
 }
 
+/** Render the image of @p entry on @p color (or on transparency if @p color is invalid), at the device pixel ratio of the screen.
+ * Tiled images are repeated until the result is at least TILE_SIZE x TILE_SIZE logical pixels.
+ */
+QPixmap *BackgroundManager::composite(const BackgroundEntry *entry, const QColor &color) const
+{
+    static const int TILE_SIZE = 256;
+
+    const qreal ratio = qApp->devicePixelRatio();
+    QSize size = entry->pixmap->size();
+    if (entry->tiled && !size.isEmpty()) {
+        size.rwidth() *= qMax(1, (TILE_SIZE + size.width() - 1) / size.width());
+        size.rheight() *= qMax(1, (TILE_SIZE + size.height() - 1) / size.height());
+    }
+
+    auto *result = new QPixmap(size * ratio);
+    result->setDevicePixelRatio(ratio);
+    result->fill(color.isValid() ? color : QColor(Qt::transparent));
+    QPainter painter(result);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    if (entry->tiled)
+        painter.drawTiledPixmap(QRectF(QPointF(0, 0), QSizeF(size)), *(entry->pixmap));
+    else
+        painter.drawPixmap(QRectF(QPointF(0, 0), QSizeF(size)), *(entry->pixmap), QRectF(entry->pixmap->rect()));
+    painter.end();
+    return result;
+}
+
+qint64 BackgroundManager::memoryUsage() const
+{
+    auto bytes = [](const QPixmap *pixmap) -> qint64 {
+        return (pixmap ? qint64(pixmap->width()) * pixmap->height() * pixmap->depth() / 8 : 0);
+    };
+
+    qint64 total = 0;
+    for (const BackgroundEntry *entry : m_backgroundsList)
+        total += bytes(entry->pixmap) + bytes(entry->tile) + bytes(entry->preview);
+    for (const OpaqueBackgroundEntry *entry : m_opaqueBackgroundsList)
+        total += bytes(entry->pixmap);
+    return total;
+}
+
+void BackgroundManager::reportMemoryUsage() const
+{
+    DEBUG_WIN << QStringLiteral("BackgroundManager: %1 KiB of cached pixmaps (%2 opaque backgrounds)")
+                     .arg(memoryUsage() / 1024)
+                     .arg(m_opaqueBackgroundsList.size());
+}
+
 OpaqueBackgroundEntry *BackgroundManager::opaqueBackgroundEntryFor(const QString &image, const QColor &color)
 {
     for (OpaqueBackgroundsList::Iterator it = m_opaqueBackgroundsList.begin(); it != m_opaqueBackgroundsList.end(); ++it)
@@ -122,6 +175,11 @@ bool BackgroundManager::subscribe(const QString &image)
             ///         qDebug() << "BackgroundManager: Failed to load " << entry->location;
             return false;
         }
+        // Pre-composite the tile to draw:
+        if (entry->tiled && !entry->tile) {
+            entry->tile = composite(entry, QColor());
+            reportMemoryUsage();
+        }
         // Success: effectively subscribe:
         ++entry->customersCount;
         return true;
@@ -148,12 +206,9 @@ bool BackgroundManager::subscribe(const QString &image, const QColor &color)
     if (!opaqueBackgroundEntry) {
         ///     qDebug() << "BackgroundManager: Computing (" << image << "," << color.name() << ")...";
         opaqueBackgroundEntry = new OpaqueBackgroundEntry(image, color);
-        opaqueBackgroundEntry->pixmap = new QPixmap(backgroundEntry->pixmap->size());
-        opaqueBackgroundEntry->pixmap->fill(color);
-        QPainter painter(opaqueBackgroundEntry->pixmap);
-        painter.drawPixmap(0, 0, *(backgroundEntry->pixmap));
-        painter.end();
+        opaqueBackgroundEntry->pixmap = composite(backgroundEntry, color);
         m_opaqueBackgroundsList.append(opaqueBackgroundEntry);
+        reportMemoryUsage();
     }
 
     // We are now sure the entry exist, do the subscription:
@@ -198,7 +253,7 @@ QPixmap *BackgroundManager::pixmap(const QString &image)
         return nullptr;
     }
 
-    return entry->pixmap;
+    return (entry->tile ? entry->tile : entry->pixmap);
 }
 
 QPixmap *BackgroundManager::opaquePixmap(const QString &image, const QColor &color)
@@ -367,6 +422,8 @@ void BackgroundManager::doGarbage()
             ///         qDebug() << " [Deleted cached pixmap]";
             delete entry->pixmap;
             entry->pixmap = nullptr;
+            delete entry->tile;
+            entry->tile = nullptr;
         }
         ///     qDebug();
     }
@@ -384,6 +441,8 @@ void BackgroundManager::doGarbage()
             ++it;
         ///     qDebug();
     }
+
+    reportMemoryUsage();
 }
 
 #include "moc_backgroundmanager.cpp"
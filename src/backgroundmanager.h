@@ -32,6 +32,7 @@ protected:
     QString location;
     bool tiled; /// << Only valid after some object subscribed to this image! Because it's only read at this time.
     QPixmap *pixmap; /// << Only valid (non-null) after some object subscribed to this image! Because it's only read at this time.
+    QPixmap *tile; /// << The image repeated to a bigger tile, at the screen device pixel ratio. Only for tiled images that are subscribed.
     QPixmap *preview; /// << Only valid (non-null) after some object requested the preview.
     int customersCount;
 };
@@ -57,6 +58,10 @@ protected:
 };
 
 /** Manage the list of background images.
+ * PRE-COMPOSITED TILES:
+ *   The pixmaps given to requesters are rendered at the device pixel ratio of the screen, so they are blitted without being rescaled.
+ *   Small tiled images are repeated into tiles of at least TILE_SIZE pixels, to draw big areas with fewer blits.
+ *   An opaque pixmap is shared by every basket using the same image with the same color.
  * BASIC FUNCTIONNING OF A BACKGROUND CHOOSER:
  *   It get all image names with imageNames() to put them in eg. a QComboBox and then,
  *   when it's time to get the preview of an image it call preview() with the image name to get it.
@@ -107,10 +112,14 @@ public:
     QString previewPathForImageName(const QString &image);
     /// USED FOR IMPORTATION:
     void addImage(const QString &fullPath);
+    /// MEMORY USAGE OF THE CACHED PIXMAPS, IN BYTES:
+    qint64 memoryUsage() const;
 
 private:
     BackgroundEntry *backgroundEntryFor(const QString &image);
     OpaqueBackgroundEntry *opaqueBackgroundEntryFor(const QString &image, const QColor &color);
+    QPixmap *composite(const BackgroundEntry *entry, const QColor &color) const;
+    void reportMemoryUsage() const;
 
 private:
     BackgroundsList m_backgroundsList;
@@ -0,0 +1,283 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "basketcache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QtXml/QDomDocument>
+
+#include "tracing.h"
+#include "xmlwork.h"
+
+#include <atomic>
+
+// Not in the anonymous namespace: the operators of QList and QHash find these ones by argument-dependent lookup
+static QDataStream &operator<<(QDataStream &stream, const BasketCache::HtmlSummary &summary)
+{
+    return stream << summary.fileSize << summary.fileModified << summary.textEquivalent << qint32(summary.minWidth);
+}
+
+static QDataStream &operator>>(QDataStream &stream, BasketCache::HtmlSummary &summary)
+{
+    qint32 minWidth;
+    stream >> summary.fileSize >> summary.fileModified >> summary.textEquivalent >> minWidth;
+    summary.minWidth = minWidth;
+    return stream;
+}
+
+static QDataStream &operator<<(QDataStream &stream, const BasketCache::Note &note)
+{
+    stream << note.isGroup << qint32(note.x) << qint32(note.y) << qint32(note.width) << note.folded;
+    if (note.isGroup)
+        return stream << note.children;
+    return stream << note.type << note.content << note.contentAttributes << note.added << note.lastModification << note.tags << note.html;
+}
+
+static QDataStream &operator>>(QDataStream &stream, BasketCache::Note &note)
+{
+    qint32 x, y, width;
+    stream >> note.isGroup >> x >> y >> width >> note.folded;
+    note.x = x;
+    note.y = y;
+    note.width = width;
+    if (note.isGroup)
+        return stream >> note.children;
+    return stream >> note.type >> note.content >> note.contentAttributes >> note.added >> note.lastModification >> note.tags >> note.html;
+}
+
+namespace
+{
+const quint32 MAGIC = 0x42534b43; // "BSKC"
+const quint32 VERSION = 1; // Increment it every time the format changes: old caches are then rebuilt
+
+// One thread, so the rebuilds of a basket are written in the order they were requested:
+QThreadPool *rebuildPool()
+{
+    static QThreadPool *pool = []() {
+        auto *pool = new QThreadPool;
+        pool->setMaxThreadCount(1);
+        return pool;
+    }();
+    return pool;
+}
+
+std::atomic<bool> enabled{true};
+
+QMutex pendingMutex;
+QHash<QString, QHash<QString, BasketCache::HtmlSummary>> pendingRebuilds; ///< By basket folder
+
+qint64 modificationTime(const QFileInfo &info)
+{
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+QByteArray hashOf(const QByteArray &data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+void addFileStamps(QList<BasketCache::Note> &notes, const QString &basketFolder, const QHash<QString, BasketCache::HtmlSummary> &htmlSummaries)
+{
+    for (BasketCache::Note &note : notes) {
+        if (note.isGroup) {
+            addFileStamps(note.children, basketFolder, htmlSummaries);
+            continue;
+        }
+        if (note.type != QStringLiteral("html"))
+            continue;
+        auto it = htmlSummaries.constFind(note.content);
+        if (it == htmlSummaries.constEnd() || !it->isValid())
+            continue;
+        // The file may have changed since the summary was made (eg. by a sync): the summary would then describe another content
+        const QFileInfo info(basketFolder + note.content);
+        if (info.exists() && info.size() == it->fileSize && modificationTime(info) == it->fileModified)
+            note.html = it.value();
+    }
+}
+}
+
+QList<BasketCache::Note> BasketCache::notesFromXml(const QDomElement &notes)
+{
+    QList<Note> result;
+    for (QDomNode n = notes.firstChild(); !n.isNull(); n = n.nextSibling()) {
+        QDomElement e = n.toElement();
+        if (e.isNull()) // Cannot handle that!
+            continue;
+
+        Note note;
+        if (e.tagName() == QStringLiteral("group")) {
+            note.isGroup = true;
+            note.children = notesFromXml(e);
+        } else if (e.tagName() == QStringLiteral("note") || e.tagName() == QStringLiteral("item")) { // Keep compatible with 0.6.0 Alpha 1
+            QDomElement content = XMLWork::getElement(e, QStringLiteral("content"));
+            note.type = e.attribute(QStringLiteral("type"));
+            note.content = content.text();
+            const QDomNamedNodeMap attributes = content.attributes();
+            for (int i = 0; i < attributes.count(); ++i) {
+                QDomAttr attribute = attributes.item(i).toAttr();
+                note.contentAttributes.insert(attribute.name(), attribute.value());
+            }
+            if (e.hasAttribute(QStringLiteral("added")))
+                note.added = QDateTime::fromString(e.attribute(QStringLiteral("added")), Qt::ISODate);
+            if (e.hasAttribute(QStringLiteral("lastModification")))
+                note.lastModification = QDateTime::fromString(e.attribute(QStringLiteral("lastModification")), Qt::ISODate);
+            note.tags = XMLWork::getElementText(e, QStringLiteral("tags"), QString());
+        } else {
+            continue;
+        }
+
+        note.x = e.attribute(QStringLiteral("x")).toInt();
+        note.y = e.attribute(QStringLiteral("y")).toInt();
+        note.width = e.attribute(QStringLiteral("width"), QStringLiteral("200")).toInt();
+        note.folded = XMLWork::trueOrFalse(e.attribute(QStringLiteral("folded"), QStringLiteral("false")));
+        result.append(note);
+    }
+    return result;
+}
+
+QString BasketCache::cachePath(const QString &basketFolder)
+{
+    // Caches do not belong to the saves folder: they are not versioned, backed up nor archived
+    const QByteArray key = QCryptographicHash::hash(QDir::cleanPath(basketFolder).toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/baskets/") + QString::fromLatin1(key) + QStringLiteral(".cache");
+}
+
+bool BasketCache::read(const QString &basketFolder, Structure *structure)
+{
+    BASKET_TRACE("BasketCache::read");
+    if (!isEnabled())
+        return false;
+    QFile file(cachePath(basketFolder));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    uchar *map = file.map(0, file.size());
+    if (!map)
+        return false;
+    QDataStream stream(QByteArray::fromRawData(reinterpret_cast<const char *>(map), file.size()));
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic, version;
+    qint64 basketSize, basketModified;
+    QByteArray basketHash;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok || magic != MAGIC || version != VERSION)
+        return false;
+
+    // Cheap checks first, then the hash, to also catch a file saved twice in the same millisecond:
+    const QFileInfo basketInfo(basketFolder + QStringLiteral(".basket"));
+    stream >> basketSize >> basketModified >> basketHash;
+    if (stream.status() != QDataStream::Ok || basketSize != basketInfo.size() || basketModified != modificationTime(basketInfo))
+        return false;
+    QFile basketFile(basketInfo.filePath());
+    if (!basketFile.open(QIODevice::ReadOnly) || hashOf(basketFile.readAll()) != basketHash)
+        return false;
+
+    stream >> structure->properties >> structure->notes;
+    if (stream.status() != QDataStream::Ok) {
+        *structure = Structure();
+        return false;
+    }
+    return true;
+}
+
+bool BasketCache::write(const QString &basketFolder, const QHash<QString, HtmlSummary> &htmlSummaries)
+{
+    BASKET_TRACE("BasketCache::write");
+    QFile basketFile(basketFolder + QStringLiteral(".basket"));
+    if (!basketFile.open(QIODevice::ReadOnly))
+        return false;
+    const QByteArray data = basketFile.readAll();
+    // Stat after reading: if the file is saved meanwhile, read() sees a hash mismatch instead of a stale cache
+    const QFileInfo basketInfo(basketFile.fileName());
+
+    QDomDocument document(QStringLiteral("basket"));
+    if (!document.setContent(data))
+        return false; // Encrypted, or not a basket
+    const QDomElement docElem = document.documentElement();
+
+    Structure structure;
+    QTextStream properties(&structure.properties);
+    XMLWork::getElement(docElem, QStringLiteral("properties")).save(properties, 0);
+    properties.flush();
+    // Compatibility with 0.6.0 Pre-Alpha versions:
+    QDomElement notes = XMLWork::getElement(docElem, QStringLiteral("notes"));
+    if (notes.isNull())
+        notes = XMLWork::getElement(docElem, QStringLiteral("items"));
+    structure.notes = notesFromXml(notes);
+    addFileStamps(structure.notes, basketFolder, htmlSummaries);
+
+    const QString path = cachePath(basketFolder);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << MAGIC << VERSION << basketInfo.size() << modificationTime(basketInfo) << hashOf(data) << structure.properties << structure.notes;
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+void BasketCache::rebuild(const QString &basketFolder, const QHash<QString, HtmlSummary> &htmlSummaries)
+{
+    if (!isEnabled())
+        return;
+
+    {
+        QMutexLocker locker(&pendingMutex);
+        const bool queued = pendingRebuilds.contains(basketFolder);
+        pendingRebuilds.insert(basketFolder, htmlSummaries);
+        if (queued)
+            return; // The waiting rebuild will use the newest summaries
+    }
+
+    rebuildPool()->start([basketFolder]() {
+        QHash<QString, HtmlSummary> summaries;
+        {
+            QMutexLocker locker(&pendingMutex);
+            if (!pendingRebuilds.contains(basketFolder))
+                return; // Cancelled by remove()
+            summaries = pendingRebuilds.take(basketFolder);
+        }
+        // Not in the debug window: it belongs to the GUI thread
+        if (!write(basketFolder, summaries))
+            qDebug() << "Could not write the cache of" << basketFolder;
+    });
+}
+
+void BasketCache::waitForRebuilds()
+{
+    rebuildPool()->waitForDone();
+}
+
+void BasketCache::remove(const QString &basketFolder)
+{
+    {
+        QMutexLocker locker(&pendingMutex);
+        pendingRebuilds.remove(basketFolder);
+    }
+    QFile::remove(cachePath(basketFolder));
+}
+
+void BasketCache::setEnabled(bool enable)
+{
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool BasketCache::isEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
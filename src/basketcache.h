@@ -0,0 +1,95 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef BASKETCACHE_H
+#define BASKETCACHE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include "basket_export.h"
+
+class QDomElement;
+
+/** Binary copy of the parsed .basket file of a basket, to open it again without parsing its XML
+ * nor computing the text equivalents of its HTML notes.
+ * The cache of a basket is a versioned QDataStream file in the cache folder of the application. It is read through a memory map,
+ * and only used if the .basket file has the size, modification time and SHA-1 recorded in it. The text equivalent of an HTML note is
+ * only used if its file also has the recorded size and modification time.
+ * The cache is rebuilt by a background thread after every save, from the saved file. Encrypted baskets are never cached.
+ */
+class BASKET_EXPORT BasketCache
+{
+public:
+    /// What is kept of an HTML note to load it without stripping its HTML
+    struct HtmlSummary {
+        qint64 fileSize = -1; ///< Size of the note file when the summary was made, or -1 if there is no summary
+        qint64 fileModified = 0; ///< Modification time of the note file, in milliseconds since the epoch
+        QString textEquivalent;
+        int minWidth = 0; ///< 0 if the note was not measured yet
+
+        bool isValid() const
+        {
+            return fileSize >= 0;
+        }
+    };
+
+    /// A note or a group of the basket, with its attributes as loaded by BasketScene::loadNotes()
+    struct Note {
+        bool isGroup = false;
+        QString type; ///< Lower type name of the content, eg. "html"
+        QString content; ///< Text of the content element: the file name, the URL or the color
+        QHash<QString, QString> contentAttributes;
+        int x = 0;
+        int y = 0;
+        int width = 200;
+        bool folded = false;
+        QDateTime added; ///< Null if not saved
+        QDateTime lastModification; ///< Null if not saved
+        QString tags; ///< Tag state ids, separated by semicolons
+        HtmlSummary html;
+        QList<Note> children;
+    };
+
+    struct Structure {
+        QString properties; ///< The XML of the properties element
+        QList<Note> notes;
+    };
+
+    /// The notes and groups of a <notes> element of a .basket file
+    static QList<Note> notesFromXml(const QDomElement &notes);
+
+    /** Read the cache of the basket stored in @p basketFolder (which ends with a slash).
+     * @return false if there is no cache, or if it is not valid anymore
+     */
+    static bool read(const QString &basketFolder, Structure *structure);
+
+    /** Write the cache of the basket stored in @p basketFolder, from its .basket file and from the text equivalents and minimum widths
+     * of its HTML notes, by file name. Blocks until the cache is written.
+     * A summary is only kept if its note file still has the size and modification time recorded in it when it was made.
+     */
+    static bool write(const QString &basketFolder, const QHash<QString, HtmlSummary> &htmlSummaries);
+
+    /// Same as write(), in a background thread. Rebuilds requested while an older one for the same basket waits are merged
+    static void rebuild(const QString &basketFolder, const QHash<QString, HtmlSummary> &htmlSummaries);
+
+    /// Wait for the background rebuilds to be done
+    static void waitForRebuilds();
+
+    /// Remove the cache of the basket stored in @p basketFolder and cancel its waiting rebuild, eg. when the basket is deleted or encrypted
+    static void remove(const QString &basketFolder);
+
+    /// @return the path of the cache file of the basket stored in @p basketFolder
+    static QString cachePath(const QString &basketFolder);
+
+    /// When disabled, caches are neither read nor rebuilt, eg. to measure loading baskets from their XML. Enabled by default
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+};
+
+#endif // BASKETCACHE_H
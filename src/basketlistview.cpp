@@ -35,6 +35,7 @@
 #include "notedrag.h"
 #include "settings.h"
 #include "tools.h"
+#include "xmlwork.h"
 
 /** class BasketListViewItem: */
 
@@ -70,8 +71,94 @@ BasketListViewItem::BasketListViewItem(QTreeWidgetItem *parent, QTreeWidgetItem
 {
 }
 
+BasketListViewItem::BasketListViewItem(QTreeWidget *parent, QTreeWidgetItem *after, const QString &folderName, const QDomElement &properties)
+    : QTreeWidgetItem(parent, after)
+    , m_basket(nullptr)
+    , m_folderName(folderName)
+    , m_isUnderDrag(false)
+    , m_isAbbreviated(false)
+{
+    readProperties(properties);
+}
+
+BasketListViewItem::BasketListViewItem(QTreeWidgetItem *parent, QTreeWidgetItem *after, const QString &folderName, const QDomElement &properties)
+    : QTreeWidgetItem(parent, after)
+    , m_basket(nullptr)
+    , m_folderName(folderName)
+    , m_isUnderDrag(false)
+    , m_isAbbreviated(false)
+{
+    readProperties(properties);
+}
+
 BasketListViewItem::~BasketListViewItem() = default;
 
+void BasketListViewItem::readProperties(const QDomElement &properties)
+{
+    if (!m_folderName.endsWith(QLatin1Char('/')))
+        m_folderName += QLatin1Char('/');
+
+    // Same defaults and compatibility rules as BasketScene::loadProperties():
+    m_properties = properties;
+    m_basketName = XMLWork::getElementText(properties, QStringLiteral("name"));
+    m_icon = XMLWork::getElementText(properties, QStringLiteral("icon"), QStringLiteral("org.kde.basket"));
+    QDomElement appearance = XMLWork::getElement(properties, QStringLiteral("appearance"));
+    QString backgroundColor = appearance.attribute(QStringLiteral("backgroundColor"), appearance.attribute(QStringLiteral("backroundColor")));
+    QString textColor = appearance.attribute(QStringLiteral("textColor"));
+    m_backgroundColor = (backgroundColor.isEmpty() ? QColor() : QColor(backgroundColor));
+    m_textColor = (textColor.isEmpty() ? QColor() : QColor(textColor));
+    m_shortcut = QKeySequence(XMLWork::getElement(properties, QStringLiteral("shortcut")).attribute(QStringLiteral("combination")));
+}
+
+BasketScene *BasketListViewItem::basket()
+{
+    if (!m_basket)
+        Global::bnpView->createBasket(this);
+    return m_basket;
+}
+
+void BasketListViewItem::setBasket(BasketScene *basket)
+{
+    m_basket = basket;
+}
+
+void BasketListViewItem::releaseBasket(const QDomElement &properties)
+{
+    m_folderName = m_basket->folderName();
+    m_basket = nullptr;
+    readProperties(properties);
+}
+
+QString BasketListViewItem::folderName() const
+{
+    return (m_basket ? m_basket->folderName() : m_folderName);
+}
+
+QString BasketListViewItem::basketName() const
+{
+    return (m_basket ? m_basket->basketName() : m_basketName);
+}
+
+QString BasketListViewItem::basketIcon() const
+{
+    return (m_basket ? m_basket->icon() : m_icon);
+}
+
+QKeySequence BasketListViewItem::basketShortcut() const
+{
+    return (m_basket ? m_basket->shortcut() : m_shortcut);
+}
+
+QColor BasketListViewItem::backgroundColorSetting() const
+{
+    return (m_basket ? m_basket->backgroundColorSetting() : m_backgroundColor);
+}
+
+QColor BasketListViewItem::textColorSetting() const
+{
+    return (m_basket ? m_basket->textColorSetting() : m_textColor);
+}
+
 QString BasketListViewItem::escapedName(const QString &string)
 {
     // Underlining the Alt+Letter shortcut (and escape all other '&' characters), if any:
@@ -80,7 +167,7 @@ QString BasketListViewItem::escapedName(const QString &string)
     QString letter;
     QRegularExpression letterExp(QStringLiteral("^Alt\\+(?:Shift\\+)?(.)$"));
 
-    QString basketShortcut = m_basket->shortcut().toString();
+    QString basketShortcut = this->basketShortcut().toString();
     if (basketShortcut.indexOf(letterExp) != -1) {
         int index;
         QRegularExpressionMatch letterMatch = letterExp.match(basketShortcut);
@@ -94,10 +181,10 @@ QString BasketListViewItem::escapedName(const QString &string)
 
 void BasketListViewItem::setup()
 {
-    setText(/*column=*/0, escapedName(m_basket->basketName()));
+    setText(/*column=*/0, escapedName(basketName()));
 
     QPixmap icon =
-        KIconLoader::global()->loadIcon(m_basket->icon(), KIconLoader::NoGroup, 16, KIconLoader::DefaultState, QStringList(), nullptr, /*canReturnNull=*/false);
+        KIconLoader::global()->loadIcon(basketIcon(), KIconLoader::NoGroup, 16, KIconLoader::DefaultState, QStringList(), nullptr, /*canReturnNull=*/false);
 
     setIcon(/*column=*/0, icon);
     /*
@@ -129,7 +216,7 @@ QStringList BasketListViewItem::childNamesTree(int deep)
 
     // Append the names of sub baskets
     if (deep > 0)
-        result.append(spaces + basket()->basketName());
+        result.append(spaces + basketName());
 
     // Append the children:
     for (int i = 0; i < childCount(); i++) {
@@ -177,7 +264,7 @@ bool BasketListViewItem::isShown()
 
 bool BasketListViewItem::isCurrentBasket()
 {
-    return basket() == Global::bnpView->currentBasket();
+    return m_basket && m_basket == Global::bnpView->currentBasket();
 }
 
 bool BasketListViewItem::isUnderDrag()
@@ -189,7 +276,8 @@ bool BasketListViewItem::haveChildsLoading()
 {
     for (int i = 0; i < childCount(); i++) {
         auto *childItem = (BasketListViewItem *)child(i);
-        if (!childItem->basket()->isLoaded() && !childItem->basket()->isLocked())
+        BasketScene *basket = childItem->basketIfCreated();
+        if (!basket || (!basket->isLoaded() && !basket->isLocked()))
             return true;
         if (childItem->haveChildsLoading())
             return true;
@@ -208,7 +296,7 @@ bool BasketListViewItem::haveChildsLocked()
 {
     for (int i = 0; i < childCount(); i++) {
         auto *childItem = (BasketListViewItem *)child(i);
-        if (/*!*/ childItem->basket()->isLocked())
+        if (/*!*/ childItem->basketIfCreated() && childItem->basketIfCreated()->isLocked())
             return true;
         if (childItem->haveChildsLocked())
             return true;
@@ -228,7 +316,8 @@ int BasketListViewItem::countChildsFound()
     int count = 0;
     for (int i = 0; i < childCount(); i++) {
         auto *childItem = (BasketListViewItem *)child(i);
-        count += childItem->basket()->countFounds();
+        if (childItem->basketIfCreated())
+            count += childItem->basketIfCreated()->countFounds();
         count += childItem->countChildsFound();
     }
     return count;
@@ -293,7 +382,7 @@ QMimeData *BasketTreeListView::mimeData(const QList<QTreeWidgetItem *> &items) c
 
     for (int i = 0; i < items.count(); ++i) {
         auto *basketItem = static_cast<BasketListViewItem *>(items[i]);
-        out << basketItem->basket()->basketName() << basketItem->basket()->folderName() << basketItem->basket()->icon();
+        out << basketItem->basketName() << basketItem->folderName() << basketItem->basketIcon();
     }
 
     auto *mimeData = new QMimeData();
@@ -310,7 +399,7 @@ bool BasketTreeListView::event(QEvent *e)
         auto *bitem = dynamic_cast<BasketListViewItem *>(item);
         if (bitem && bitem->isAbbreviated()) {
             QRect rect = visualItemRect(bitem);
-            QToolTip::showText(rect.topLeft(), bitem->basket()->basketName(), viewport(), rect);
+            QToolTip::showText(rect.topLeft(), bitem->basketName(), viewport(), rect);
         }
         return true;
     }
@@ -483,7 +572,10 @@ void FoundCountIcon::paint(QPainter *painter, const QStyleOptionViewItem &option
     const int BASKET_ICON_SIZE = 16; // [replace with m_basketTree->iconSize()]
     const int MARGIN = 1;
 
-    BasketScene *basket = basketInTree->basket();
+    // Painting must not create the basket: it is nullptr if the basket is not created yet, and is then considered not loaded
+    BasketScene *basket = basketInTree->basketIfCreated();
+    const bool isLoaded = basket && basket->isLoaded();
+    const bool isLocked = basket && basket->isLocked();
 
     // If we are filtering all baskets, and are effectively filtering on something:
     bool showLoadingIcon = false;
@@ -491,12 +583,12 @@ void FoundCountIcon::paint(QPainter *painter, const QStyleOptionViewItem &option
     QPixmap countPixmap;
     bool showCountPixmap = Global::bnpView->isFilteringAllBaskets() && Global::bnpView->currentBasket()->decoration()->filterBar()->filterData().isFiltering;
     if (showCountPixmap) {
-        showLoadingIcon = (!basket->isLoaded() && !basket->isLocked()) || basketInTree->haveHiddenChildsLoading();
-        showEncryptedIcon = basket->isLocked() || basketInTree->haveHiddenChildsLocked();
+        showLoadingIcon = (!isLoaded && !isLocked) || basketInTree->haveHiddenChildsLoading();
+        showEncryptedIcon = isLocked || basketInTree->haveHiddenChildsLocked();
         bool childrenAreLoading = basketInTree->haveHiddenChildsLoading() || basketInTree->haveHiddenChildsLocked();
 
-        countPixmap = foundCountPixmap(!basket->isLoaded(),
-                                       basket->countFounds(),
+        countPixmap = foundCountPixmap(!isLoaded,
+                                       basket ? basket->countFounds() : 0,
                                        childrenAreLoading,
                                        basketInTree->countHiddenChildsFound(),
                                        m_basketTree->font(),
@@ -505,12 +597,16 @@ void FoundCountIcon::paint(QPainter *painter, const QStyleOptionViewItem &option
     int effectiveWidth = option.rect.right() - (countPixmap.isNull() ? 0 : countPixmap.width() + MARGIN)
         - (showLoadingIcon || showEncryptedIcon ? BASKET_ICON_SIZE + MARGIN : 0);
 
-    bool drawRoundRect = basket->backgroundColorSetting().isValid() || basket->textColorSetting().isValid();
+    const QColor backgroundColorSetting = basketInTree->backgroundColorSetting();
+    const QColor textColorSetting = basketInTree->textColorSetting();
+    bool drawRoundRect = backgroundColorSetting.isValid() || textColorSetting.isValid();
 
     // Draw the rounded rectangle:
     if (drawRoundRect) {
         QPixmap roundRectBmp;
-        QColor background = basket->backgroundColor();
+        QColor background = (basket ? basket->backgroundColor() : backgroundColorSetting);
+        if (!background.isValid())
+            background = m_basketTree->palette().color(QPalette::Base);
         int textWidth = m_basketTree->fontMetrics().horizontalAdvance(basketInTree->text(/*column=*/0));
         int iconTextMargin = m_basketTree->style()->pixelMetric(QStyle::PM_FocusFrameHMargin); ///< Space between icon and text
 
@@ -539,7 +635,10 @@ void FoundCountIcon::paint(QPainter *painter, const QStyleOptionViewItem &option
         }
 
         basketInTree->setBackground(0, QBrush(roundRectBmp));
-        basketInTree->setForeground(0, QBrush(basket->textColor()));
+        QColor foreground = (basket ? basket->textColor() : textColorSetting);
+        if (!foreground.isValid())
+            foreground = m_basketTree->palette().color(QPalette::Text);
+        basketInTree->setForeground(0, QBrush(foreground));
     }
     // end if drawRoundRect
 
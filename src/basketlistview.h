@@ -6,6 +6,9 @@
 #ifndef BASKETLISTVIEW_H
 #define BASKETLISTVIEW_H
 
+#include <QColor>
+#include <QDomElement>
+#include <QKeySequence>
 #include <QStyledItemDelegate>
 #include <QTimer>
 #include <QTreeWidget>
@@ -28,12 +31,39 @@ public:
     BasketListViewItem(QTreeWidgetItem *parent, BasketScene *basket);
     BasketListViewItem(QTreeWidget *parent, QTreeWidgetItem *after, BasketScene *basket);
     BasketListViewItem(QTreeWidgetItem *parent, QTreeWidgetItem *after, BasketScene *basket);
+    /// Items of baskets not created yet: only the folder name and the <properties> element of baskets.xml are known
+    BasketListViewItem(QTreeWidget *parent, QTreeWidgetItem *after, const QString &folderName, const QDomElement &properties);
+    BasketListViewItem(QTreeWidgetItem *parent, QTreeWidgetItem *after, const QString &folderName, const QDomElement &properties);
     ~BasketListViewItem() override;
 
-    BasketScene *basket()
+    /// The basket of the item. It is created the first time it is needed
+    BasketScene *basket();
+    /// The basket of the item, or nullptr if it is not created yet (or was released)
+    BasketScene *basketIfCreated() const
     {
         return m_basket;
     }
+    bool isBasketCreated() const
+    {
+        return m_basket != nullptr;
+    }
+    /// Set the basket created for this item by BNPView
+    void setBasket(BasketScene *basket);
+    /// Forget the basket, that is about to be deleted, and keep only its @p properties (a <properties> element) until it is created again
+    void releaseBasket(const QDomElement &properties);
+    const QDomElement &properties() const
+    {
+        return m_properties;
+    }
+
+    // Properties known without creating the basket:
+    QString folderName() const;
+    QString basketName() const;
+    QString basketIcon() const;
+    QKeySequence basketShortcut() const;
+    QColor backgroundColorSetting() const;
+    QColor textColorSetting() const;
+
     void setup();
     BasketListViewItem *lastChild();
     QStringList childNamesTree(int deep = 0);
@@ -56,7 +86,16 @@ public:
     void setAbbreviated(bool b);
 
 private:
+    void readProperties(const QDomElement &properties);
+
     BasketScene *m_basket;
+    QString m_folderName;
+    QDomElement m_properties;
+    QString m_basketName;
+    QString m_icon;
+    QKeySequence m_shortcut;
+    QColor m_backgroundColor;
+    QColor m_textColor;
     int m_width;
     bool m_isUnderDrag;
     bool m_isAbbreviated;
@@ -86,6 +86,7 @@
 #include "settings.h"
 #include "tagsedit.h"
 #include "tools.h"
+#include "tracing.h"
 #include "xmlwork.h"
 
 #include "config.h"
@@ -498,23 +499,22 @@ void BasketScene::doCleanUp()
 {
     QSet<Note *>::iterator it = m_notesToBeDeleted.begin();
     while (it != m_notesToBeDeleted.end()) {
-        delete *it;
+        // A cut note is kept by the clipboard, which will only compute its flavours if they are asked for:
+        if (!NoteDrag::adoptCutNote(*it))
+            delete *it;
         it = m_notesToBeDeleted.erase(it);
     }
 }
 
-void BasketScene::loadNotes(const QDomElement &notes, Note *parent)
+void BasketScene::loadNotes(const QList<BasketCache::Note> &notes, Note *parent)
 {
+    BASKET_TRACE("BasketScene::loadNotes");
     Note *note;
-    for (QDomNode n = notes.firstChild(); !n.isNull(); n = n.nextSibling()) {
-        QDomElement e = n.toElement();
-        if (e.isNull()) // Cannot handle that!
-            continue;
-        note = nullptr;
+    for (const BasketCache::Note &record : notes) {
         // Load a Group:
-        if (e.tagName() == QStringLiteral("group")) {
+        if (record.isGroup) {
             note = new Note(this); // 1. Create the group...
-            loadNotes(e, note); // 3. ... And populate it with child notes.
+            loadNotes(record.children, note); // 3. ... And populate it with child notes.
             int noteCount = note->count();
             if (noteCount > 0 || (parent == nullptr && !isFreeLayout())) { // But don't remove columns!
                 appendNoteIn(note, parent); // 2. ... Insert it... FIXME: Initially, the if() the insertion was the step 2. Was it on purpose?
@@ -524,52 +524,62 @@ void BasketScene::loadNotes(const QDomElement &notes, Note *parent)
             }
         }
         // Load a Content-Based Note:
-        if (e.tagName() == QStringLiteral("note") || e.tagName() == QStringLiteral("item")) { // Keep compatible with 0.6.0 Alpha 1
+        else {
             note = new Note(this); // Create the note...
-            NoteFactory::loadNode(XMLWork::getElement(e, QStringLiteral("content")),
-                                  e.attribute(QStringLiteral("type")),
-                                  note,
-                                  /*lazyLoad=*/m_finishLoadOnFirstShow); // ... Populate it with content...
-            if (e.attribute(QStringLiteral("type")) == QStringLiteral("text"))
+            // ... Populate it with content...
+            if (record.type == QStringLiteral("html") && record.html.isValid())
+                new HtmlContent(note, record.content, /*lazyLoad=*/m_finishLoadOnFirstShow, record.html);
+            else
+                NoteFactory::loadNode(record.content, record.contentAttributes, record.type, note, /*lazyLoad=*/m_finishLoadOnFirstShow);
+            if (record.type == QStringLiteral("text"))
                 m_shouldConvertPlainTextNotes = true; // Convert Pre-0.6.0 baskets: plain text notes should be converted to rich text ones once all is loaded!
             appendNoteIn(note, parent); // ... And insert it.
             // Load dates:
-            if (e.hasAttribute(QStringLiteral("added")))
-                note->setAddedDate(QDateTime::fromString(e.attribute(QStringLiteral("added")), Qt::ISODate));
-            if (e.hasAttribute(QStringLiteral("lastModification")))
-                note->setLastModificationDate(QDateTime::fromString(e.attribute(QStringLiteral("lastModification")), Qt::ISODate));
+            if (!record.added.isNull())
+                note->setAddedDate(record.added);
+            if (!record.lastModification.isNull())
+                note->setLastModificationDate(record.lastModification);
         }
-        // If we successfully loaded a note:
-        if (note) {
-            // Free Note Properties:
-            if (note->isFree()) {
-                int x = e.attribute(QStringLiteral("x")).toInt();
-                int y = e.attribute(QStringLiteral("y")).toInt();
-                qDebug() << "Free Note Properties";
-                note->setX(x < 0 ? 0 : x);
-                note->setY(y < 0 ? 0 : y);
-            }
-            // Resizeable Note Properties:
-            if (note->hasResizer() || note->isColumn())
-                note->setGroupWidth(e.attribute(QStringLiteral("width"), QStringLiteral("200")).toInt());
-            // Group Properties:
-            if (note->isGroup() && !note->isColumn() && XMLWork::trueOrFalse(e.attribute(QStringLiteral("folded"), QStringLiteral("false"))))
-                note->toggleFolded();
-            // Tags:
-            if (note->content()) {
-                QString tagsString = XMLWork::getElementText(e, QStringLiteral("tags"), QString());
-                QStringList tagsId = tagsString.split(QLatin1Char(';'));
-                for (QStringList::iterator it = tagsId.begin(); it != tagsId.end(); ++it) {
-                    State *state = Tag::stateById(*it);
-                    if (state)
-                        note->addState(state, /*orReplace=*/true);
-                }
+        // Free Note Properties:
+        if (note->isFree()) {
+            note->setX(record.x < 0 ? 0 : record.x);
+            note->setY(record.y < 0 ? 0 : record.y);
+        }
+        // Resizeable Note Properties:
+        if (note->hasResizer() || note->isColumn())
+            note->setGroupWidth(record.width);
+        // Group Properties:
+        if (note->isGroup() && !note->isColumn() && record.folded)
+            note->toggleFolded();
+        // Tags:
+        if (note->content()) {
+            const QStringList tagsId = record.tags.split(QLatin1Char(';'), Qt::SkipEmptyParts);
+            for (const QString &tagId : tagsId) {
+                State *state = Tag::stateById(tagId);
+                if (state)
+                    note->addState(state, /*orReplace=*/true);
             }
         }
         qApp->processEvents();
     }
 }
 
+static void collectHtmlSummaries(Note *note, QHash<QString, BasketCache::HtmlSummary> &summaries)
+{
+    for (; note; note = note->next()) {
+        if (note->content() && note->content()->type() == NoteType::Html)
+            summaries.insert(note->content()->fileName(), static_cast<HtmlContent *>(note->content())->cacheSummary());
+        collectHtmlSummaries(note->firstChild(), summaries);
+    }
+}
+
+QHash<QString, BasketCache::HtmlSummary> BasketScene::htmlSummaries()
+{
+    QHash<QString, BasketCache::HtmlSummary> summaries;
+    collectHtmlSummaries(firstNote(), summaries);
+    return summaries;
+}
+
 void BasketScene::saveNotes(QXmlStreamWriter &stream, Note *parent)
 {
     Note *note = (parent ? parent->firstChild() : firstNote());
@@ -597,11 +607,12 @@ void BasketScene::saveNotes(QXmlStreamWriter &stream, Note *parent)
             note->content()->saveToNode(stream);
             // Save Tags:
             if (note->states().count() > 0) {
-                QString tags;
+                QStringList tags;
+                tags.reserve(note->states().count());
                 for (State::List::iterator it = note->states().begin(); it != note->states().end(); ++it) {
-                    tags += (tags.isEmpty() ? QString() : QStringLiteral(";")) + (*it)->id();
+                    tags.append((*it)->id());
                 }
-                stream.writeTextElement("tags", tags);
+                stream.writeTextElement("tags", tags.join(QLatin1Char(';')));
             }
         } else {
             // Save Child Notes:
@@ -899,7 +910,8 @@ void BasketScene::equalizeColumnSizes()
 
 void BasketScene::enableActions()
 {
-    Global::bnpView->enableActions();
+    if (Global::bnpView)
+        Global::bnpView->enableActions();
     m_view->setFocusPolicy(isLocked() ? Qt::NoFocus : Qt::StrongFocus);
     if (isLocked())
         m_view->viewport()->setCursor(Qt::ArrowCursor); // When locking, the cursor stays the last form it was
@@ -907,9 +919,13 @@ void BasketScene::enableActions()
 
 bool BasketScene::save()
 {
+    BASKET_TRACE("BasketScene::save");
     if (!m_loaded)
         return false;
 
+    QElapsedTimer timer;
+    timer.start();
+
     DEBUG_WIN << QStringLiteral("Basket[") + folderName() + QStringLiteral("]: Saving...");
 
     QString data;
@@ -928,12 +944,20 @@ bool BasketScene::save()
     stream.writeEndDocument();
 
     // Write to Disk:
-    if (!FileStorage::saveToFile(fullPath() + QStringLiteral(".basket"), data, isEncrypted())) {
+    if (!saveBasketFile(data)) {
         DEBUG_WIN << QStringLiteral("Basket[") + folderName() + QStringLiteral("]: <font color=red>FAILED to save</font>!");
         return false;
     }
 
-    Global::bnpView->setUnsavedStatus(false);
+    if (Global::bnpView)
+        Global::bnpView->setUnsavedStatus(false);
+    m_timings.lastSaveUs = timer.nsecsElapsed() / 1000;
+
+    // The cache would keep the text of encrypted notes in clear:
+    if (isEncrypted())
+        BasketCache::remove(fullPath());
+    else
+        BasketCache::rebuild(fullPath(), htmlSummaries());
 
     m_commitdelay.start(10000); // delay is 10 seconds
 
@@ -948,8 +972,10 @@ void BasketScene::commitEdit()
 void BasketScene::aboutToBeActivated()
 {
     if (m_finishLoadOnFirstShow) {
+        QList<HtmlContent *> htmlContents;
         FOR_EACH_NOTE(note)
-        note->finishLazyLoad();
+        note->finishLazyLoad(&htmlContents);
+        HtmlContent::finishLazyLoad(htmlContents);
 
         relayoutNotes(/*animate=*/true);
         setFocusedNote(nullptr); // So that during the focusInEvent that will come shortly, the FIRST note is focused.
@@ -964,27 +990,54 @@ void BasketScene::reload()
     closeEditor();
     unbufferizeAll(); // Keep the memory footprint low
 
-    m_firstNote = nullptr;
+    deleteNotes(); // They would stay in the scene, and be drawn below the reloaded ones
 
     m_loaded = false;
     m_loadingLaunched = false;
+    m_finishLoadOnFirstShow = false;
 
     invalidate();
 }
 
+void BasketScene::unload()
+{
+    BASKET_TRACE("BasketScene::unload");
+    // The notes are saved as soon as they are modified, and closing the editor saves the edited one:
+    reload();
+
+    if (!m_watchedFiles.isEmpty()) {
+        m_watcher->removeDir(fullPath());
+        m_watchedFiles.clear();
+        --s_watchedFolders;
+        reportWatcherActivity(QString());
+    }
+}
+
 void BasketScene::load()
 {
+    BASKET_TRACE("BasketScene::load");
     // Load only once:
     if (m_loadingLaunched)
         return;
     m_loadingLaunched = true;
 
+    QElapsedTimer timer;
+    timer.start();
     DEBUG_WIN << QStringLiteral("Basket[") + folderName() + QStringLiteral("]: Loading...");
     QDomDocument *doc = nullptr;
     QString content;
 
+    // Reopen the basket from its cache, without parsing its XML, if it did not change since it was cached:
+    BasketCache::Structure structure;
+    const bool fromCache = !isEncrypted() && BasketCache::read(fullPath(), &structure);
+    if (fromCache) {
+        doc = new QDomDocument(QStringLiteral("basket"));
+        doc->setContent(structure.properties);
+        DEBUG_WIN << QStringLiteral("Basket[") + folderName() + QStringLiteral("]: Loading from the cache");
+    }
+
     // Load properties
-    if (FileStorage::loadFromFile(fullPath() + QStringLiteral(".basket"), &content)) {
+    if (!fromCache && loadBasketFile(&content)) {
         doc = new QDomDocument(QStringLiteral("basket"));
         if (!doc->setContent(content)) {
             DEBUG_WIN << QStringLiteral("Basket[") + folderName() + QStringLiteral("]: <font color=red>FAILED to parse XML</font>!");
@@ -999,28 +1052,32 @@ void BasketScene::load()
         m_loadingLaunched = false;
         if (isEncrypted())
             m_locked = true;
-        Global::bnpView->notesStateChanged(); // Show "Locked" instead of "Loading..." in the statusbar
+        if (Global::bnpView)
+            Global::bnpView->notesStateChanged(); // Show "Locked" instead of "Loading..." in the statusbar
         return;
     }
     m_locked = false;
 
     QDomElement docElem = doc->documentElement();
-    QDomElement properties = XMLWork::getElement(docElem, QStringLiteral("properties"));
+    QDomElement properties = (fromCache ? docElem : XMLWork::getElement(docElem, QStringLiteral("properties")));
 
     loadProperties(properties); // Since we are loading, this time the background image will also be loaded!
     // Now that the background image is loaded and subscribed, we display it during the load process:
     delete doc;
 
-    // BEGIN Compatibility with 0.6.0 Pre-Alpha versions:
-    QDomElement notes = XMLWork::getElement(docElem, QStringLiteral("notes"));
-    if (notes.isNull())
-        notes = XMLWork::getElement(docElem, QStringLiteral("items"));
+    if (!fromCache) {
+        // BEGIN Compatibility with 0.6.0 Pre-Alpha versions:
+        QDomElement notes = XMLWork::getElement(docElem, QStringLiteral("notes"));
+        if (notes.isNull())
+            notes = XMLWork::getElement(docElem, QStringLiteral("items"));
+        structure.notes = BasketCache::notesFromXml(notes);
+    }
     m_watcher->stopScan();
     m_shouldConvertPlainTextNotes = false; // Convert Pre-0.6.0 baskets: plain text notes should be converted to rich text ones once all is loaded!
 
     // Load notes
-    m_finishLoadOnFirstShow = (Global::bnpView->currentBasket() != this);
-    loadNotes(notes, nullptr);
+    m_finishLoadOnFirstShow = (Global::bnpView && Global::bnpView->currentBasket() != this);
+    loadNotes(structure.notes, nullptr);
     if (m_shouldConvertPlainTextNotes)
         convertTexts();
     m_watcher->startScan();
@@ -1040,12 +1097,57 @@ void BasketScene::load()
     relayoutNotes();
 
     // On application start, the current basket is not focused yet, so the focus rectangle is not shown when calling focusANote():
-    if (Global::bnpView->currentBasket() == this)
+    if (Global::bnpView && Global::bnpView->currentBasket() == this)
         setFocus();
     focusANote();
 
     m_loaded = true;
+    m_timings.lastLoadUs = timer.nsecsElapsed() / 1000;
     enableActions();
+
+    // The next load will be faster. An encrypted basket must not have one left by the time it was not encrypted:
+    if (isEncrypted())
+        BasketCache::remove(fullPath());
+    else if (!fromCache)
+        BasketCache::rebuild(fullPath(), htmlSummaries());
+}
+
+bool BasketScene::loadBasketFile(QString *content)
+{
+#ifdef HAVE_LIBGPGME
+    // Only use gpg-agent for private key encryption since it doesn't
+    // cache password used in symmetric encryption.
+    m_gpg->setUseGnuPGAgent(Settings::useGnuPGAgent() && m_encryptionType == PrivateKeyEncryption);
+    if (m_encryptionType == PrivateKeyEncryption)
+        m_gpg->setText(i18n("Please enter the password for the following private key:"), false);
+    else
+        m_gpg->setText(i18n("Please enter the password for the basket <b>%1</b>:", basketName()), false); // Used when decrypting
+    return FileStorage::loadFromFile(fullPath() + QStringLiteral(".basket"), content, m_gpg);
+#else
+    return FileStorage::loadFromFile(fullPath() + QStringLiteral(".basket"), content);
+#endif
+}
+
+bool BasketScene::saveBasketFile(const QString &content)
+{
+    if (!isEncrypted())
+        return FileStorage::saveToFile(fullPath() + QStringLiteral(".basket"), content);
+
+#ifdef HAVE_LIBGPGME
+    QString key;
+    // We only use gpg-agent for private key encryption and saving without
+    // public key doesn't need one.
+    m_gpg->setUseGnuPGAgent(false);
+    if (m_encryptionType == PrivateKeyEncryption) {
+        key = m_encryptionKey;
+        // public key doesn't need password
+        m_gpg->setText(QString(), false);
+    } else
+        m_gpg->setText(i18n("Please assign a password to the basket <b>%1</b>:", basketName()), true); // Used when defining a new password
+    return FileStorage::saveToFile(fullPath() + QStringLiteral(".basket"), content, m_gpg, key);
+#else
+    return false;
+#endif
 }
 
 void BasketScene::filterAgain(bool andEnsureVisible /* = true*/)
@@ -1062,11 +1164,12 @@ void BasketScene::filterAgainDelayed()
 
 void BasketScene::newFilter(const FilterData &data, bool andEnsureVisible /* = true*/)
 {
+    BASKET_TRACE("BasketScene::newFilter");
     if (!isLoaded())
         return;
 
-    // StopWatch::start(20);
-
+    QElapsedTimer timer;
+    timer.start();
     m_countFounds = 0;
     // Search within basket titles as well
     if (data.tagFilterType == FilterData::DontCareTagsFilter)
@@ -1081,14 +1184,17 @@ void BasketScene::newFilter(const FilterData &data, bool andEnsureVisible /* = t
     relayoutNotes(true);
     signalCountsChanged();
 
+    m_timings.lastFilterUs = timer.nsecsElapsed() / 1000;
+    m_timings.maxFilterUs = qMax(m_timings.maxFilterUs, m_timings.lastFilterUs);
+    ++m_timings.filters;
+
     if (hasFocus()) // if (!hasFocus()), focusANote() will be called at focusInEvent()
         focusANote(); //  so, we avoid de-focus a note if it will be re-shown soon
     if (andEnsureVisible && m_focusedNote != nullptr)
         ensureNoteVisible(m_focusedNote);
 
-    Global::bnpView->setFiltering(data.isFiltering);
-
-    // StopWatch::check(20);
+    if (Global::bnpView)
+        Global::bnpView->setFiltering(data.isFiltering);
 }
 
 bool BasketScene::isFiltering()
@@ -1117,7 +1223,7 @@ void BasketScene::setShortcut(QKeySequence shortcut, int action)
     m_action->setShortcuts(shortcuts);
     m_shortcutAction = action;
 
-    if (!shortcut.isEmpty()) {
+    if (!shortcut.isEmpty() && Global::bnpView) {
         if (action > 0) {
             KGlobalAccel::self()->setShortcut(m_action, shortcuts, KGlobalAccel::Autoloading);
             KGlobalAccel::self()->setDefaultShortcut(m_action, shortcuts, KGlobalAccel::Autoloading);
@@ -1190,12 +1296,12 @@ BasketScene::BasketScene(QWidget *parent, const QString &folderName)
     , m_inserterSplit(true)
     , m_inserterTop(false)
     , m_inserterGroup(false)
+    , m_tagChangesDepth(0)
     , m_lastDisableClick(QTime::currentTime())
     , m_isSelecting(false)
     , m_selectionStarted(false)
     , m_count(0)
     , m_countFounds(0)
-    , m_countSelecteds(0)
     , m_icon(QStringLiteral("org.kde.basket"))
     , m_folderName(folderName)
     , m_editor(nullptr)
@@ -1211,6 +1317,7 @@ BasketScene::BasketScene(QWidget *parent, const QString &folderName)
     , m_finishLoadOnFirstShow(false)
     , m_relayoutOnNextShow(false)
 {
+    m_activationTimer.start();
     m_view = new BasketView(this);
     m_view->setFocusPolicy(Qt::StrongFocus);
     m_view->setAlignment(Qt::AlignLeft | Qt::AlignTop);
@@ -1223,10 +1330,15 @@ BasketScene::BasketScene(QWidget *parent, const QString &folderName)
     if (!m_folderName.endsWith(QLatin1Char('/')))
         m_folderName += QLatin1Char('/');
 
-    KActionCollection *ac = Global::bnpView->actionCollection();
-    m_action = ac->addAction(m_folderName, this, &BasketScene::activatedShortcut);
-    ac->setShortcutsConfigurable(m_action, false);
-    KGlobalAccel::setGlobalShortcut(m_action, (QKeySequence()));
+    // Without main window (eg. in basketbatch), the action only keeps the shortcut, and is never registered:
+    if (Global::bnpView) {
+        KActionCollection *ac = Global::bnpView->actionCollection();
+        m_action = ac->addAction(m_folderName, this, &BasketScene::activatedShortcut);
+        ac->setShortcutsConfigurable(m_action, false);
+        KGlobalAccel::setGlobalShortcut(m_action, (QKeySequence()));
+    } else {
+        m_action = new QAction(this);
+    }
 
     //    setDragAutoScroll(true);
 
@@ -1246,6 +1358,7 @@ BasketScene::BasketScene(QWidget *parent, const QString &folderName)
     connect(m_watcher, &KDirWatch::dirty, this, &BasketScene::watchedFileModified);
     // connect(m_watcher, &KDirWatch::deleted, this, &BasketScene::watchedFileDeleted);
     connect(&m_watcherTimer, &QTimer::timeout, this, &BasketScene::updateModifiedNotes);
+    m_watcherBurstEvents = 0;
 
     // Various Connections:
     connect(&m_autoScrollSelectionTimer, &QTimer::timeout, this, &BasketScene::doAutoScrollSelection);
@@ -1253,6 +1366,12 @@ BasketScene::BasketScene(QWidget *parent, const QString &folderName)
     connect(&m_inactivityAutoSaveTimer, &QTimer::timeout, this, &BasketScene::inactivityAutoSaveTimeout);
     connect(&m_inactivityAutoLockTimer, &QTimer::timeout, this, &BasketScene::inactivityAutoLockTimeout);
 
+    // Virtualisation: coalesce the scroll and relayout events
+    m_materializeTimer.setSingleShot(true);
+    connect(&m_materializeTimer, &QTimer::timeout, this, &BasketScene::updateMaterializedNotes);
+    connect(m_view->verticalScrollBar(), &QScrollBar::valueChanged, &m_materializeTimer, qOverload<>(&QTimer::start));
+    connect(m_view->horizontalScrollBar(), &QScrollBar::valueChanged, &m_materializeTimer, qOverload<>(&QTimer::start));
+
 #ifdef HAVE_LIBGPGME
     m_gpg = new KGpgMe();
 #endif
@@ -1641,14 +1760,11 @@ void BasketScene::recomputeAllStyles()
 
 void BasketScene::removedStates(const QList<State *> &deletedStates)
 {
-    bool modifiedBasket = false;
-
+    // The modified notes are restyled and saved once, when committing:
+    beginTagChanges();
     FOR_EACH_NOTE(note)
-    if (note->removedStates(deletedStates))
-        modifiedBasket = true;
-
-    if (modifiedBasket)
-        save();
+    note->removedStates(deletedStates);
+    commitTagChanges();
 }
 
 void BasketScene::insertNote(Note *note, Note *clicked, int zone, const QPointF &pos, bool animate)
@@ -2501,6 +2617,7 @@ void BasketScene::resetWasInLastSelectionRect()
         note->resetWasInLastSelectionRect();
         note = note->next();
     }
+    m_lastSelectedInRect = QRectF();
 }
 
 void BasketScene::selectAll()
@@ -2537,9 +2654,10 @@ void BasketScene::unselectAll()
         } else if (m_editor->lineEdit())
             m_editor->lineEdit()->deselect();
     } else {
-        if (countSelecteds() > 0) // Optimization
-            FOR_EACH_NOTE(note)
-        note->setSelectedRecursively(false);
+        // Only the selected notes need to be visited:
+        const QSet<Note *> selection = m_selectedNotes;
+        for (Note *note : selection)
+            note->setSelected(false);
     }
 }
 
@@ -2551,20 +2669,55 @@ void BasketScene::invertSelection()
 
 void BasketScene::unselectAllBut(Note *toSelect)
 {
-    FOR_EACH_NOTE(note)
-    note->unselectAllBut(toSelect);
+    // A note hidden in a folded group or by the filter cannot be kept selected:
+    if (toSelect && !toSelect->isShown())
+        toSelect = nullptr;
+
+    const QSet<Note *> selection = m_selectedNotes;
+    for (Note *note : selection) {
+        Note *ancestor = note;
+        while (ancestor && ancestor != toSelect)
+            ancestor = ancestor->parentNote();
+        if (!ancestor)
+            note->setSelected(false);
+    }
+
+    if (toSelect)
+        toSelect->setSelectedRecursively(true);
 }
 
 void BasketScene::invertSelectionOf(Note *toSelect)
 {
-    FOR_EACH_NOTE(note)
-    note->invertSelectionOf(toSelect);
+    if (toSelect && toSelect->isShown())
+        toSelect->setSelectedRecursively(!toSelect->isSelected());
 }
 
 void BasketScene::selectNotesIn(const QRectF &rect, bool invertSelection, bool unselectOthers /*= true*/)
 {
-    FOR_EACH_NOTE(note)
-    note->selectIn(rect, invertSelection, unselectOthers);
+    // Only the notes under the new or the previous rectangle, and the already selected ones, can change:
+    // find them through the index of the scene instead of walking every note of the basket.
+    QSet<Note *> candidates = m_selectedNotes;
+    for (const QRectF &area : {rect, m_lastSelectedInRect}) {
+        if (area.isNull())
+            continue;
+        const QList<QGraphicsItem *> itemsInArea = items(area);
+        for (QGraphicsItem *item : itemsInArea) {
+            while (item && !dynamic_cast<Note *>(item))
+                item = item->parentItem();
+            if (item)
+                candidates.insert(static_cast<Note *>(item));
+        }
+    }
+    m_lastSelectedInRect = rect;
+
+    for (Note *note : std::as_const(candidates)) {
+        if (note->isGroup())
+            continue;
+        if (note->isShown())
+            note->selectIn(rect, invertSelection, unselectOthers);
+        else
+            note->setSelected(false);
+    }
 }
 
 void BasketScene::doHoverEffects()
@@ -2882,7 +3035,7 @@ void BasketScene::deleteNotes()
     m_hoveredNote = nullptr;
     m_count = 0;
     m_countFounds = 0;
-    m_countSelecteds = 0;
+    m_selectedNotes.clear();
 
     Q_EMIT resetStatusBarText();
     Q_EMIT countsChanged(this);
@@ -2942,8 +3095,12 @@ BasketScene::~BasketScene()
     delete m_gpg;
 #endif
     blockSignals(true);
+    NoteDrag::basketAboutToBeDeleted(this);
     deleteNotes();
 
+    if (!m_watchedFiles.isEmpty())
+        --s_watchedFolders;
+
     if (m_view)
         delete m_view;
 }
@@ -3112,21 +3269,25 @@ void BasketScene::drawForeground(QPainter *painter, const QRectF &rect)
  */
 void BasketScene::blendBackground(QPainter &painter, const QRectF &rect, qreal xPainter, qreal yPainter, bool opaque, QPixmap *bg)
 {
-    painter.save();
+    if (!hasBackgroundImage())
+        return;
+
     if (xPainter == -1 && yPainter == -1) {
         xPainter = rect.x();
         yPainter = rect.y();
     }
 
-    if (hasBackgroundImage()) {
-        const QPixmap *bgPixmap = (bg ? /* * */ bg : (opaque ? m_opaqueBackgroundPixmap : m_backgroundPixmap));
-        if (isTiledBackground()) {
-            painter.drawTiledPixmap(rect.x() - xPainter, rect.y() - yPainter, rect.width(), rect.height(), *bgPixmap, rect.x(), rect.y());
-        } else {
-            painter.drawPixmap(QPointF(rect.x() - xPainter, rect.y() - yPainter), *bgPixmap, rect);
-        }
+    // The pixmaps of BackgroundManager are pre-composited tiles at the screen device pixel ratio: they are blitted as is, without changing the painter
+    // state:
+    const QPixmap *bgPixmap = (bg ? /* * */ bg : (opaque ? m_opaqueBackgroundPixmap : m_backgroundPixmap));
+    if (isTiledBackground()) {
+        painter.drawTiledPixmap(QRectF(rect.x() - xPainter, rect.y() - yPainter, rect.width(), rect.height()), *bgPixmap, rect.topLeft());
+    } else {
+        const qreal ratio = bgPixmap->devicePixelRatio();
+        painter.drawPixmap(QRectF(rect.x() - xPainter, rect.y() - yPainter, rect.width(), rect.height()),
+                           *bgPixmap,
+                           QRectF(rect.x() * ratio, rect.y() * ratio, rect.width() * ratio, rect.height() * ratio));
     }
-    painter.restore();
 }
 
 void BasketScene::recomputeBlankRects()
@@ -3150,26 +3311,15 @@ bool BasketScene::isAnimated()
 }
 void BasketScene::enableAnimation()
 {
-    m_animations->start();
     m_animated = true;
 }
 
 void BasketScene::disableAnimation()
 {
-    m_animations->stop();
+    m_animations->finish(); // New moves are not started while m_animated is false, see Note::setX()
     m_animated = false;
 }
 
-void BasketScene::addAnimation(NoteAnimation *animation)
-{
-    m_animations->addAnimation(animation);
-}
-
-void BasketScene::removeAnimation(NoteAnimation *animation)
-{
-    m_animations->removeAnimation(animation);
-}
-
 void BasketScene::unsetNotesWidth()
 {
     Note *note = m_firstNote;
@@ -3181,7 +3331,8 @@ void BasketScene::unsetNotesWidth()
 
 void BasketScene::relayoutNotes(bool animate)
 {
-    if (Global::bnpView->currentBasket() != this)
+    BASKET_TRACE("BasketScene::relayoutNotes");
+    if (Global::bnpView && Global::bnpView->currentBasket() != this)
         return; // Optimize load time, and basket will be relaid out when activated, anyway
     qDebug() << "relayoutNotes";
     int h = 0;
@@ -3215,6 +3366,17 @@ void BasketScene::relayoutNotes(bool animate)
     placeEditor();
     doHoverEffects();
     invalidate();
+    m_materializeTimer.start();
+}
+
+void BasketScene::updateMaterializedNotes()
+{
+    // The visible area, expanded by one viewport in every direction:
+    QRectF area = m_view->mapToScene(m_view->viewport()->rect()).boundingRect();
+    area.adjust(-area.width(), -area.height(), area.width(), area.height());
+
+    FOR_EACH_NOTE(note)
+    note->updateMaterialization(area);
 }
 
 void BasketScene::popupEmblemMenu(Note *note, int emblemNumber)
@@ -3307,9 +3469,6 @@ void BasketScene::toggledStateInMenu(QAction *action)
         removeTagFromSelectedNotes(m_tagPopup);
         // m_tagPopupNote->removeTag(m_tagPopup);
         // m_tagPopupNote->setWidth(0); // To force a new layout computation
-        updateEditorAppearance();
-        filterAgain();
-        save();
         return;
     }
     if (id == 2) { // Customize this State:
@@ -3328,8 +3487,6 @@ void BasketScene::toggledStateInMenu(QAction *action)
 
     /*addStateToSelectedNotes*/ changeStateOfSelectedNotes(m_tagPopup->states()[id - 10] /*, orReplace=true*/);
     // m_tagPopupNote->addState(m_tagPopup->states()[id - 10], true);
-    filterAgain();
-    save();
 }
 
 State *BasketScene::stateForTagFromSelectedNotes(Tag *tag)
@@ -3352,15 +3509,10 @@ void BasketScene::activatedTagShortcut(Tag *tag)
         state = tag->states().first();
 
     // Set or unset it:
-    if (state) {
-        FOR_EACH_NOTE(note)
-        note->addStateToSelectedNotes(state, /*orReplace=*/true);
-        updateEditorAppearance();
-    } else
+    if (state)
+        addStateToSelectedNotes(state);
+    else
         removeTagFromSelectedNotes(tag);
-
-    filterAgain();
-    save();
 }
 
 void BasketScene::popupTagsMenu(Note *note)
@@ -3390,20 +3542,16 @@ void BasketScene::toggledTagInMenu(QAction *act)
         TagsEditDialog dialog(m_view, /*stateToEdit=*/nullptr, /*addNewTag=*/true);
         dialog.exec();
         if (!dialog.addedStates().isEmpty()) {
-            State::List states = dialog.addedStates();
-            for (State::List::iterator itState = states.begin(); itState != states.end(); ++itState)
-                FOR_EACH_NOTE(note)
-            note->addStateToSelectedNotes(*itState);
-            updateEditorAppearance();
-            filterAgain();
-            save();
+            const State::List states = dialog.addedStates();
+            beginTagChanges();
+            for (State *state : states)
+                addStateToSelectedNotes(state);
+            commitTagChanges();
         }
         return;
     }
     if (id == 2) { // Remove All
         removeAllTagsFromSelectedNotes();
-        filterAgain();
-        save();
         return;
     }
     if (id == 3) { // Customize...
@@ -3416,34 +3564,78 @@ void BasketScene::toggledTagInMenu(QAction *act)
     if (!tag)
         return;
 
+    beginTagChanges();
     if (m_tagPopupNote->hasTag(tag))
         removeTagFromSelectedNotes(tag);
     else
         addTagToSelectedNotes(tag);
     m_tagPopupNote->setWidth(0); // To force a new layout computation
-    filterAgain();
-    save();
+    commitTagChanges();
 }
 
 void BasketScene::addTagToSelectedNotes(Tag *tag)
 {
-    FOR_EACH_NOTE(note)
-    note->addTagToSelectedNotes(tag);
-    updateEditorAppearance();
+    beginTagChanges();
+    for (Note *note : std::as_const(m_selectedNotes))
+        note->addTag(tag);
+    commitTagChanges();
 }
 
 void BasketScene::removeTagFromSelectedNotes(Tag *tag)
 {
-    FOR_EACH_NOTE(note)
-    note->removeTagFromSelectedNotes(tag);
-    updateEditorAppearance();
+    beginTagChanges();
+    for (Note *note : std::as_const(m_selectedNotes)) {
+        if (note->hasTag(tag))
+            note->setWidth(0);
+        note->removeTag(tag);
+    }
+    commitTagChanges();
 }
 
 void BasketScene::addStateToSelectedNotes(State *state)
 {
-    FOR_EACH_NOTE(note)
-    note->addStateToSelectedNotes(state);
+    beginTagChanges();
+    for (Note *note : std::as_const(m_selectedNotes))
+        note->addState(state);
+    commitTagChanges();
+}
+
+void BasketScene::beginTagChanges()
+{
+    ++m_tagChangesDepth;
+}
+
+void BasketScene::noteStatesChanged(Note *note)
+{
+    if (!m_tagChangedNotes.contains(note))
+        m_tagChangedNotes.insert(note, {note->font(), note->textColor()});
+}
+
+void BasketScene::commitTagChanges()
+{
+    Q_ASSERT(m_tagChangesDepth > 0);
+    if (--m_tagChangesDepth > 0)
+        return;
+
+    // The merged styles are cached per combination of states, so restyling is cheap unless the content itself must be refreshed:
+    QRectF changedRect;
+    const QHash<Note *, NoteStyle> changedNotes = std::exchange(m_tagChangedNotes, {});
+    for (auto it = changedNotes.constBegin(); it != changedNotes.constEnd(); ++it) {
+        Note *note = it.key();
+        note->recomputeStyle(/*refreshContent=*/false);
+        if (note->font() != it->font || note->textColor() != it->textColor)
+            note->content()->fontChanged();
+        note->unbufferize();
+        changedRect |= note->sceneBoundingRect();
+    }
+
     updateEditorAppearance();
+    if (changedNotes.isEmpty())
+        return;
+
+    filterAgain();
+    update(changedRect);
+    save();
 }
 
 void BasketScene::updateEditorAppearance()
@@ -3482,23 +3674,29 @@ void BasketScene::editorPropertiesChanged()
 
 void BasketScene::changeStateOfSelectedNotes(State *state)
 {
-    FOR_EACH_NOTE(note)
-    note->changeStateOfSelectedNotes(state);
-    updateEditorAppearance();
+    beginTagChanges();
+    for (Note *note : std::as_const(m_selectedNotes))
+        if (note->hasTag(state->parentTag()))
+            note->addState(state);
+    commitTagChanges();
 }
 
 void BasketScene::removeAllTagsFromSelectedNotes()
 {
-    FOR_EACH_NOTE(note)
-    note->removeAllTagsFromSelectedNotes();
-    updateEditorAppearance();
+    beginTagChanges();
+    for (Note *note : std::as_const(m_selectedNotes)) {
+        if (!note->states().isEmpty())
+            note->setWidth(0);
+        note->removeAllTags();
+    }
+    commitTagChanges();
 }
 
 bool BasketScene::selectedNotesHaveTags()
 {
-    FOR_EACH_NOTE(note)
-    if (note->selectedNotesHaveTags())
-        return true;
+    for (Note *note : std::as_const(m_selectedNotes))
+        if (note->content() && !note->states().isEmpty())
+            return true;
     return false;
 }
 
@@ -3524,6 +3722,22 @@ void BasketScene::unbufferizeAll()
     note->unbufferizeAll();
 }
 
+qint64 BasketScene::bufferedBytes()
+{
+    qint64 bytes = 0;
+    FOR_EACH_NOTE(note)
+    bytes += note->bufferedBytes();
+    return bytes;
+}
+
+qint64 BasketScene::memoryUsage()
+{
+    qint64 bytes = 0;
+    FOR_EACH_NOTE(note)
+    bytes += note->memoryUsage();
+    return bytes;
+}
+
 Note *BasketScene::editedNote()
 {
     if (m_editor)
@@ -3589,7 +3803,8 @@ void BasketScene::contentChangedInEditor()
         m_inactivityAutoSaveTimer.stop();
     m_inactivityAutoSaveTimer.setSingleShot(true);
     m_inactivityAutoSaveTimer.start(3 * 1000);
-    Global::bnpView->setUnsavedStatus(true);
+    if (Global::bnpView)
+        Global::bnpView->setUnsavedStatus(true);
     //  }
 }
 
@@ -3759,8 +3974,16 @@ bool BasketScene::closeEditor(bool deleteEmptyNote /* =true*/)
     return (note != nullptr);
 }
 
+bool BasketScene::canBeReleased()
+{
+    if (m_loadingLaunched && !m_loaded && !m_locked)
+        return false;
+    return !isDuringEdit() && !m_isDuringDrag && !hasPendingCommit();
+}
+
 void BasketScene::closeBasket()
 {
+    m_activationTimer.start();
     closeEditor();
     unbufferizeAll(); // Keep the memory footprint low
     if (isEncrypted()) {
@@ -3774,6 +3997,7 @@ void BasketScene::closeBasket()
 
 void BasketScene::openBasket()
 {
+    m_activationTimer.start();
     if (m_inactivityAutoLockTimer.isActive())
         m_inactivityAutoLockTimer.stop();
 }
@@ -3785,21 +4009,14 @@ Note *BasketScene::theSelectedNote()
         return nullptr;
     }
 
-    Note *selectedOne;
-    FOR_EACH_NOTE(note)
-    {
-        selectedOne = note->theSelectedNote();
-        if (selectedOne)
-            return selectedOne;
-    }
-
-    qDebug() << "One selected note, BUT NOT FOUND !!!!";
-
-    return nullptr;
+    return *m_selectedNotes.constBegin();
 }
 
 NoteSelection *BasketScene::selectedNotes()
 {
+    if (m_selectedNotes.isEmpty())
+        return nullptr;
+
     NoteSelection selection;
 
     FOR_EACH_NOTE(note)
@@ -3865,6 +4082,8 @@ void BasketScene::noteEdit(Note *note, bool justAdded, const QPointF &clickedPoi
         return;
     }
 
+    NoteDrag::noteAboutToChange(note); // Pasting it later gives what was copied, not what was edited
+
     if (note != m_focusedNote) {
         setFocusedNote(note);
         m_startOfShiftSelectionNote = note;
@@ -4533,6 +4752,7 @@ void BasketScene::deleteFiles()
 {
     m_watcher->stopScan();
     Tools::deleteRecursively(fullPath());
+    BasketCache::remove(fullPath());
 }
 
 QList<State *> BasketScene::usedStates()
@@ -4998,22 +5218,48 @@ void BasketScene::ensureNoteVisible(Note *note)
         m_view->ensureVisible(note->x(), note->y(), 0, 0);*/
 }
 
+int BasketScene::s_watchedFolders = 0;
+
+void BasketScene::reportWatcherActivity(const QString &activity)
+{
+    if (Global::debugWindow)
+        Global::debugWindow->setCounter(QStringLiteral("File watcher"), QStringLiteral("%1 folders watched%2").arg(s_watchedFolders).arg(activity));
+}
+
 void BasketScene::addWatchedFile(const QString &fullPath)
 {
     //  DEBUG_WIN << "Watcher>Add Monitoring Of : <font color=blue>" + fullPath + "</font>";
-    m_watcher->addFile(fullPath);
+    // Watching one folder per basket instead of one file per note keeps us far from the inotify watches limit:
+    if (m_watchedFiles.isEmpty()) {
+        m_watcher->addDir(this->fullPath(), KDirWatch::WatchFiles);
+        ++s_watchedFolders;
+        reportWatcherActivity(QString());
+    }
+    m_watchedFiles.insert(fullPath);
 }
 
 void BasketScene::removeWatchedFile(const QString &fullPath)
 {
     //  DEBUG_WIN << "Watcher>Remove Monitoring Of : <font color=blue>" + fullPath + "</font>";
-    m_watcher->removeFile(fullPath);
+    if (!m_watchedFiles.remove(fullPath) || !m_watchedFiles.isEmpty())
+        return;
+    m_watcher->removeDir(this->fullPath());
+    --s_watchedFolders;
+    reportWatcherActivity(QString());
 }
 
 void BasketScene::watchedFileModified(const QString &fullPath)
 {
-    if (!m_modifiedFiles.contains(fullPath))
-        m_modifiedFiles.append(fullPath);
+    // The folder itself, the .basket file and the files of the new notes being saved are not watched notes:
+    if (!m_watchedFiles.contains(fullPath))
+        return;
+
+    if (m_modifiedFiles.isEmpty()) {
+        m_watcherBurstTimer.start();
+        m_watcherBurstEvents = 0;
+    }
+    ++m_watcherBurstEvents;
+    m_modifiedFiles.insert(fullPath);
     // If a big file is saved by an application, notifications are send several times.
     // We wait they are not sent anymore to consider the file complete!
     m_watcherTimer.setSingleShot(true);
@@ -5039,12 +5285,30 @@ void BasketScene::watchedFileDeleted(const QString &fullPath)
 
 void BasketScene::updateModifiedNotes()
 {
-    for (QList<QString>::iterator it = m_modifiedFiles.begin(); it != m_modifiedFiles.end(); ++it) {
-        Note *note = noteForFullPath(*it);
-        if (note)
-            note->content()->loadFromFile(/*lazyLoad=*/false);
+    const QSet<QString> modifiedFiles = std::exchange(m_modifiedFiles, {});
+    if (modifiedFiles.isEmpty())
+        return;
+
+    const qint64 burstMs = qMax<qint64>(1, m_watcherBurstTimer.elapsed());
+    reportWatcherActivity(QStringLiteral(", last burst: %1 events (%2/s) for %3 notes")
+                              .arg(m_watcherBurstEvents)
+                              .arg(m_watcherBurstEvents * 1000 / burstMs)
+                              .arg(modifiedFiles.count()));
+
+    // Find the modified notes in one pass over the basket, instead of one pass per file:
+    QList<Note *> modifiedNotes;
+    for (Note *note = firstNoteInStack(); note && modifiedNotes.count() < modifiedFiles.count(); note = note->nextInStack())
+        if (modifiedFiles.contains(note->fullPath()))
+            modifiedNotes.append(note);
+
+    // Reload them as during the loading of the basket, so the HTML notes are laid out in parallel, by worker threads:
+    QList<HtmlContent *> htmlContents;
+    for (Note *note : std::as_const(modifiedNotes)) {
+        note->content()->loadFromFile(/*lazyLoad=*/true);
+        note->finishLazyLoad(&htmlContents);
     }
-    m_modifiedFiles.clear();
+    if (!htmlContents.isEmpty())
+        HtmlContent::finishLazyLoad(htmlContents);
 }
 
 bool BasketScene::setProtection(int type, QString key)
@@ -5058,6 +5322,7 @@ bool BasketScene::setProtection(int type, QString key)
         m_encryptionType = type;
         m_encryptionKey = key;
         m_gpg->clearCache();
+        BasketCache::remove(fullPath()); // Rebuilt by the next save if the basket is not encrypted anymore
 
         if (saveAgain()) {
             Q_EMIT propertiesChanged(this);
@@ -7,7 +7,9 @@
 #define BASKET_H
 
 #include <QClipboard>
+#include <QElapsedTimer>
 #include <QGraphicsScene>
+#include <QHash>
 #include <QList>
 #include <QSet>
 #include <QTextCursor>
@@ -15,6 +17,8 @@
 #include <QXmlStreamWriter>
 
 #include "animation.h"
+#include "basket_export.h"
+#include "basketcache.h"
 #include "config.h"
 #include "note.h" // For Note::Zone
 
@@ -50,7 +54,7 @@ class KGpgMe;
 /**
  * @author Sébastien Laoût
  */
-class BasketScene : public QGraphicsScene
+class BASKET_EXPORT BasketScene : public QGraphicsScene
 {
     Q_OBJECT
 public:
@@ -109,8 +113,10 @@ public:
 public:
     void disableAnimation();
     void enableAnimation();
-    void addAnimation(NoteAnimation *animation);
-    void removeAnimation(NoteAnimation *animation);
+    BasketAnimations *animations()
+    {
+        return m_animations;
+    }
     bool isAnimated();
     void unsetNotesWidth();
     void relayoutNotes(bool animate = false);
@@ -224,9 +230,11 @@ private:
     QTimer m_inactivityAutoLockTimer;
     QTimer m_commitdelay;
     void enableActions();
+    void loadNotes(const QList<BasketCache::Note> &notes, Note *parent);
+    bool loadBasketFile(QString *content); ///< Load [and decrypt] the .basket file
+    bool saveBasketFile(const QString &content); ///< [Encrypt and] save the .basket file
 
 private Q_SLOTS:
-    void loadNotes(const QDomElement &notes, Note *parent);
     void saveNotes(QXmlStreamWriter &stream, Note *parent);
     void unlock();
 protected Q_SLOTS:
@@ -238,6 +246,7 @@ public Q_SLOTS:
     bool save();
     void commitEdit();
     void reload();
+    void unload(); ///< Free the notes and stop watching their files. The basket is loaded again the next time it is shown
 
 public:
     bool isEncrypted();
@@ -255,6 +264,40 @@ public:
     {
         return m_loadingLaunched;
     };
+    bool hasPendingCommit() const
+    {
+        return m_commitdelay.isActive();
+    }
+    qint64 bufferedBytes(); ///< Memory used by the pixmaps the notes are drawn in
+    qint64 memoryUsage(); ///< Approximate memory used by the notes, their contents and their pixmaps
+    QHash<QString, BasketCache::HtmlSummary> htmlSummaries(); ///< What the basket cache keeps of the HTML notes, by file name
+    /// Milliseconds since the basket was last shown or hidden (or created, if it never was)
+    qint64 idleTime() const
+    {
+        return m_activationTimer.elapsed();
+    }
+    /// True if the basket can be deleted and created again later without losing anything:
+    /// it is not being loaded, edited or dragged, and has no commit waiting
+    bool canBeReleased();
+
+    /// Durations of the last loads, saves and filterings, in microseconds (-1 if it never happened), for the metrics
+    struct Timings {
+        qint64 lastLoadUs = -1;
+        qint64 lastSaveUs = -1;
+        qint64 lastFilterUs = -1;
+        qint64 maxFilterUs = -1;
+        int filters = 0;
+    };
+    const Timings &timings() const
+    {
+        return m_timings;
+    }
+
+private:
+    Timings m_timings;
+    QElapsedTimer m_activationTimer;
+
+public:
     int encryptionType()
     {
         return m_encryptionType;
@@ -382,6 +425,25 @@ public:
     void drawInserter(QPainter &painter, qreal xPainter, qreal yPainter);
     DecoratedBasket *decoration();
     State *stateForTagFromSelectedNotes(Tag *tag);
+
+    /// Start a batch of tag changes: notes whose states change are restyled only once, by commitTagChanges(). Batches can be nested
+    void beginTagChanges();
+    /// End a batch of tag changes: restyle the modified notes, then relayout, repaint and save the basket, once
+    void commitTagChanges();
+    bool isChangingTags() const
+    {
+        return m_tagChangesDepth > 0;
+    }
+    void noteStatesChanged(Note *note); /// << Called by Note while isChangingTags()
+
+private:
+    struct NoteStyle {
+        QFont font;
+        QColor textColor;
+    };
+    int m_tagChangesDepth;
+    QHash<Note *, NoteStyle> m_tagChangedNotes; ///< Notes modified during the current batch, with their style before the first change
+
 public Q_SLOTS:
     void activatedTagShortcut(Tag *tag);
     void recomputeAllStyles();
@@ -406,6 +468,7 @@ private:
     QPointF m_selectionBeginPoint;
     QPointF m_selectionEndPoint;
     QRectF m_selectionRect;
+    QRectF m_lastSelectedInRect; // The rectangle of the previous selectNotesIn() call: its notes may need to be unselected
     QTimer m_autoScrollSelectionTimer;
     void stopAutoScrollSelection();
 private Q_SLOTS:
@@ -455,19 +518,19 @@ private Q_SLOTS:
 
     /// NOTES COUNTING:
 public:
-    void addSelectedNote()
+    void addSelectedNote(Note *note)
     {
-        ++m_countSelecteds;
+        m_selectedNotes.insert(note);
         signalCountsChanged();
     }
-    void removeSelectedNote()
+    void removeSelectedNote(Note *note)
     {
-        --m_countSelecteds;
+        m_selectedNotes.remove(note);
         signalCountsChanged();
     }
     void resetSelectedNote()
     {
-        m_countSelecteds = 0;
+        m_selectedNotes.clear();
         signalCountsChanged();
     } // FIXME: Useful ???
     int count()
@@ -480,13 +543,13 @@ public:
     }
     int countSelecteds()
     {
-        return m_countSelecteds;
+        return m_selectedNotes.count();
     }
 
 private:
     int m_count;
     int m_countFounds;
-    int m_countSelecteds;
+    QSet<Note *> m_selectedNotes; // Maintained by Note::setSelected(), so the selection is known without walking the notes
 
     /// PROPERTIES:
 public:
@@ -683,16 +746,37 @@ public:
 private:
     KDirWatch *m_watcher;
     QTimer m_watcherTimer;
-    QList<QString> m_modifiedFiles;
+    QSet<QString> m_watchedFiles; ///< The folder of the basket is watched once: events on other files are ignored
+    QSet<QString> m_modifiedFiles;
+    QElapsedTimer m_watcherBurstTimer; ///< Started by the first event of a burst of modifications
+    int m_watcherBurstEvents;
+    static int s_watchedFolders;
+    static void reportWatcherActivity(const QString &activity);
 
 public:
     void addWatchedFile(const QString &fullPath);
     void removeWatchedFile(const QString &fullPath);
+    int watchedFilesCount() const
+    {
+        return m_watchedFiles.count();
+    }
+    static int watchedFoldersCount()
+    {
+        return s_watchedFolders;
+    }
 private Q_SLOTS:
     void watchedFileModified(const QString &fullPath);
     void watchedFileDeleted(const QString &fullPath);
     void updateModifiedNotes();
 
+    /// VIRTUALISATION:
+private:
+    QTimer m_materializeTimer;
+private Q_SLOTS:
+    /** Only keep in the scene the content items of the notes that are in or near the viewport.
+     * For big baskets, it keeps the scene index small and cheap to update while scrolling. */
+    void updateMaterializedNotes();
+
     /// FROM OLD ARCHITECTURE **********************
 
 public Q_SLOTS:
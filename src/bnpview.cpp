@@ -9,8 +9,12 @@
 #include <QAction>
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QDBusConnection>
+#include <QDBusMessage>
 #include <QDir>
 #include <QEvent>
+#include <QFile>
+#include <QFutureWatcher>
 #include <QGraphicsView>
 #include <QHideEvent>
 #include <QImage>
@@ -18,14 +22,19 @@
 #include <QList>
 #include <QMenu>
 #include <QPixmap>
+#include <QPointer>
 #include <QProgressDialog>
 #include <QRegularExpression>
 #include <QResizeEvent>
 #include <QShowEvent>
 #include <QStackedWidget>
+#include <QTimer>
 #include <QUndoStack>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtXml/QDomDocument>
 
+#include <algorithm>
+
 #include <KAboutData>
 #include <KActionCollection>
 #include <KActionMenu>
@@ -47,6 +56,7 @@
 #include "archive.h"
 #include "backgroundmanager.h"
 #include "backup.h"
+#include "basketcache.h"
 #include "basketfactory.h"
 #include "basketlistview.h"
 #include "basketproperties.h"
@@ -68,6 +78,7 @@
 #include "regiongrabber.h"
 #include "settings.h"
 #include "softwareimporters.h"
+#include "titlefetcher.h"
 #include "tools.h"
 #include "xmlwork.h"
 
@@ -76,7 +87,7 @@
 #include <QStandardPaths>
 #include <qdbusconnection.h>
 
-// #include "bnpviewadaptor.h"
+#include "bnpviewadaptor.h"
 
 using namespace std::chrono_literals;
 
@@ -89,6 +100,7 @@ BNPView::BNPView(QWidget *parent, const char *name, KXMLGUIClient *aGUIClient, K
     , m_actLockBasket(nullptr)
     , m_actPassBasket(nullptr)
     , m_loading(true)
+    , m_releaseIdleBasketsTimer(nullptr)
     , m_newBasketPopup(false)
     , m_firstShow(true)
 #ifndef _WIN32
@@ -100,7 +112,8 @@ BNPView::BNPView(QWidget *parent, const char *name, KXMLGUIClient *aGUIClient, K
     , m_guiClient(aGUIClient)
     , m_statusbar(bar)
 {
-    // new BNPViewAdaptor(this);
+    NoteIngestion::registerMetaTypes();
+    new BNPViewAdaptor(this);
     QDBusConnection dbus = QDBusConnection::sessionBus();
     dbus.registerObject(QStringLiteral("/BNPView"), this);
 
@@ -118,6 +131,11 @@ BNPView::BNPView(QWidget *parent, const char *name, KXMLGUIClient *aGUIClient, K
     m_history = new QUndoStack(this);
     initialize();
     QTimer::singleShot(0, this, &BNPView::lateInit);
+
+    m_releaseIdleBasketsTimer = new QTimer(this);
+    connect(m_releaseIdleBasketsTimer, &QTimer::timeout, this, &BNPView::releaseIdleBaskets);
+    connect(m_releaseIdleBasketsTimer, &QTimer::timeout, this, &BNPView::unloadBasketsOverBudget);
+    m_releaseIdleBasketsTimer->start(60 * 1000);
 }
 
 BNPView::~BNPView()
@@ -138,6 +156,7 @@ BNPView::~BNPView()
     m_history = nullptr;
 
     NoteDrag::createAndEmptyCuttingTmpFolder(); // Clean the temporary folder we used
+    BasketCache::waitForRebuilds(); // Do not quit in the middle of writing a cache
 }
 
 void BNPView::lateInit()
@@ -148,6 +167,8 @@ void BNPView::lateInit()
 
     // Load baskets
     DEBUG_WIN << QStringLiteral("Baskets are loaded from ") + Global::basketsFolder();
+    // Like the basket caches, the titles of links are not versioned, backed up nor archived with the saves folder:
+    TitleFetcher::createInstance(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/linktitles.xml"));
 
     NoteDrag::createAndEmptyCuttingTmpFolder(); // If last exec hasn't done it: clean the temporary folder we will use
     Tag::loadTags(); // Tags should be ready before loading baskets, but tags need the mainContainer to be ready to create KActions!
@@ -847,17 +868,21 @@ void BNPView::save(QTreeWidget *listView, QTreeWidgetItem *item, QXmlStreamWrite
 
 void BNPView::writeBasketElement(QTreeWidgetItem *item, QXmlStreamWriter &stream)
 {
-    BasketScene *basket = ((BasketListViewItem *)item)->basket();
+    auto *basketItem = (BasketListViewItem *)item;
 
     // Save Attributes:
-    stream.writeAttribute("folderName", basket->folderName());
+    stream.writeAttribute("folderName", basketItem->folderName());
     if (item->childCount() >= 0) // If it can be expanded/folded:
         stream.writeAttribute("folded", XMLWork::trueOrFalse(!item->isExpanded()));
 
-    if (((BasketListViewItem *)item)->isCurrentBasket())
+    if (basketItem->isCurrentBasket())
         stream.writeAttribute("lastOpened", "true");
 
-    basket->saveProperties(stream);
+    // Baskets not created yet keep the properties they were loaded with:
+    if (basketItem->isBasketCreated())
+        basketItem->basketIfCreated()->saveProperties(stream);
+    else if (!basketItem->properties().isNull())
+        XMLWork::writeElement(stream, basketItem->properties());
 }
 
 void BNPView::saveSubHierarchy(QTreeWidgetItem *item, QXmlStreamWriter &stream, bool recursive)
@@ -883,6 +908,9 @@ void BNPView::load()
         QDomElement docElem = doc->documentElement();
         load(nullptr, docElem);
     }
+    // No basket was marked as the last opened one: show the first one
+    if (!m_tree->currentItem() && topLevelItemCount() > 0)
+        setCurrentBasket(topLevelItem(0)->basket());
     m_loading = false;
 }
 
@@ -894,14 +922,16 @@ void BNPView::load(QTreeWidgetItem *item, const QDomElement &baskets)
         if ((!element.isNull()) && element.tagName() == QStringLiteral("basket")) {
             QString folderName = element.attribute(QStringLiteral("folderName"));
             if (!folderName.isEmpty()) {
-                BasketScene *basket = loadBasket(folderName);
-                BasketListViewItem *basketItem = appendBasket(basket, item);
+                // Only the item is created: the basket is created the first time it is shown or searched
+                BasketListViewItem *basketItem = appendBasket(folderName, XMLWork::getElement(element, QStringLiteral("properties")), item);
                 basketItem->setExpanded(!XMLWork::trueOrFalse(element.attribute(QStringLiteral("folded"), QStringLiteral("false")), false));
-                basket->loadProperties(XMLWork::getElement(element, QStringLiteral("properties")));
+                // ...but the keyboard shortcut of a basket only works once its action is created:
+                if (!basketItem->basketShortcut().isEmpty())
+                    basketItem->basket();
                 if (XMLWork::trueOrFalse(
                         element.attribute(QStringLiteral("lastOpened"), element.attribute(QStringLiteral("lastOpened"), QStringLiteral("false"))),
                         false)) // Compat with 0.6.0-Alphas
-                    setCurrentBasket(basket);
+                    setCurrentBasket(basketItem->basket());
                 // Load Sub-baskets:
                 load(basketItem, element);
             }
@@ -972,6 +1002,119 @@ BasketListViewItem *BNPView::appendBasket(BasketScene *basket, QTreeWidgetItem *
     return newBasketItem;
 }
 
+BasketListViewItem *BNPView::appendBasket(const QString &folderName, const QDomElement &properties, QTreeWidgetItem *parentItem)
+{
+    BasketListViewItem *newBasketItem;
+    if (parentItem)
+        newBasketItem = new BasketListViewItem(parentItem, parentItem->child(parentItem->childCount() - 1), folderName, properties);
+    else
+        newBasketItem = new BasketListViewItem(m_tree, m_tree->topLevelItem(m_tree->topLevelItemCount() - 1), folderName, properties);
+    newBasketItem->setup();
+
+    return newBasketItem;
+}
+
+void BNPView::createBasket(BasketListViewItem *item)
+{
+    // The properties come from baskets.xml: do not save it again
+    const bool wasLoading = m_loading;
+    m_loading = true;
+    BasketScene *basket = loadBasket(item->folderName());
+    item->setBasket(basket); // Before loadProperties(), so updateBasketListViewItem() finds the item
+    basket->loadProperties(item->properties());
+    m_loading = wasLoading;
+
+    BasketScene *current = currentBasket();
+    if (isFilteringAllBaskets() && current && current != basket)
+        basket->decoration()->filterBar()->setFilterData(current->decoration()->filterBar()->filterData());
+}
+
+void BNPView::releaseBasket(BasketListViewItem *item)
+{
+    BasketScene *basket = item->basketIfCreated();
+
+    // Keep the properties as they would be saved in baskets.xml:
+    QString properties;
+    QXmlStreamWriter stream(&properties);
+    basket->saveProperties(stream);
+    QDomDocument document;
+    document.setContent(properties);
+    item->releaseBasket(document.documentElement());
+
+    DecoratedBasket *decoBasket = basket->decoration();
+    basket->unsubscribeBackgroundImages();
+    m_stack->removeWidget(decoBasket);
+    delete basket->m_action; // Like in doBasketDeletion()
+    delete decoBasket;
+}
+
+void BNPView::releaseIdleBaskets()
+{
+    // The baskets are all needed to show the results of a search in all baskets:
+    if (!Settings::releaseIdleBaskets() || isFilteringAllBaskets())
+        return;
+
+    const qint64 maxIdleTime = Settings::releaseIdleBasketsMinutes() * 60 * 1000LL;
+    BasketScene *current = currentBasket();
+    int released = 0;
+    QTreeWidgetItemIterator it(m_tree);
+    while (*it) {
+        auto *item = (BasketListViewItem *)(*it);
+        BasketScene *basket = item->basketIfCreated();
+        // Baskets with a keyboard shortcut are kept, for the shortcut to keep working:
+        if (basket && basket != current && basket->idleTime() > maxIdleTime && basket->shortcut().isEmpty() && basket->canBeReleased()) {
+            releaseBasket(item);
+            ++released;
+        }
+        ++it;
+    }
+
+    if (released > 0)
+        DEBUG_WIN << QStringLiteral("Released %1 idle basket(s)").arg(released);
+}
+
+void BNPView::unloadBasketsOverBudget()
+{
+    if (Settings::basketsMemoryBudget() <= 0 || isFilteringAllBaskets())
+        return;
+
+    const qint64 budget = Settings::basketsMemoryBudget() * 1024LL * 1024LL;
+    BasketScene *current = currentBasket();
+    qint64 total = 0;
+    QList<QPair<BasketScene *, qint64>> candidates;
+    QTreeWidgetItemIterator it(m_tree);
+    while (*it) {
+        BasketScene *basket = ((BasketListViewItem *)(*it))->basketIfCreated();
+        if (basket && basket->loadingLaunched() && !basket->isLocked()) {
+            const qint64 usage = basket->memoryUsage();
+            total += usage;
+            if (basket != current)
+                candidates.append({basket, usage});
+        }
+        ++it;
+    }
+    if (total <= budget)
+        return;
+
+    // Least recently shown first:
+    std::sort(candidates.begin(), candidates.end(), [](const QPair<BasketScene *, qint64> &a, const QPair<BasketScene *, qint64> &b) {
+        return a.first->idleTime() > b.first->idleTime();
+    });
+    int unloaded = 0;
+    for (const auto &candidate : std::as_const(candidates)) {
+        if (total <= budget)
+            break;
+        if (!candidate.first->canBeReleased())
+            continue;
+        candidate.first->unload();
+        total -= candidate.second;
+        ++unloaded;
+    }
+
+    if (unloaded > 0)
+        DEBUG_WIN << QStringLiteral("Unloaded %1 basket(s) to fit in %2 MiB").arg(unloaded).arg(Settings::basketsMemoryBudget());
+}
+
 void BNPView::loadNewBasket(const QString &folderName, const QDomElement &properties, BasketScene *parent)
 {
     BasketScene *basket = loadBasket(folderName);
@@ -1019,7 +1162,8 @@ void BNPView::closeAllEditors()
     QTreeWidgetItemIterator it(m_tree);
     while (*it) {
         auto *item = (BasketListViewItem *)(*it);
-        item->basket()->closeEditor();
+        if (item->basketIfCreated())
+            item->basketIfCreated()->closeEditor();
         ++it;
     }
 }
@@ -1087,13 +1231,14 @@ void BNPView::newFilter()
     const FilterData &filterData = current->decoration()->filterBar()->filterData();
 
     // Set the filter data for every other baskets, or reset the filter for every other baskets if we just disabled the filterInAllBaskets:
+    // (baskets are created to be searched, but there is no filter to reset in the baskets not created yet)
     QTreeWidgetItemIterator it(m_tree);
     while (*it) {
         BasketListViewItem *item = ((BasketListViewItem *)*it);
-        if (item->basket() != current) {
+        if (item->basketIfCreated() != current) {
             if (isFilteringAllBaskets())
                 item->basket()->decoration()->filterBar()->setFilterData(filterData); // Set the new FilterData for every other baskets
-            else
+            else if (item->isBasketCreated())
                 item->basket()->decoration()->filterBar()->setFilterData(FilterData()); // We just disabled the global filtering: remove the FilterData
         }
         ++it;
@@ -1109,7 +1254,7 @@ void BNPView::newFilter()
         QTreeWidgetItemIterator it(m_tree);
         while (*it) {
             BasketListViewItem *item = ((BasketListViewItem *)*it);
-            if (item->basket() != current) {
+            if (item->basketIfCreated() != current) {
                 BasketScene *basket = item->basket();
                 if (!basket->loadingLaunched() && !basket->isLocked())
                     basket->load();
@@ -1146,10 +1291,29 @@ bool BNPView::isFilteringAllBaskets()
 
 BasketListViewItem *BNPView::listViewItemForBasket(BasketScene *basket)
 {
+    if (!basket)
+        return nullptr;
+
+    QTreeWidgetItemIterator it(m_tree);
+    while (*it) {
+        BasketListViewItem *item = ((BasketListViewItem *)*it);
+        if (item->basketIfCreated() == basket)
+            return item;
+        ++it;
+    }
+    return nullptr;
+}
+
+BasketListViewItem *BNPView::listViewItemForFolderName(const QString &folderName)
+{
+    QString name = folderName;
+    if (!name.endsWith(QLatin1Char('/')))
+        name += QLatin1Char('/');
+
     QTreeWidgetItemIterator it(m_tree);
     while (*it) {
         BasketListViewItem *item = ((BasketListViewItem *)*it);
-        if (item->basket() == basket)
+        if (item->folderName() == name)
             return item;
         ++it;
     }
@@ -1214,6 +1378,9 @@ void BNPView::setCurrentBasket(BasketScene *basket)
     }
     m_tree->viewport()->update();
     Q_EMIT basketChanged();
+
+    // The basket that was current may now be unloaded. Not now: the caller may still use it
+    QTimer::singleShot(0, this, &BNPView::unloadBasketsOverBudget);
 }
 
 void BNPView::removeBasket(BasketScene *basket)
@@ -1264,9 +1431,11 @@ void BNPView::relayoutAllBaskets()
     QTreeWidgetItemIterator it(m_tree);
     while (*it) {
         BasketListViewItem *item = ((BasketListViewItem *)*it);
-        // item->basket()->unbufferizeAll();
-        item->basket()->unsetNotesWidth();
-        item->basket()->relayoutNotes();
+        if (item->isBasketCreated()) {
+            // item->basket()->unbufferizeAll();
+            item->basket()->unsetNotesWidth();
+            item->basket()->relayoutNotes();
+        }
         ++it;
     }
 }
@@ -1276,9 +1445,11 @@ void BNPView::recomputeAllStyles()
     QTreeWidgetItemIterator it(m_tree);
     while (*it) {
         BasketListViewItem *item = ((BasketListViewItem *)*it);
-        item->basket()->recomputeAllStyles();
-        item->basket()->unsetNotesWidth();
-        item->basket()->relayoutNotes();
+        if (item->isBasketCreated()) {
+            item->basket()->recomputeAllStyles();
+            item->basket()->unsetNotesWidth();
+            item->basket()->relayoutNotes();
+        }
         ++it;
     }
 }
@@ -1288,7 +1459,8 @@ void BNPView::removedStates(const QList<State *> &deletedStates)
     QTreeWidgetItemIterator it(m_tree);
     while (*it) {
         BasketListViewItem *item = ((BasketListViewItem *)*it);
-        item->basket()->removedStates(deletedStates);
+        if (item->isBasketCreated())
+            item->basket()->removedStates(deletedStates);
         ++it;
     }
 }
@@ -1298,7 +1470,8 @@ void BNPView::linkLookChanged()
     QTreeWidgetItemIterator it(m_tree);
     while (*it) {
         BasketListViewItem *item = ((BasketListViewItem *)*it);
-        item->basket()->linkLookChanged();
+        if (item->isBasketCreated())
+            item->basket()->linkLookChanged();
         ++it;
     }
 }
@@ -1308,8 +1481,10 @@ void BNPView::filterPlacementChanged(bool onTop)
     QTreeWidgetItemIterator it(m_tree);
     while (*it) {
         auto *item = static_cast<BasketListViewItem *>(*it);
-        auto *decoration = static_cast<DecoratedBasket *>(item->basket()->parent());
-        decoration->setFilterBarPosition(onTop);
+        if (item->isBasketCreated()) {
+            auto *decoration = static_cast<DecoratedBasket *>(item->basket()->parent());
+            decoration->setFilterBarPosition(onTop);
+        }
         ++it;
     }
 }
@@ -1889,19 +2064,8 @@ BasketScene *BNPView::basketForFolderName(const QString &folderName)
         return basket;
     */
 
-    QString name = folderName;
-    if (!name.endsWith(QLatin1Char('/')))
-        name += QLatin1Char('/');
-
-    QTreeWidgetItemIterator it(m_tree);
-    while (*it) {
-        BasketListViewItem *item = ((BasketListViewItem *)*it);
-        if (item->basket()->folderName() == name)
-            return item->basket();
-        ++it;
-    }
-
-    return nullptr;
+    BasketListViewItem *item = listViewItemForFolderName(folderName);
+    return (item ? item->basket() : nullptr);
 }
 
 Note *BNPView::noteForFileName(const QString &fileName, BasketScene &basket, Note *note)
@@ -2332,6 +2496,119 @@ bool BNPView::createNoteFromFile(const QString url, const QString basket)
     return true;
 }
 
+BasketScene *BNPView::loadedBasketForFolderName(const QString &folderName)
+{
+    BasketScene *basket = basketForFolderName(folderName);
+    if (basket && !basket->isLoaded()) {
+        basket->load();
+        basket->aboutToBeActivated(); // Baskets that are not shown are loaded lazily
+    }
+    return (basket && basket->isLoaded() ? basket : nullptr);
+}
+
+QStringList BNPView::insertCreatedNotes(BasketScene *basket, const QList<Note *> &notes)
+{
+    QStringList fileNames;
+    fileNames.reserve(notes.size());
+    Note *first = nullptr;
+    Note *last = nullptr;
+    for (Note *note : notes) {
+        fileNames.append(note ? note->content()->fileName() : QString());
+        if (!note)
+            continue;
+        // Chain the notes, to insert them at once:
+        if (last) {
+            last->setNext(note);
+            note->setPrev(last);
+        } else {
+            first = note;
+        }
+        last = note;
+    }
+
+    if (first)
+        basket->insertCreatedNote(first); // Relayout and save once
+    return fileNames;
+}
+
+QStringList BNPView::createNotes(const QString &basket, const QList<NoteToCreate> &notes)
+{
+    BasketScene *b = loadedBasketForFolderName(basket);
+    if (!b)
+        return QStringList();
+
+    QList<Note *> created;
+    created.reserve(notes.size());
+    for (const NoteToCreate &wanted : notes) {
+        Note *note = NoteIngestion::createNote(wanted, b);
+        if (note)
+            NoteIngestion::addTags(note, wanted.tags);
+        created.append(note);
+    }
+    return insertCreatedNotes(b, created);
+}
+
+QStringList BNPView::insertNotesFromFds(BasketScene *basket,
+                                        const QList<NoteToCreateFromFd> &notes,
+                                        const QStringList &fileNames,
+                                        const QList<NoteIngestion::Content> &contents)
+{
+    QList<Note *> created;
+    created.reserve(notes.size());
+    for (int i = 0; i < notes.size(); ++i) {
+        Note *note = NoteIngestion::createNote(notes[i], fileNames[i], contents[i], basket);
+        if (note)
+            NoteIngestion::addTags(note, notes[i].tags);
+        created.append(note);
+    }
+    return insertCreatedNotes(basket, created);
+}
+
+QStringList BNPView::createNotesFromFds(const QString &basket, const QList<NoteToCreateFromFd> &notes)
+{
+    BasketScene *b = loadedBasketForFolderName(basket);
+    if (!b)
+        return QStringList();
+
+    QStringList fileNames;
+    fileNames.reserve(notes.size());
+    for (const NoteToCreateFromFd &wanted : notes)
+        fileNames.append(NoteIngestion::reserveFile(wanted, b));
+
+    const QString folder = b->fullPath();
+    auto readContents = [notes, fileNames, folder]() {
+        QList<NoteIngestion::Content> contents;
+        contents.reserve(notes.size());
+        for (int i = 0; i < notes.size(); ++i)
+            contents.append(NoteIngestion::readContent(notes[i], fileNames[i].isEmpty() ? QString() : folder + fileNames[i]));
+        return contents;
+    };
+    if (!calledFromDBus())
+        return insertNotesFromFds(b, notes, fileNames, readContents());
+
+    // The senders may write slowly, or not at all: do not freeze the application while waiting for them
+    setDelayedReply(true);
+    const QDBusMessage request = message();
+    QDBusConnection bus = connection();
+    QPointer<BasketScene> target(b);
+    auto *watcher = new QFutureWatcher<QList<NoteIngestion::Content>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [watcher, request, bus, target, notes, fileNames, folder]() {
+        watcher->deleteLater();
+        QStringList created;
+        if (target) {
+            created = insertNotesFromFds(target, notes, fileNames, watcher->result());
+        } else { // The basket was closed in the meantime
+            for (const QString &fileName : fileNames) {
+                if (!fileName.isEmpty())
+                    QFile::remove(folder + fileName);
+            }
+        }
+        bus.send(request.createReply(created));
+    });
+    watcher->setFuture(QtConcurrent::run(readContents));
+    return QStringList(); // Not sent: the reply is delayed
+}
+
 QStringList BNPView::listBaskets()
 {
     QStringList basketList;
@@ -2339,13 +2616,100 @@ QStringList BNPView::listBaskets()
     QTreeWidgetItemIterator it(m_tree);
     while (*it) {
         BasketListViewItem *item = ((BasketListViewItem *)*it);
-        basketList.append(item->basket()->basketName());
-        basketList.append(item->basket()->folderName());
+        basketList.append(item->basketName());
+        basketList.append(item->folderName());
         ++it;
     }
     return basketList;
 }
 
+QVariantMap BNPView::metricsOf(BasketScene *basket)
+{
+    const BasketScene::Timings &timings = basket->timings();
+    return {
+        {QStringLiteral("name"), basket->basketName()},
+        {QStringLiteral("created"), true},
+        {QStringLiteral("notes"), basket->count()},
+        {QStringLiteral("foundNotes"), basket->countFounds()},
+        {QStringLiteral("selectedNotes"), basket->countSelecteds()},
+        {QStringLiteral("loaded"), basket->isLoaded()},
+        {QStringLiteral("locked"), basket->isLocked()},
+        {QStringLiteral("lastLoadUs"), timings.lastLoadUs},
+        {QStringLiteral("lastSaveUs"), timings.lastSaveUs},
+        {QStringLiteral("lastFilterUs"), timings.lastFilterUs},
+        {QStringLiteral("maxFilterUs"), timings.maxFilterUs},
+        {QStringLiteral("filters"), timings.filters},
+        {QStringLiteral("bufferedBytes"), basket->bufferedBytes()},
+        {QStringLiteral("memoryBytes"), basket->memoryUsage()},
+        {QStringLiteral("pendingCommit"), Settings::versionSyncEnabled() && basket->hasPendingCommit()},
+        {QStringLiteral("watchedFiles"), basket->watchedFilesCount()},
+    };
+}
+
+QVariantMap BNPView::basketMetrics(const QString &folderName)
+{
+    // Metrics must not create the basket:
+    BasketListViewItem *item = listViewItemForFolderName(folderName);
+    if (!item)
+        return {};
+    if (!item->isBasketCreated())
+        return {{QStringLiteral("name"), item->basketName()}, {QStringLiteral("created"), false}};
+    return metricsOf(item->basketIfCreated());
+}
+
+QVariantMap BNPView::metrics()
+{
+    QVariantMap perBasket;
+    int baskets = 0;
+    int createdBaskets = 0;
+    int loadedBaskets = 0;
+    int notes = 0;
+    qint64 bufferedBytes = 0;
+    int pendingCommits = 0;
+    int watchedFiles = 0;
+    int filters = 0;
+    qint64 maxFilterUs = -1;
+
+    QTreeWidgetItemIterator it(m_tree);
+    while (*it) {
+        auto *item = (BasketListViewItem *)*it;
+        ++baskets;
+        ++it;
+        if (!item->isBasketCreated()) {
+            perBasket.insert(item->folderName(), QVariantMap{{QStringLiteral("name"), item->basketName()}, {QStringLiteral("created"), false}});
+            continue;
+        }
+
+        BasketScene *basket = item->basketIfCreated();
+        const QVariantMap basketMetrics = metricsOf(basket);
+        perBasket.insert(basket->folderName(), basketMetrics);
+
+        ++createdBaskets;
+        loadedBaskets += (basket->isLoaded() ? 1 : 0);
+        notes += basket->count();
+        bufferedBytes += basketMetrics.value(QStringLiteral("bufferedBytes")).toLongLong();
+        pendingCommits += (basketMetrics.value(QStringLiteral("pendingCommit")).toBool() ? 1 : 0);
+        watchedFiles += basket->watchedFilesCount();
+        filters += basket->timings().filters;
+        maxFilterUs = qMax(maxFilterUs, basket->timings().maxFilterUs);
+    }
+
+    return {
+        {QStringLiteral("baskets"), baskets},
+        {QStringLiteral("createdBaskets"), createdBaskets},
+        {QStringLiteral("loadedBaskets"), loadedBaskets},
+        {QStringLiteral("notes"), notes},
+        {QStringLiteral("bufferedBytes"), bufferedBytes},
+        {QStringLiteral("backgroundCacheBytes"), Global::backgroundManager ? Global::backgroundManager->memoryUsage() : qint64(0)},
+        {QStringLiteral("pendingCommits"), pendingCommits},
+        {QStringLiteral("watchedFolders"), BasketScene::watchedFoldersCount()},
+        {QStringLiteral("watchedFiles"), watchedFiles},
+        {QStringLiteral("filters"), filters},
+        {QStringLiteral("maxFilterUs"), maxFilterUs},
+        {QStringLiteral("perBasket"), perBasket},
+    };
+}
+
 void BNPView::handleCommandLine()
 {
     QCommandLineParser *parser = Global::commandLineOpts;
@@ -2577,7 +2941,7 @@ QString BNPView::folderFromBasketNameLink(QStringList pages, QTreeWidgetItem *pa
                 if (pages.count() > 0) {
                     return this->folderFromBasketNameLink(pages, child);
                 } else {
-                    return ((BasketListViewItem *)child)->basket()->folderName();
+                    return ((BasketListViewItem *)child)->folderName();
                 }
             }
         }
@@ -6,7 +6,9 @@
 #ifndef BNPVIEW_H
 #define BNPVIEW_H
 
+#include <QDBusContext>
 #include <QSplitter>
+#include <QVariantMap>
 #include <QXmlStreamWriter>
 #include <QtCore/QList>
 #include <QtGui/QClipboard>
@@ -15,11 +17,13 @@
 
 #include "basket_export.h"
 #include "global.h"
+#include "noteingestion.h"
 #include <memory>
 
 class QDomElement;
 
 class QStackedWidget;
+class QTimer;
 class QPixmap;
 class QTreeWidget;
 class QTreeWidgetItem;
@@ -45,7 +49,7 @@ class State;
 class Note;
 class KMainWindow;
 
-class BASKET_EXPORT BNPView : public QSplitter
+class BASKET_EXPORT BNPView : public QSplitter, protected QDBusContext
 {
     Q_OBJECT
     Q_CLASSINFO("D Bus Interface", "org.kde.basket.dbus")
@@ -63,6 +67,8 @@ public:
     void filterPlacementChanged(bool onTop);
     /// MANAGE BASKETS:
     BasketListViewItem *listViewItemForBasket(BasketScene *basket);
+    /// Find the item of a basket without creating the basket
+    BasketListViewItem *listViewItemForFolderName(const QString &folderName);
     BasketScene *currentBasket();
     BasketScene *parentBasketOf(BasketScene *basket);
     void setCurrentBasket(BasketScene *basket);
@@ -275,6 +281,7 @@ private:
 public:
     BasketScene *loadBasket(const QString &folderName); // Public only for class Archive
     BasketListViewItem *appendBasket(BasketScene *basket, QTreeWidgetItem *parentItem); // Public only for class Archive
+    void createBasket(BasketListViewItem *item); // Public only for class BasketListViewItem
 
     BasketScene *basketForFolderName(const QString &folderName);
     Note *noteForFileName(const QString &fileName, BasketScene &basket, Note *note = nullptr);
@@ -291,6 +298,18 @@ public Q_SLOTS:
     Q_SCRIPTABLE QStringList listBaskets();
     Q_SCRIPTABLE bool createNoteFromFile(const QString url, const QString basket);
     Q_SCRIPTABLE bool changeNoteHtml(const QString content, const QString basket, const QString noteName);
+    /** Create all @p notes at the end of @p basket with a single relayout, a single save and a single git commit.
+     * @return the file name of each created note, in the order of @p notes: empty for the notes that could not be created and for links
+     */
+    Q_SCRIPTABLE QStringList createNotes(const QString &basket, const QList<NoteToCreate> &notes);
+    /** Same as createNotes(), but the content of the notes is read from the given file descriptors.
+     * Through D-Bus, the descriptors are read in a thread and the reply is sent once the notes are inserted.
+     */
+    Q_SCRIPTABLE QStringList createNotesFromFds(const QString &basket, const QList<NoteToCreateFromFd> &notes);
+    /// Read-only statistics, for monitoring: the totals of every basket, and the metrics of each basket in "perBasket"
+    Q_SCRIPTABLE QVariantMap metrics();
+    /// The note counts, state, timings, memory and watches of one basket. Empty if there is no basket in @p folderName
+    Q_SCRIPTABLE QVariantMap basketMetrics(const QString &folderName);
 
 public Q_SLOTS:
     void setWindowTitle(QString s);
@@ -317,6 +336,15 @@ protected:
 
 private:
     QMenu *m_lastOpenedTagsMenu;
+    static QVariantMap metricsOf(BasketScene *basket);
+    BasketListViewItem *appendBasket(const QString &folderName, const QDomElement &properties, QTreeWidgetItem *parentItem);
+    void releaseBasket(BasketListViewItem *item);
+    BasketScene *loadedBasketForFolderName(const QString &folderName);
+    static QStringList insertCreatedNotes(BasketScene *basket, const QList<Note *> &notes);
+    static QStringList insertNotesFromFds(BasketScene *basket,
+                                          const QList<NoteToCreateFromFd> &notes,
+                                          const QStringList &fileNames,
+                                          const QList<NoteIngestion::Content> &contents);
 
 private Q_SLOTS:
     void slotPressed(QTreeWidgetItem *item, int column);
@@ -324,6 +352,8 @@ private Q_SLOTS:
     void slotContextMenu(const QPoint &pos);
     void slotShowProperties(QTreeWidgetItem *item);
     void initialize();
+    void releaseIdleBaskets();
+    void unloadBasketsOverBudget();
 
 Q_SIGNALS:
     void basketChanged();
@@ -338,6 +368,7 @@ private:
     BasketTreeListView *m_tree;
     QStackedWidget *m_stack;
     bool m_loading;
+    QTimer *m_releaseIdleBasketsTimer;
     bool m_newBasketPopup;
     bool m_firstShow;
 #ifndef _WIN32
@@ -14,104 +14,68 @@
 #include <KLocalizedString>
 
 #include "bnpview.h"
+#include "config.h"
 #include "global.h"
 
-bool FileStorage::loadFromFile(const QString &fullPath, QString *string)
+#ifdef HAVE_LIBGPGME
+#include "kgpgme.h"
+#endif
+
+bool FileStorage::loadFromFile(const QString &fullPath, QString *string, KGpgMe *gpg)
 {
     QByteArray array;
 
-    if (loadFromFile(fullPath, &array)) {
+    if (loadFromFile(fullPath, &array, gpg)) {
         *string = QString::fromUtf8(array.data(), array.size());
         return true;
     } else
         return false;
 }
 
-bool FileStorage::loadFromFile(const QString &fullPath, QByteArray *array)
+bool FileStorage::loadFromFile(const QString &fullPath, QByteArray *array, KGpgMe *gpg)
 {
     QFile file(fullPath);
-    bool encrypted = false;
-
-    if (file.open(QIODevice::ReadOnly)) {
-        *array = file.readAll();
-        const QByteArray magic = "-----BEGIN PGP MESSAGE-----";
-        int i = 0;
-
-        if (array->size() > magic.size())
-            for (i = 0; array->at(i) == magic[i]; ++i)
-                ;
-        if (i == magic.size()) {
-            encrypted = true;
-        }
-        file.close();
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    *array = file.readAll();
+    file.close();
+    if (!array->startsWith("-----BEGIN PGP MESSAGE-----"))
+        return true;
+
 #ifdef HAVE_LIBGPGME
-        if (encrypted) {
-            QByteArray tmp(*array);
-
-            tmp.detach();
-            // Only use gpg-agent for private key encryption since it doesn't
-            // cache password used in symmetric encryption.
-            m_gpg->setUseGnuPGAgent(Settings::useGnuPGAgent() && m_encryptionType == PrivateKeyEncryption);
-            if (m_encryptionType == PrivateKeyEncryption)
-                m_gpg->setText(i18n("Please enter the password for the following private key:"), false);
-            else
-                m_gpg->setText(i18n("Please enter the password for the basket <b>%1</b>:", basketName()), false); // Used when decrypting
-            return m_gpg->decrypt(tmp, array);
-        }
+    if (gpg) {
+        // The whole encrypted content is needed anyway, to find its session key if it was already decrypted:
+        // move it out instead of copying it, the decrypted content being written to array while it is read
+        QByteArray encrypted = std::move(*array);
+        return gpg->decrypt(encrypted, array);
+    }
 #else
-        if (encrypted) {
-            return false;
-        }
+    Q_UNUSED(gpg)
 #endif
-        return true;
-    } else
-        return false;
+    return false;
 }
 
-bool FileStorage::saveToFile(const QString &fullPath, const QString &string, bool isEncrypted)
+bool FileStorage::saveToFile(const QString &fullPath, const QString &string, KGpgMe *gpg, const QString &key)
 {
     const QByteArray array = string.toUtf8();
-    return saveToFile(fullPath, array, isEncrypted);
+    return saveToFile(fullPath, array, gpg, key);
 }
 
-bool FileStorage::saveToFile(const QString &fullPath, const QByteArray &array, bool isEncrypted)
+bool FileStorage::saveToFile(const QString &fullPath, const QByteArray &array, KGpgMe *gpg, const QString &key)
 {
-    bool success = true;
-    QByteArray tmp;
+    if (!gpg)
+        return safelySaveToFile(fullPath, array);
 
 #ifdef HAVE_LIBGPGME
-    if (isEncrypted) {
-        QString key;
-
-        // We only use gpg-agent for private key encryption and saving without
-        // public key doesn't need one.
-        m_gpg->setUseGnuPGAgent(false);
-        if (m_encryptionType == PrivateKeyEncryption) {
-            key = m_encryptionKey;
-            // public key doesn't need password
-            m_gpg->setText(QString(), false);
-        } else
-            m_gpg->setText(i18n("Please assign a password to the basket <b>%1</b>:", basketName()), true); // Used when defining a new password
-
-        success = m_gpg->encrypt(array, length, &tmp, key);
-        length = tmp.size();
-    } else
-        tmp = array;
-
+    QByteArray encrypted;
+    if (!gpg->encrypt(array, array.size(), &encrypted, key))
+        return false;
+    return safelySaveToFile(fullPath, encrypted);
 #else
-    success = !isEncrypted;
-    if (success)
-        tmp = array;
+    Q_UNUSED(key)
+    return false;
 #endif
-    /*if (success && (success = file.open(QIODevice::WriteOnly))){
-        success = (file.write(tmp) == (Q_LONG)tmp.size());
-        file.close();
-    }*/
-
-    if (success)
-        return safelySaveToFile(fullPath, tmp);
-    else
-        return false;
 }
 
 /**
@@ -141,7 +105,8 @@ bool FileStorage::safelySaveToFile(const QString &fullPath, const QByteArray &ar
         }
 
         if (!success) {
-            Q_EMIT Global::bnpView->showErrorMessage(i18n("Error while saving: ") + saveFile.errorString());
+            if (Global::bnpView)
+                Q_EMIT Global::bnpView->showErrorMessage(i18n("Error while saving: ") + saveFile.errorString());
 
             static const uint sleepDelay = 50; // ms
             for (uint i = 0; i < retryDelay / sleepDelay; ++i) {
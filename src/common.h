@@ -9,16 +9,22 @@
 #ifndef BASKET_COMMON_H
 #define BASKET_COMMON_H
 
+#include "basket_export.h"
+
 class QByteArray;
 class QString;
 
+class KGpgMe;
+
 namespace FileStorage
 {
-bool loadFromFile(const QString &fullPath, QString *string);
-bool loadFromFile(const QString &fullPath, QByteArray *array);
-bool saveToFile(const QString &fullPath, const QString &string, bool isEncrypted = false);
-bool saveToFile(const QString &fullPath, const QByteArray &array, bool isEncrypted = false); //[Encrypt and] save binary content
-bool safelySaveToFile(const QString &fullPath, const QByteArray &array);
+/// Load [and decrypt with @p gpg] a file. An encrypted file cannot be loaded without @p gpg
+bool loadFromFile(const QString &fullPath, QString *string, KGpgMe *gpg = nullptr);
+bool loadFromFile(const QString &fullPath, QByteArray *array, KGpgMe *gpg = nullptr);
+/// [Encrypt with @p gpg, for the public key @p key or with a password if it is empty, and] save a file
+bool saveToFile(const QString &fullPath, const QString &string, KGpgMe *gpg = nullptr, const QString &key = QString());
+bool saveToFile(const QString &fullPath, const QByteArray &array, KGpgMe *gpg = nullptr, const QString &key = QString());
+BASKET_EXPORT bool safelySaveToFile(const QString &fullPath, const QByteArray &array);
 bool safelySaveToFile(const QString &fullPath, const QString &string);
 }
 
@@ -0,0 +1,339 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "corpusgenerator.h"
+
+#include <QBuffer>
+#include <QColor>
+#include <QDateTime>
+#include <QDir>
+#include <QImage>
+#include <QPainter>
+#include <QTimeZone>
+
+#include "common.h"
+#include "xmlwork.h"
+
+namespace
+{
+const char *const words[] = {"basket", "note",    "lorem",  "ipsum",   "dolor",  "sit",     "amet",   "idea",   "todo",     "meeting",
+                             "draft",  "project", "review", "release", "kernel", "garden",  "recipe", "travel", "schedule", "budget",
+                             "paper",  "friday",  "call",   "invoice", "backup", "library", "chapter", "quote", "answer",   "question"};
+const int wordsCount = sizeof(words) / sizeof(words[0]);
+
+const char *const backgroundColors[] = {"#ffffcc", "#cce6ff", "#e6ccff", "#ccffcc", "#ffcccc", "#ffe6cc"};
+const int backgroundColorsCount = sizeof(backgroundColors) / sizeof(backgroundColors[0]);
+}
+
+CorpusGenerator::CorpusGenerator(const Parameters &parameters)
+    : m_parameters(parameters)
+    , m_random(parameters.seed)
+    , m_noteNumber(0)
+{
+}
+
+bool CorpusGenerator::generate(const QString &savesFolder)
+{
+    m_random.seed(m_parameters.seed);
+    m_savesFolder = savesFolder;
+    m_statistics = Statistics();
+    m_folderNames.clear();
+    m_noteNumber = 0;
+
+    if (!QDir().mkpath(m_savesFolder + QStringLiteral("baskets/")))
+        return false;
+    if (!writeTags())
+        return false;
+
+    QString data;
+    QXmlStreamWriter stream(&data);
+    XMLWork::setupXmlStream(stream, QStringLiteral("basketTree"));
+    if (!writeBasketTree(stream, 1))
+        return false;
+    stream.writeEndElement();
+    stream.writeEndDocument();
+    return writeFile(m_savesFolder + QStringLiteral("baskets/baskets.xml"), data.toUtf8());
+}
+
+bool CorpusGenerator::writeTags()
+{
+    QString data;
+    QXmlStreamWriter stream(&data);
+    XMLWork::setupXmlStream(stream, QStringLiteral("basketTags"));
+    stream.writeAttribute(QStringLiteral("nextStateUid"), QString::number(m_parameters.tagCount + 1));
+
+    for (int i = 1; i <= m_parameters.tagCount; ++i) {
+        const QString name = QStringLiteral("Tag %1").arg(i);
+        stream.writeStartElement(QStringLiteral("tag"));
+        stream.writeTextElement(QStringLiteral("name"), name);
+        stream.writeTextElement(QStringLiteral("shortcut"), QString());
+        stream.writeTextElement(QStringLiteral("inherited"), XMLWork::trueOrFalse(false));
+
+        stream.writeStartElement(QStringLiteral("state"));
+        stream.writeAttribute(QStringLiteral("id"), QStringLiteral("tag_state_%1").arg(i));
+        stream.writeTextElement(QStringLiteral("name"), name);
+        stream.writeTextElement(QStringLiteral("emblem"), QString());
+        stream.writeStartElement(QStringLiteral("text"));
+        stream.writeAttribute(QStringLiteral("bold"), XMLWork::trueOrFalse(i % 3 == 0));
+        stream.writeAttribute(QStringLiteral("italic"), XMLWork::trueOrFalse(i % 4 == 0));
+        stream.writeAttribute(QStringLiteral("underline"), XMLWork::trueOrFalse(false));
+        stream.writeAttribute(QStringLiteral("strikeOut"), XMLWork::trueOrFalse(false));
+        stream.writeAttribute(QStringLiteral("color"), QString());
+        stream.writeEndElement();
+        stream.writeStartElement(QStringLiteral("font"));
+        stream.writeAttribute(QStringLiteral("name"), QString());
+        stream.writeAttribute(QStringLiteral("size"), QStringLiteral("-1"));
+        stream.writeEndElement();
+        stream.writeTextElement(QStringLiteral("backgroundColor"), QString::fromLatin1(backgroundColors[i % backgroundColorsCount]));
+        stream.writeStartElement(QStringLiteral("textEquivalent"));
+        stream.writeAttribute(QStringLiteral("string"), QString());
+        stream.writeAttribute(QStringLiteral("onAllTextLines"), XMLWork::trueOrFalse(false));
+        stream.writeEndElement();
+        stream.writeTextElement(QStringLiteral("allowCrossReferences"), XMLWork::trueOrFalse(true));
+        stream.writeEndElement(); // state
+
+        stream.writeEndElement(); // tag
+    }
+
+    stream.writeEndElement();
+    stream.writeEndDocument();
+    return writeFile(m_savesFolder + QStringLiteral("tags.xml"), data.toUtf8());
+}
+
+bool CorpusGenerator::writeBasketTree(QXmlStreamWriter &stream, int level)
+{
+    for (int i = 0; i < m_parameters.basketsPerLevel; ++i) {
+        const int number = m_folderNames.count() + 1;
+        const QString folderName = QStringLiteral("basket%1/").arg(number);
+        const QString name = QStringLiteral("Basket %1").arg(number);
+        m_folderNames.append(folderName);
+        ++m_statistics.baskets;
+
+        stream.writeStartElement(QStringLiteral("basket"));
+        stream.writeAttribute(QStringLiteral("folderName"), folderName);
+        stream.writeAttribute(QStringLiteral("folded"), XMLWork::trueOrFalse(false));
+        if (number == 1)
+            stream.writeAttribute(QStringLiteral("lastOpened"), XMLWork::trueOrFalse(true));
+        writeProperties(stream, name);
+
+        if (!writeBasket(folderName, name))
+            return false;
+        if (level < m_parameters.treeDepth && !writeBasketTree(stream, level + 1))
+            return false;
+
+        stream.writeEndElement();
+    }
+    return true;
+}
+
+void CorpusGenerator::writeProperties(QXmlStreamWriter &stream, const QString &name)
+{
+    stream.writeStartElement(QStringLiteral("properties"));
+    stream.writeTextElement(QStringLiteral("name"), name);
+    stream.writeTextElement(QStringLiteral("icon"), QStringLiteral("basket"));
+
+    stream.writeStartElement(QStringLiteral("appearance"));
+    stream.writeAttribute(QStringLiteral("backgroundColor"), QString());
+    stream.writeAttribute(QStringLiteral("backgroundImage"), QString());
+    stream.writeAttribute(QStringLiteral("textColor"), QString());
+    stream.writeEndElement();
+
+    stream.writeStartElement(QStringLiteral("disposition"));
+    stream.writeAttribute(QStringLiteral("columnCount"), QString::number(qMax(1, m_parameters.columnsPerBasket)));
+    stream.writeAttribute(QStringLiteral("free"), XMLWork::trueOrFalse(false));
+    stream.writeAttribute(QStringLiteral("mindMap"), XMLWork::trueOrFalse(false));
+    stream.writeEndElement();
+
+    stream.writeStartElement(QStringLiteral("shortcut"));
+    stream.writeAttribute(QStringLiteral("action"), QStringLiteral("show"));
+    stream.writeAttribute(QStringLiteral("combination"), QString());
+    stream.writeEndElement();
+
+    stream.writeStartElement(QStringLiteral("protection"));
+    stream.writeAttribute(QStringLiteral("key"), QString());
+    stream.writeAttribute(QStringLiteral("type"), QStringLiteral("0"));
+    stream.writeEndElement();
+
+    stream.writeEndElement();
+}
+
+bool CorpusGenerator::writeBasket(const QString &folderName, const QString &name)
+{
+    const QString folderPath = m_savesFolder + QStringLiteral("baskets/") + folderName;
+    if (!QDir().mkpath(folderPath))
+        return false;
+
+    QString data;
+    QXmlStreamWriter stream(&data);
+    XMLWork::setupXmlStream(stream, QStringLiteral("basket"));
+    writeProperties(stream, name);
+
+    // In a columns layout, the top-level groups are the columns:
+    stream.writeStartElement(QStringLiteral("notes"));
+    const int columnsCount = qMax(1, m_parameters.columnsPerBasket);
+    for (int column = 0; column < columnsCount; ++column) {
+        const int notesCount = m_parameters.notesPerBasket / columnsCount + (column < m_parameters.notesPerBasket % columnsCount ? 1 : 0);
+        stream.writeStartElement(QStringLiteral("group"));
+        ++m_statistics.groups;
+        if (!writeNotes(stream, folderPath, notesCount, 1))
+            return false;
+        stream.writeEndElement();
+    }
+    stream.writeEndElement();
+
+    stream.writeEndElement();
+    stream.writeEndDocument();
+    return writeFile(folderPath + QStringLiteral(".basket"), data.toUtf8());
+}
+
+bool CorpusGenerator::writeNotes(QXmlStreamWriter &stream, const QString &folderPath, int notesCount, int groupLevel)
+{
+    // Until the wanted depth is reached, every group is split in two sub-groups:
+    if (groupLevel <= m_parameters.groupDepth && notesCount >= 2) {
+        const int counts[] = {notesCount - notesCount / 2, notesCount / 2};
+        for (int count : counts) {
+            stream.writeStartElement(QStringLiteral("group"));
+            stream.writeAttribute(QStringLiteral("folded"), XMLWork::trueOrFalse(false));
+            ++m_statistics.groups;
+            if (!writeNotes(stream, folderPath, count, groupLevel + 1))
+                return false;
+            stream.writeEndElement();
+        }
+        return true;
+    }
+
+    for (int i = 0; i < notesCount; ++i) {
+        if (!writeNote(stream, folderPath))
+            return false;
+    }
+    return true;
+}
+
+bool CorpusGenerator::writeNote(QXmlStreamWriter &stream, const QString &folderPath)
+{
+    ++m_noteNumber;
+    ++m_statistics.notes;
+
+    const int totalWeight = m_parameters.htmlWeight + m_parameters.imageWeight + m_parameters.linkWeight + m_parameters.fileWeight;
+    int pick = (totalWeight > 0 ? int(m_random.bounded(totalWeight)) : 0);
+    // Dates are computed in UTC, so the corpus does not depend on the time zone, and written without time zone, like BasketScene::saveNotes() does:
+    const QDateTime added = QDateTime(QDate(2020, 1, 1), QTime(0, 0), QTimeZone::utc()).addSecs(m_random.bounded(365 * 24 * 3600));
+    const QDateTime lastModification = added.addSecs(m_random.bounded(30 * 24 * 3600));
+    const QString dateFormat = QStringLiteral("yyyy-MM-dd'T'HH:mm:ss");
+
+    stream.writeStartElement(QStringLiteral("note"));
+    stream.writeAttribute(QStringLiteral("added"), added.toString(dateFormat));
+    stream.writeAttribute(QStringLiteral("lastModification"), lastModification.toString(dateFormat));
+
+    bool written = true;
+    if (totalWeight <= 0 || (pick -= m_parameters.htmlWeight) < 0) {
+        const QString fileName = QStringLiteral("note%1.html").arg(m_noteNumber);
+        const int characters = m_parameters.textSize / 2 + int(m_random.bounded(qMax(1, m_parameters.textSize)));
+        QString html = QStringLiteral("<html><head><meta name=\"qrichtext\" content=\"1\" /></head><body>");
+        // Paragraphs of about 200 characters:
+        for (int length = 0; length < characters; length += 200)
+            html += QStringLiteral("<p>") + sentence(qMin(200, characters - length)) + QStringLiteral("</p>");
+        html += QStringLiteral("</body></html>");
+
+        stream.writeAttribute(QStringLiteral("type"), QStringLiteral("html"));
+        stream.writeTextElement(QStringLiteral("content"), fileName);
+        written = writeFile(folderPath + fileName, html.toUtf8());
+    } else if ((pick -= m_parameters.imageWeight) < 0) {
+        const QString fileName = QStringLiteral("note%1.png").arg(m_noteNumber);
+        const int size = qMax(1, m_parameters.imageSize);
+        QImage image(size, size, QImage::Format_RGB32);
+        image.fill(QColor::fromHsv(m_random.bounded(360), 80 + m_random.bounded(100), 200));
+        QPainter painter(&image);
+        painter.fillRect(size / 4, size / 4, size / 2, size / 2, QColor::fromHsv(m_random.bounded(360), 200, 150));
+        painter.end();
+        QByteArray png;
+        QBuffer buffer(&png);
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "PNG");
+
+        stream.writeAttribute(QStringLiteral("type"), QStringLiteral("image"));
+        stream.writeTextElement(QStringLiteral("content"), fileName);
+        written = writeFile(folderPath + fileName, png);
+    } else if ((pick -= m_parameters.linkWeight) < 0) {
+        // Without automatic title nor icon, so loading the corpus never reaches the network:
+        const QString word = QString::fromLatin1(words[m_random.bounded(wordsCount)]);
+        stream.writeAttribute(QStringLiteral("type"), QStringLiteral("link"));
+        stream.writeStartElement(QStringLiteral("content"));
+        stream.writeAttribute(QStringLiteral("title"), sentence(30));
+        stream.writeAttribute(QStringLiteral("icon"), QStringLiteral("text-html"));
+        stream.writeAttribute(QStringLiteral("autoIcon"), XMLWork::trueOrFalse(false));
+        stream.writeAttribute(QStringLiteral("autoTitle"), XMLWork::trueOrFalse(false));
+        stream.writeCharacters(QStringLiteral("https://example.org/%1/%2").arg(word).arg(m_noteNumber));
+        stream.writeEndElement();
+    } else {
+        const QString fileName = QStringLiteral("note%1.dat").arg(m_noteNumber);
+        QByteArray data(qMax(0, m_parameters.fileSize), Qt::Uninitialized);
+        for (char &byte : data)
+            byte = char(m_random.bounded(256));
+
+        stream.writeAttribute(QStringLiteral("type"), QStringLiteral("file"));
+        stream.writeTextElement(QStringLiteral("content"), fileName);
+        written = writeFile(folderPath + fileName, data);
+    }
+
+    const QStringList tags = randomTags();
+    if (!tags.isEmpty())
+        stream.writeTextElement(QStringLiteral("tags"), tags.join(QLatin1Char(';')));
+
+    stream.writeEndElement();
+    return written;
+}
+
+bool CorpusGenerator::writeFile(const QString &path, const QByteArray &data)
+{
+    m_statistics.bytes += data.size();
+    return FileStorage::safelySaveToFile(path, data);
+}
+
+QString CorpusGenerator::sentence(int characters)
+{
+    QString text;
+    text.reserve(characters + 32);
+    int wordsInSentence = 0;
+    while (text.length() < characters) {
+        if (!text.isEmpty())
+            text += QLatin1Char(' ');
+        // Some URLs, so detecting links in the text has something to find:
+        if (m_random.bounded(40) == 0)
+            text += QStringLiteral("https://example.org/page%1").arg(m_random.bounded(1000));
+        else
+            text += QString::fromLatin1(words[m_random.bounded(wordsCount)]);
+        if (++wordsInSentence >= 12) {
+            text += QLatin1Char('.');
+            wordsInSentence = 0;
+        }
+    }
+    return text;
+}
+
+QStringList CorpusGenerator::randomTags()
+{
+    QStringList tags;
+    if (m_parameters.tagCount <= 0 || int(m_random.bounded(100)) >= m_parameters.taggedPercent)
+        return tags;
+
+    // The tag i is chosen with a weight of 1/i, like the few tags used on most notes and the many rarely used ones of real baskets:
+    double totalWeight = 0;
+    for (int i = 1; i <= m_parameters.tagCount; ++i)
+        totalWeight += 1.0 / i;
+
+    const int wanted = qMin(m_parameters.tagCount, 1 + int(m_random.bounded(qMax(1, m_parameters.maxTagsPerNote))));
+    while (tags.count() < wanted) {
+        double pick = m_random.generateDouble() * totalWeight;
+        int tag = 1;
+        while (tag < m_parameters.tagCount && (pick -= 1.0 / tag) >= 0)
+            ++tag;
+        const QString state = QStringLiteral("tag_state_%1").arg(tag);
+        if (!tags.contains(state))
+            tags.append(state);
+    }
+    return tags;
+}
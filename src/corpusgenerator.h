@@ -0,0 +1,91 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef CORPUSGENERATOR_H
+#define CORPUSGENERATOR_H
+
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+#include <QXmlStreamWriter>
+
+/** Write a synthetic saves folder (baskets.xml, the .basket file and the note files of every basket, and tags.xml),
+ * to benchmark, test and profile BasKet on reproducible large note stores.
+ * The same parameters (seed included) always produce the same files, byte for byte.
+ */
+class CorpusGenerator
+{
+public:
+    struct Parameters {
+        quint32 seed = 1;
+
+        int treeDepth = 1; ///< Number of levels of the basket tree. 1 means only top-level baskets
+        int basketsPerLevel = 1; ///< Number of top-level baskets, and of children of every other basket
+        int notesPerBasket = 100;
+        int columnsPerBasket = 3;
+        int groupDepth = 0; ///< Number of levels of groups in the columns. 0 puts the notes directly in the columns
+
+        // Relative weights of the note types:
+        int htmlWeight = 70;
+        int imageWeight = 10;
+        int linkWeight = 15;
+        int fileWeight = 5;
+
+        int tagCount = 8; ///< Number of tags in tags.xml, each of them with one state
+        int taggedPercent = 30; ///< Percentage of notes having tags
+        int maxTagsPerNote = 3; ///< Tagged notes get 1 to maxTagsPerNote tags, the first tags being used more often than the last ones
+
+        int textSize = 400; ///< Mean number of characters of the HTML notes
+        int imageSize = 64; ///< Width and height, in pixels, of the images
+        int fileSize = 4096; ///< Size, in bytes, of the files of the file notes
+    };
+
+    struct Statistics {
+        int baskets = 0;
+        int notes = 0;
+        int groups = 0; ///< Columns included
+        qint64 bytes = 0; ///< Size of every file written
+    };
+
+    explicit CorpusGenerator(const Parameters &parameters);
+
+    /** Write the corpus in @p savesFolder (which ends with a slash). The baskets go to savesFolder/baskets/.
+     * @return false if a file could not be written
+     */
+    bool generate(const QString &savesFolder);
+
+    const Statistics &statistics() const
+    {
+        return m_statistics;
+    }
+
+    /// The folder names (eg. "basket3/") of the generated baskets, in the order of the basket tree
+    const QStringList &folderNames() const
+    {
+        return m_folderNames;
+    }
+
+private:
+    bool writeTags();
+    bool writeBasketTree(QXmlStreamWriter &stream, int level);
+    bool writeBasket(const QString &folderName, const QString &name);
+    bool writeNotes(QXmlStreamWriter &stream, const QString &folderPath, int notesCount, int groupLevel);
+    bool writeNote(QXmlStreamWriter &stream, const QString &folderPath);
+    void writeProperties(QXmlStreamWriter &stream, const QString &name);
+    bool writeFile(const QString &path, const QByteArray &data);
+
+    QString sentence(int characters);
+    QStringList randomTags();
+
+    const Parameters m_parameters;
+    QRandomGenerator m_random;
+    QString m_savesFolder;
+    Statistics m_statistics;
+    QStringList m_folderNames;
+    int m_noteNumber;
+};
+
+#endif // CORPUSGENERATOR_H
@@ -6,15 +6,23 @@
 #include "debugwindow.h"
 
 #include <QCloseEvent>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
 #include <QString>
+#include <QStringList>
+#include <QTimer>
 #include <QVBoxLayout>
 
 #include <QLocale>
 #include <QTextBrowser>
 
 #include <KLocalizedString>
+#include <KMessageBox>
 
 #include "global.h"
+#include "tracing.h"
 
 DebugWindow::DebugWindow(QWidget *parent)
     : QWidget(parent)
@@ -23,10 +31,39 @@ DebugWindow::DebugWindow(QWidget *parent)
     setWindowTitle(i18n("Debug Window"));
 
     layout = new QVBoxLayout(this);
+    countersLabel = new QLabel(this);
+    countersLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    countersLabel->hide();
+    traceLabel = new QLabel(this);
+    traceLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    traceTimer = new QTimer(this);
     textBrowser = new QTextBrowser(this);
 
     textBrowser->setWordWrapMode(QTextOption::NoWrap);
 
+    layout->addWidget(countersLabel);
+#if ENABLE_TRACING
+    auto *traceButtons = new QHBoxLayout;
+    auto *exportButton = new QPushButton(i18n("&Export Trace..."), this);
+    auto *clearButton = new QPushButton(i18n("&Clear Trace"), this);
+    traceButtons->addWidget(traceLabel, 1);
+    traceButtons->addWidget(exportButton, 0, Qt::AlignTop);
+    traceButtons->addWidget(clearButton, 0, Qt::AlignTop);
+    layout->addLayout(traceButtons);
+    connect(exportButton, &QPushButton::clicked, this, &DebugWindow::exportTrace);
+    connect(clearButton, &QPushButton::clicked, this, [this]() {
+        Tracing::clear();
+        updateTraceSummary();
+    });
+
+    // Spans are only recorded while this window is open:
+    Tracing::setEnabled(true);
+    connect(traceTimer, &QTimer::timeout, this, &DebugWindow::updateTraceSummary);
+    traceTimer->start(1000);
+    updateTraceSummary();
+#else
+    traceLabel->hide();
+#endif
     layout->addWidget(textBrowser);
     textBrowser->show();
 }
@@ -34,6 +71,7 @@ DebugWindow::DebugWindow(QWidget *parent)
 DebugWindow::~DebugWindow()
 {
     delete textBrowser;
+    delete countersLabel;
     delete layout;
 }
 
@@ -49,6 +87,51 @@ DebugWindow &DebugWindow::operator<<(const QString msg)
     return *this;
 }
 
+void DebugWindow::setCounter(const QString &name, const QString &value)
+{
+    QMetaObject::invokeMethod(this, "showCounter", Qt::QueuedConnection, Q_ARG(QString, name), Q_ARG(QString, value));
+}
+
+void DebugWindow::showCounter(const QString &name, const QString &value)
+{
+    counters.insert(name, value);
+
+    QStringList lines;
+    for (auto it = counters.cbegin(); it != counters.cend(); ++it)
+        lines.append(QStringLiteral("<b>%1:</b> %2").arg(it.key().toHtmlEscaped(), it.value().toHtmlEscaped()));
+    countersLabel->setText(lines.join(QStringLiteral("<br>")));
+    countersLabel->show();
+}
+
+void DebugWindow::updateTraceSummary()
+{
+    const QList<Tracing::Summary> summaries = Tracing::summaries();
+    if (summaries.isEmpty()) {
+        traceLabel->setText(i18n("No traced operation yet."));
+        return;
+    }
+
+    QString text = QStringLiteral("<table><tr><th align=left>%1</th><th>%2</th><th>%3</th><th>%4</th><th>%5</th></tr>")
+                       .arg(i18n("Operation"), i18n("Count"), i18n("Total (ms)"), i18n("Average (ms)"), i18n("Max (ms)"));
+    for (const Tracing::Summary &summary : summaries)
+        text += QStringLiteral("<tr><td>%1</td><td align=right>%2</td><td align=right>%3</td><td align=right>%4</td><td align=right>%5</td></tr>")
+                    .arg(summary.name.toHtmlEscaped())
+                    .arg(summary.count)
+                    .arg(summary.totalNs / 1e6, 0, 'f', 1)
+                    .arg(summary.totalNs / 1e6 / summary.count, 0, 'f', 2)
+                    .arg(summary.maxNs / 1e6, 0, 'f', 2);
+    traceLabel->setText(text + QStringLiteral("</table>"));
+}
+
+void DebugWindow::exportTrace()
+{
+    const QString path = QFileDialog::getSaveFileName(this, i18n("Export Trace"), QStringLiteral("basket-trace.json"), i18n("Chrome Trace (*.json)"));
+    if (path.isEmpty())
+        return;
+    if (!Tracing::saveChromeTrace(path))
+        KMessageBox::error(this, i18n("Unable to write the trace to %1.", path));
+}
+
 void DebugWindow::insertHLine()
 {
     textBrowser->append(QStringLiteral("<hr>"));
@@ -57,6 +140,8 @@ void DebugWindow::insertHLine()
 void DebugWindow::closeEvent(QCloseEvent *event)
 {
     Global::debugWindow = nullptr;
+    Tracing::setEnabled(false);
+    traceTimer->stop();
     QWidget::closeEvent(event);
 }
 
@@ -9,12 +9,15 @@
 #include <QDebug>
 #include <QFile>
 #include <QLatin1String>
+#include <QMap>
 #include <QStringLiteral>
 #include <QTextStream>
 #include <QWidget>
 
 #include "global.h"
 
+class QLabel;
+class QTimer;
 class QVBoxLayout;
 class QTextBrowser;
 class QString;
@@ -35,13 +38,26 @@ public:
     Q_INVOKABLE void postMessage(const QString msg);
     DebugWindow &operator<<(const QString msg);
     void insertHLine();
+    /** Show the current value of a counter (eg. a frame time) above the messages, without flooding them.
+     * Like operator<<, it can be called from any thread */
+    void setCounter(const QString &name, const QString &value);
+    Q_INVOKABLE void showCounter(const QString &name, const QString &value);
 
 protected:
     void closeEvent(QCloseEvent *event) override;
 
+private Q_SLOTS:
+    /** Show the time spent in the traced hot paths, and let the spans be exported in the Chrome trace-event format */
+    void updateTraceSummary();
+    void exportTrace();
+
 private:
     QVBoxLayout *layout;
+    QLabel *countersLabel;
+    QLabel *traceLabel;
+    QTimer *traceTimer;
     QTextBrowser *textBrowser;
+    QMap<QString, QString> counters;
 };
 
 #ifdef DEBUG_PIPE
@@ -39,9 +39,11 @@ DecoratedBasket::DecoratedBasket(QWidget *parent, const QString &folderName)
     connect(m_filter, &FilterBar::newFilter, m_basket, [this](const FilterData &data) {
         m_basket->newFilter(data);
     });
-    connect(m_basket, &BasketScene::postMessage, Global::bnpView, &BNPView::postStatusbarMessage);
-    connect(m_basket, &BasketScene::setStatusBarText, Global::bnpView, &BNPView::setStatusBarHint);
-    connect(m_basket, &BasketScene::resetStatusBarText, Global::bnpView, &BNPView::updateStatusBarHint);
+    if (Global::bnpView) { // Not in basketbatch
+        connect(m_basket, &BasketScene::postMessage, Global::bnpView, &BNPView::postStatusbarMessage);
+        connect(m_basket, &BasketScene::setStatusBarText, Global::bnpView, &BNPView::setStatusBarHint);
+        connect(m_basket, &BasketScene::resetStatusBarText, Global::bnpView, &BNPView::updateStatusBarHint);
+    }
 }
 
 void DecoratedBasket::setFilterBarPosition(bool onTop)
@@ -0,0 +1,170 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "filenameallocator.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+QMutex FileNameAllocator::s_mutex;
+QHash<QString, FileNameAllocator::Folder> FileNameAllocator::s_folders;
+
+QString FileNameAllocator::allocate(const QString &folder, const QString &wantedName)
+{
+    QMutexLocker locker(&s_mutex);
+    return allocateLocked(folder, wantedName, /*create=*/false);
+}
+
+QString FileNameAllocator::reserve(const QString &folder, const QString &wantedName)
+{
+    QMutexLocker locker(&s_mutex);
+    return allocateLocked(folder, wantedName, /*create=*/true);
+}
+
+QString FileNameAllocator::reserveNumbered(const QString &folder, const QString &pattern, int first)
+{
+    QMutexLocker locker(&s_mutex);
+    Folder &cached = FileNameAllocator::folder(folder);
+
+    for (int number = qMax(first, cached.nextNumbers.value(pattern, first));; ++number) {
+        const QString name = pattern.arg(number);
+        if (cached.names.contains(name))
+            continue;
+        const bool taken = take(folder, name, /*create=*/true);
+        addName(cached, name);
+        if (taken) {
+            cached.nextNumbers.insert(pattern, number + 1);
+            return name;
+        }
+        if (!QFileInfo::exists(folder + name)) // The file cannot be created at all: do not try forever
+            return QString();
+    }
+}
+
+void FileNameAllocator::invalidate(const QString &folder)
+{
+    QMutexLocker locker(&s_mutex);
+    s_folders.remove(folder);
+}
+
+void FileNameAllocator::release(const QString &path)
+{
+    // Callers do not always write the paths the same way (eg. with a double slash), so compare them cleaned:
+    const QString cleanPath = QDir::cleanPath(path);
+    const QString parent = cleanPath.left(cleanPath.lastIndexOf(QLatin1Char('/')));
+    const QString name = cleanPath.mid(parent.length() + 1);
+
+    QMutexLocker locker(&s_mutex);
+    for (auto it = s_folders.begin(); it != s_folders.end();) {
+        const QString folder = QDir::cleanPath(it.key());
+        if (folder == cleanPath || folder.startsWith(cleanPath + QLatin1Char('/'))) {
+            it = s_folders.erase(it);
+            continue;
+        }
+        if (folder == parent)
+            it->names.remove(name); // The highest number is kept: it only makes the next numbered names a bit higher
+        ++it;
+    }
+}
+
+FileNameAllocator::Folder &FileNameAllocator::folder(const QString &path)
+{
+    auto it = s_folders.find(path);
+    if (it != s_folders.end())
+        return it.value();
+
+    // First file for that folder: list it once
+    Folder &cached = s_folders[path];
+    const QStringList names = QDir(path).entryList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+    cached.names.reserve(names.size());
+    for (const QString &name : names)
+        addName(cached, name);
+    return cached;
+}
+
+void FileNameAllocator::splitName(const QString &name, QString *stem, int *number, QString *extension)
+{
+    // Split the name in stem, number and extension, like Tools::fileNameForNewFile() always did.
+    // Example : "note5-3.txt" => stem = "note5", number = 3 and extension = ".txt"
+    *stem = name;
+    *number = 0;
+    extension->clear();
+
+    int extIndex = stem->lastIndexOf(QLatin1Char('.'));
+    if (extIndex != -1 && extIndex != int(stem->length() - 1)) { // Extension found and name do not ends with '.' !
+        *extension = stem->mid(extIndex);
+        stem->truncate(extIndex);
+    }
+
+    int numberIndex = stem->lastIndexOf(QLatin1Char('-'));
+    if (numberIndex != -1 && numberIndex != int(stem->length() - 1)) { // Number found and name do not ends with '-' !
+        bool isANumber;
+        int theNumber = stem->mid(numberIndex + 1).toInt(&isANumber);
+        if (isANumber && theNumber > 0) {
+            *number = theNumber;
+            stem->truncate(numberIndex);
+        }
+    }
+}
+
+void FileNameAllocator::addName(Folder &folder, const QString &name)
+{
+    folder.names.insert(name);
+
+    QString stem;
+    QString extension;
+    int number;
+    splitName(name, &stem, &number, &extension);
+    int &highest = folder.highestNumbers[stem + QLatin1Char('/') + extension]; // A slash cannot be part of a file name
+    highest = qMax(highest, number);
+}
+
+QString FileNameAllocator::allocateLocked(const QString &folder, const QString &wantedName, bool create)
+{
+    Folder &cached = FileNameAllocator::folder(folder);
+
+    // First check if the file do not exists yet (simpler and more often case)
+    if (!cached.names.contains(wantedName)) {
+        const bool taken = take(folder, wantedName, create);
+        addName(cached, wantedName);
+        if (taken)
+            return wantedName;
+        if (create && !QFileInfo::exists(folder + wantedName))
+            return QString();
+    }
+
+    // Then, continue after the highest number used for that name (if the file already exists, the generated name is at last the 2nd):
+    QString stem;
+    QString extension;
+    int number;
+    splitName(wantedName, &stem, &number, &extension);
+    number = qMax(qMax(number, 2), cached.highestNumbers.value(stem + QLatin1Char('/') + extension) + 1);
+
+    for (;; ++number) {
+        const QString name = stem + QLatin1Char('-') + QString::number(number) + extension;
+        if (cached.names.contains(name))
+            continue;
+        const bool taken = take(folder, name, create);
+        addName(cached, name);
+        if (taken)
+            return name;
+        if (create && !QFileInfo::exists(folder + name)) // The file cannot be created at all: do not try forever
+            return QString();
+    }
+}
+
+bool FileNameAllocator::take(const QString &folder, const QString &name, bool create)
+{
+    const QString fullPath = folder + name;
+    if (!create)
+        return !QFileInfo::exists(fullPath);
+
+    // NewOnly opens the file with O_EXCL: it fails if another process created the file since the folder was listed
+    QFile file(fullPath);
+    return file.open(QIODevice::WriteOnly | QIODevice::NewOnly);
+}
@@ -0,0 +1,69 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef FILENAMEALLOCATOR_H
+#define FILENAMEALLOCATOR_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+#include "basket_export.h"
+
+/** Find free names for new files, shared by every code creating files in baskets, in exports or in the cut folder.
+ * The listing of each folder is read once and kept with the highest number used for each name, so finding a free
+ * name for the thousandth file pasted in a folder costs the same as for the first one, instead of one stat per try.
+ * The cache only gives candidates: a name is checked on disk before being handed out, and the files created by
+ * reserve() and reserveNumbered() are created exclusively (O_EXCL), so a stale cache can never hand out a used name.
+ * This class is thread-safe.
+ */
+class BASKET_EXPORT FileNameAllocator
+{
+public:
+    /** Return a name derived from @p wantedName that is free in @p folder, and consider it used from now on.
+     * @p folder ends with a slash. If @p wantedName is used, a dash and a number are added before the extension,
+     * as Tools::fileNameForNewFile() documents. The file is not created.
+     */
+    static QString allocate(const QString &folder, const QString &wantedName);
+
+    /** Same as allocate(), but also create the file, empty, so no other process can take the name.
+     * @return the name of the created file, or an empty string if no file can be created in @p folder
+     */
+    static QString reserve(const QString &folder, const QString &wantedName);
+
+    /** Create an empty file named after @p pattern, where %1 is replaced by a number starting at @p first,
+     * eg. "note%1-101530.html". The numbers already tried for that pattern are not tried again.
+     * @return the name of the created file, or an empty string if no file can be created in @p folder
+     */
+    static QString reserveNumbered(const QString &folder, const QString &pattern, int first);
+
+    /// Forget everything known about @p folder, eg. after it has been emptied or removed
+    static void invalidate(const QString &folder);
+
+    /** Forget the file or folder @p path after it was deleted or renamed, so its name can be handed out again.
+     * If @p path is a folder, what is known about it and its sub-folders is forgotten too. Tools::deleteRecursively() calls it.
+     */
+    static void release(const QString &path);
+
+private:
+    struct Folder {
+        QSet<QString> names; ///< Names in the folder when it was listed, and every name handed out since then
+        QHash<QString, int> highestNumbers; ///< For each name without its number, the highest number seen
+        QHash<QString, int> nextNumbers; ///< For each pattern of reserveNumbered(), the next number to try
+    };
+
+    static Folder &folder(const QString &path);
+    static void splitName(const QString &name, QString *stem, int *number, QString *extension);
+    static void addName(Folder &folder, const QString &name);
+    static QString allocateLocked(const QString &folder, const QString &wantedName, bool create);
+    static bool take(const QString &folder, const QString &name, bool create);
+
+    static QMutex s_mutex;
+    static QHash<QString, Folder> s_folders;
+};
+
+#endif // FILENAMEALLOCATOR_H
@@ -80,7 +80,8 @@ FilterBar::FilterBar(QWidget *parent)
     connect(m_tagsBox, &QComboBox::activated, this, &FilterBar::tagChanged);
 
     // connect(m_inAllBasketsButton, &QAbstractButton::clicked, this, &FilterBar::inAllBaskets);
-    m_inAllBasketsButton->setDefaultAction(Global::bnpView->m_actFilterAllBaskets);
+    if (Global::bnpView) // Not in basketbatch
+        m_inAllBasketsButton->setDefaultAction(Global::bnpView->m_actFilterAllBaskets);
 
     auto *lineEditF = new FocusWidgetFilter(m_lineEdit);
     m_tagsBox->installEventFilter(lineEditF);
@@ -14,6 +14,7 @@
 #include "config.h"
 #include "gitwrapper.h"
 #include "settings.h"
+#include "tracing.h"
 
 #if HAVE_LIBGIT2
 
@@ -29,6 +30,18 @@ extern "C" {
 
 QMutex GitWrapper::gitMutex;
 
+namespace
+{
+// Caches that can be computed again, and only grow the history (see PreviewCache):
+const char *const UNVERSIONED_FOLDER = "previews";
+
+void ignoreCaches(git_repository *repo)
+{
+    if (repo)
+        git_ignore_add_rule(repo, "/previews/\n");
+}
+}
+
 void GitWrapper::initializeGitRepository(QString folder)
 {
     GIT_RETURN_IF_DISABLED()
@@ -44,6 +57,7 @@ void GitWrapper::initializeGitRepository(QString folder)
         const git_error *e = giterr_last();
         qDebug() << e->message;
     }
+    ignoreCaches(repo);
 
     git_signature *sig = nullptr;
     git_index *index = nullptr;
@@ -205,6 +219,7 @@ void GitWrapper::commitDeleteBasket(QString basketFolderName)
 
 void GitWrapper::commitBasket(BasketScene *basket)
 {
+    BASKET_TRACE("GitWrapper::commitBasket");
     GIT_RETURN_IF_DISABLED()
     QMutexLocker l(&gitMutex);
     git_repository *repo = openRepository();
@@ -272,6 +287,9 @@ bool GitWrapper::commitPattern(git_repository *repo, QString pattern, QString me
         return false;
     }
 
+    // Previews committed before they were ignored leave the history from now on:
+    git_index_remove_directory(index, UNVERSIONED_FOLDER, 0);
+
     QByteArray patternba = pattern.toUtf8();
     char *patternCString = patternba.data();
     git_strarray arr = {&patternCString, 1};
@@ -290,6 +308,7 @@ bool GitWrapper::commitPattern(git_repository *repo, QString pattern, QString me
 
 bool GitWrapper::commitIndex(git_repository *repo, git_index *index, QString message)
 {
+    BASKET_TRACE("GitWrapper::commitIndex");
     //  write git index
     git_signature *sig = nullptr;
     git_oid tree_id;
@@ -382,6 +401,7 @@ git_repository *GitWrapper::openRepository()
         gitErrorHandling();
         return repo;
     }
+    ignoreCaches(repo);
     return repo;
 }
 
@@ -68,6 +68,10 @@ QString Global::tempCutFolder()
 {
     return savesFolder() + QStringLiteral("temp-cut/");
 }
+QString Global::previewsFolder()
+{
+    return savesFolder() + QStringLiteral("previews/");
+}
 QString Global::gitFolder()
 {
     return savesFolder() + QStringLiteral(".git/");
@@ -47,6 +47,7 @@ public:
     static QString backgroundsFolder(); /// << @return e.g. "/home/username/.local/share/basket/backgrounds/".
     static QString templatesFolder(); /// << @return e.g. "/home/username/.local/share/basket/templates/".
     static QString tempCutFolder(); /// << @return e.g. "/home/username/.local/share/basket/temp-cut/".   (was ".tmp/")
+    static QString previewsFolder(); /// << @return e.g. "/home/username/.local/share/basket/previews/".
     static QString gitFolder(); /// << @return e.g. "/home/username/.local/share/basket/.git/".
 
     // Various Things:
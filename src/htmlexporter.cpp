@@ -11,6 +11,7 @@
 #include "bnpview.h"
 #include "common.h"
 #include "config.h"
+#include "filenameallocator.h"
 #include "linklabel.h"
 #include "note.h"
 #include "notecontent.h"
@@ -23,19 +24,19 @@
 #include <KLocalizedString>
 #include <KMessageBox>
 
-#include <KIO/CopyJob> //For KIO::copy
-#include <KIO/FileCopyJob> //For KIO::file_copy
-#include <KIO/Job>
 
 #include <QApplication>
+#include <QCryptographicHash>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QFileDialog>
 #include <QList>
 #include <QLocale>
 #include <QPainter>
 #include <QPixmap>
 #include <QProgressDialog>
+#include <QSaveFile>
 #include <QTextStream>
 
 #include <basket_version.h>
@@ -93,13 +94,42 @@ HTMLExporter::HTMLExporter(BasketScene *basket)
     dialog->setValue(dialog->value() + 1); // Finishing finished
 }
 
+HTMLExporter::HTMLExporter(BasketScene *basket, const QString &destination, const QHash<BasketScene *, QList<BasketScene *>> &subBaskets)
+    : dialog(new QProgressDialog())
+    , subBaskets(subBaskets)
+{
+    prepareExport(basket, destination);
+    exportBasket(basket, /*isSubBasketScene*/ false);
+}
+
 HTMLExporter::~HTMLExporter() = default;
 
+QList<BasketScene *> HTMLExporter::subBasketsOf(BasketScene *basket) const
+{
+    if (!Global::bnpView)
+        return subBaskets.value(basket);
+
+    QList<BasketScene *> baskets;
+    BasketListViewItem *item = Global::bnpView->listViewItemForBasket(basket);
+    for (int i = 0; item && i < item->childCount(); i++)
+        baskets.append(((BasketListViewItem *)item->child(i))->basket());
+    return baskets;
+}
+
+int HTMLExporter::basketCount(BasketScene *basket) const
+{
+    int count = 1;
+    const QList<BasketScene *> children = subBasketsOf(basket);
+    for (BasketScene *child : children)
+        count += basketCount(child);
+    return count;
+}
+
 void HTMLExporter::prepareExport(BasketScene *basket, const QString &fullPath)
 {
     dialog->setRange(0,
                      /*Preparation:*/ 1 + /*Finishing:*/ 1 + /*Basket:*/ 1
-                         + /*SubBaskets:*/ Global::bnpView->basketCount(Global::bnpView->listViewItemForBasket(basket)));
+                         + /*SubBaskets:*/ basketCount(basket));
     dialog->setValue(0);
     qApp->processEvents();
 
@@ -109,8 +139,7 @@ void HTMLExporter::prepareExport(BasketScene *basket, const QString &fullPath)
     exportedBasket = basket;
     currentBasket = nullptr;
 
-    BasketListViewItem *item = Global::bnpView->listViewItemForBasket(basket);
-    withBasketTree = (item->childCount() >= 0);
+    withBasketTree = true;
 
     // Create and empty the files folder:
     QString filesFolderPath = i18nc("HTML export folder (files)", "%1_files", filePath) + QLatin1Char('/'); // eg.: "/home/seb/foo.html_files/"
@@ -234,8 +263,10 @@ void HTMLExporter::exportBasket(BasketScene *basket, bool isSubBasket)
 
     // Open the file to write:
     QFile file(basketFilePath);
-    if (!file.open(QIODevice::WriteOnly))
+    if (!file.open(QIODevice::WriteOnly)) {
+        succeeded = false;
         return;
+    }
     stream.setDevice(&file);
 
     // Output the header:
@@ -409,17 +440,17 @@ void HTMLExporter::exportBasket(BasketScene *basket, bool isSubBasket)
     stream << " </body>\n"
               "</html>\n";
 
+    stream.flush();
+    if (stream.status() != QTextStream::Ok || !file.flush())
+        succeeded = false;
     file.close();
     stream.setDevice(nullptr);
     dialog->setValue(dialog->value() + 1); // Basket exportation finished
 
     // Recursively export child baskets:
-    BasketListViewItem *item = Global::bnpView->listViewItemForBasket(basket);
-    if (item->childCount() >= 0) {
-        for (int i = 0; i < item->childCount(); i++) {
-            exportBasket(((BasketListViewItem *)item->child(i))->basket(), /*isSubBasket=*/true);
-        }
-    }
+    const QList<BasketScene *> children = subBasketsOf(basket);
+    for (BasketScene *child : children)
+        exportBasket(child, /*isSubBasket=*/true);
 }
 
 void HTMLExporter::exportNote(Note *note, int indent)
@@ -557,11 +588,11 @@ void HTMLExporter::writeBasketTree(BasketScene *currentBasket, BasketScene *bask
            << "</span></a>";
 
     // Write the sub-baskets lines & end the current one:
-    BasketListViewItem *item = Global::bnpView->listViewItemForBasket(basket);
-    if (item->childCount() >= 0) {
+    const QList<BasketScene *> children = subBasketsOf(basket);
+    if (children.count() >= 0) {
         stream << "\n" << spaces.fill(QLatin1Char(' '), indent) << " <ul>\n";
-        for (int i = 0; i < item->childCount(); i++)
-            writeBasketTree(currentBasket, ((BasketListViewItem *)item->child(i))->basket(), indent + 2);
+        for (BasketScene *child : children)
+            writeBasketTree(currentBasket, child, indent + 2);
         stream << spaces.fill(QLatin1Char(' '), indent) << " </ul>\n" << spaces.fill(QLatin1Char(' '), indent) << "</li>\n";
     } else {
         stream << "</li>\n";
@@ -569,8 +600,7 @@ void HTMLExporter::writeBasketTree(BasketScene *currentBasket, BasketScene *bask
 }
 
 /** Save an icon to a folder.
- * If an icon with the same name already exist in the destination,
- * it is assumed the icon is already copied, so no action is took.
+ * Icons already saved during this export are remembered, so they are neither rendered again nor looked up on disk.
  * It is optimized so that you can have an empty folder receiving the icons
  * and call copyIcon() each time you encounter one during export process.
  */
@@ -580,6 +610,12 @@ QString HTMLExporter::copyIcon(const QString &iconName, int size)
         return {};
     }
 
+    QString key = QString::number(size) + QLatin1Char('/') + iconName;
+    QHash<QString, QString>::const_iterator copied = copiedIcons.constFind(key);
+    if (copied != copiedIcons.constEnd()) {
+        return copied.value();
+    }
+
     // Sometimes icon can be "favicons/www.kde.org", we replace the '/' with a '_'
     QString fileName = iconName; // QString::replace() isn't const, so I must copy the string before
     fileName = QStringLiteral("ico") + QString::number(size) + QLatin1Char('_') + fileName.replace(QLatin1Char('/'), QLatin1Char('_')) + QStringLiteral(".png");
@@ -587,32 +623,20 @@ QString HTMLExporter::copyIcon(const QString &iconName, int size)
     if (!QFile::exists(fullPath)) {
         KIconLoader::global()->loadIcon(iconName, KIconLoader::Desktop, size).save(fullPath, "PNG");
     }
+    copiedIcons.insert(key, fileName);
     return fileName;
 }
 
-/** Done: Sometimes we can call two times copyFile() with the same srcPath and dataFolderPath
- *       (eg. when exporting basket to HTML with two links to same filename
- *            (but not necesary same path, as in "/home/foo.txt" and "/foo.txt") )
- *       The first copy isn't yet started, so the dest file isn't created and this method
- *       returns the same filename !!!!!!!!!!!!!!!!!!!!
+/** Copy a file to the data folder of the basket being exported, and return its name in that folder.
+ * The copy is done synchronously, so the file is complete once the export finishes.
+ * Files with the same content and extension (eg. the same image in two notes) are only copied once per data folder.
  */
 QString HTMLExporter::copyFile(const QString &srcPath, bool createIt)
 {
     QString fileName = Tools::fileNameForNewFile(QUrl::fromLocalFile(srcPath).fileName(), dataFolderPath);
     QString fullPath = dataFolderPath + fileName;
 
-    if (!currentBasket->isEncrypted()) {
-        if (createIt) {
-            // We create the file to be sure another very near call to copyFile() willn't choose the same name:
-            QFile file(QUrl::fromLocalFile(fullPath).path());
-            if (file.open(QIODevice::WriteOnly))
-                file.close();
-            // And then we copy the file AND overwriting the file we just created:
-            KIO::file_copy(QUrl::fromLocalFile(srcPath), QUrl::fromLocalFile(fullPath), 0666, KIO::HideProgressInfo | KIO::Resume | KIO::Overwrite);
-        } else {
-            /*KIO::CopyJob *copyJob = */ KIO::copy(QUrl::fromLocalFile(srcPath), QUrl::fromLocalFile(fullPath), KIO::DefaultFlags); // Do it as before
-        }
-    } else {
+    if (currentBasket->isEncrypted()) {
         QByteArray array;
         bool success = FileStorage::loadFromFile(srcPath, &array);
 
@@ -621,8 +645,45 @@ QString HTMLExporter::copyFile(const QString &srcPath, bool createIt)
         } else {
             qDebug() << "Unable to load encrypted file " << srcPath;
         }
+        return fileName;
     }
 
+    QFile source(srcPath);
+    if (!createIt || !QFileInfo(srcPath).isFile() || !source.open(QIODevice::ReadOnly)) {
+        // Folders (or unreadable files):
+        if (!Tools::copyRecursively(srcPath, fullPath))
+            qDebug() << "Unable to copy " << srcPath << " to " << fullPath;
+        return fileName;
+    }
+
+    // Hash the file while copying it, so it is only read once, and drop the copy if the same file was already copied:
+    QSaveFile destination(fullPath);
+    if (!destination.open(QIODevice::WriteOnly)) {
+        qDebug() << "Unable to open file for writing: " << fullPath;
+        return fileName;
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    QByteArray buffer(64 * 1024, Qt::Uninitialized);
+    qint64 read;
+    while ((read = source.read(buffer.data(), buffer.size())) > 0) {
+        const QByteArrayView chunk(buffer.constData(), read);
+        hash.addData(chunk);
+        destination.write(chunk.data(), chunk.size());
+    }
+
+    const QString key = dataFolderPath + QString::fromLatin1(hash.result().toHex()) + QLatin1Char('.') + QFileInfo(srcPath).suffix();
+    QHash<QString, QString>::const_iterator copied = copiedFiles.constFind(key);
+    if (copied != copiedFiles.constEnd()) {
+        destination.cancelWriting();
+        FileNameAllocator::release(fullPath); // The name was reserved for nothing
+        return copied.value();
+    }
+
+    if (read < 0 || !destination.commit()) {
+        qDebug() << "Unable to copy file " << srcPath << " to " << fullPath;
+        return fileName;
+    }
+    copiedFiles.insert(key, fileName);
     return fileName;
 }
 
@@ -630,7 +691,7 @@ void HTMLExporter::saveToFile(const QString &fullPath, const QByteArray &array)
 {
     QFile file(QUrl::fromLocalFile(fullPath).path());
     if (file.open(QIODevice::WriteOnly)) {
-        file.write(array.toStdString().c_str(), array.size());
+        file.write(array);
         file.close();
     } else {
         qDebug() << "Unable to open file for writing: " << fullPath;
@@ -7,10 +7,14 @@
 #ifndef HTMLEXPORTER_H
 #define HTMLEXPORTER_H
 
+#include <QHash>
+#include <QList>
 #include <QScopedPointer>
 #include <QString>
 #include <QTextStream>
 
+#include "basket_export.h"
+
 class QProgressDialog;
 
 class BasketScene;
@@ -19,13 +23,19 @@ class Note;
 /**
  * @author Sébastien Laoût <slaout@linux62.org>
  */
-class HTMLExporter
+class BASKET_EXPORT HTMLExporter
 {
 public:
     explicit HTMLExporter(BasketScene *basket);
+    /** Export @p basket and its sub-baskets to @p destination without asking anything nor showing the progress, eg. from basketbatch.
+     * Without BNPView, the sub-baskets of each basket are given by @p subBaskets.
+     */
+    HTMLExporter(BasketScene *basket, const QString &destination, const QHash<BasketScene *, QList<BasketScene *>> &subBaskets = {});
     ~HTMLExporter();
 
 private:
+    QList<BasketScene *> subBasketsOf(BasketScene *basket) const;
+    int basketCount(BasketScene *basket) const;
     void prepareExport(BasketScene *basket, const QString &fullPath);
     void exportBasket(BasketScene *basket, bool isSubBasket);
     void exportNote(Note *note, int indent);
@@ -63,7 +73,13 @@ public: // TODO: make private?
     BasketScene *exportedBasket;
     BasketScene *currentBasket;
     bool withBasketTree;
+    bool succeeded = true; // false if a page of the export could not be written
     QScopedPointer<QProgressDialog> dialog;
+    QHash<BasketScene *, QList<BasketScene *>> subBaskets; // Only used without BNPView
+
+    // Assets already written during this export, so identical ones are only written once:
+    QHash<QString, QString> copiedIcons; // eg.: "16/basket" => "ico16_basket.png"
+    QHash<QString, QString> copiedFiles; // eg.: dataFolderPath + content hash => "image.png"
 };
 
 #endif // HTMLEXPORTER_H
@@ -12,7 +12,10 @@
 #include "global.h"
 #include "kgpgme.h"
 
+#include <QBuffer>
+#include <QCryptographicHash>
 #include <QDialogButtonBox>
+#include <QIODevice>
 #include <QLabel>
 #include <QPixmap>
 #include <QPointer>
@@ -149,6 +152,9 @@ void KGpgMe::clearCache()
         m_cache.fill(QLatin1Char('\0'));
         m_cache.truncate(0);
     }
+    for (QByteArray &sessionKey : m_sessionKeys)
+        sessionKey.fill('\0');
+    m_sessionKeys.clear();
 }
 
 void KGpgMe::init(gpgme_protocol_t proto)
@@ -261,19 +267,71 @@ KGpgKeyList KGpgMe::keys(bool privateKeys /* = false */) const
     return keys;
 }
 
+// gpgme data callbacks reading from and writing to a QIODevice, so the content is streamed instead of copied in memory:
+static ssize_t deviceRead(void *handle, void *buffer, size_t size)
+{
+    qint64 read = static_cast<QIODevice *>(handle)->read(static_cast<char *>(buffer), size);
+    if (read < 0) {
+        errno = EIO;
+        return -1;
+    }
+    return read;
+}
+
+static ssize_t deviceWrite(void *handle, const void *buffer, size_t size)
+{
+    qint64 written = static_cast<QIODevice *>(handle)->write(static_cast<const char *>(buffer), size);
+    if (written < 0) {
+        errno = EIO;
+        return -1;
+    }
+    return written;
+}
+
+static off_t deviceSeek(void *handle, off_t offset, int whence)
+{
+    auto *device = static_cast<QIODevice *>(handle);
+    if (device->isSequential()) {
+        errno = ESPIPE;
+        return -1;
+    }
+    qint64 position = offset;
+    if (whence == SEEK_CUR)
+        position += device->pos();
+    else if (whence == SEEK_END)
+        position += device->size();
+    if (!device->seek(position)) {
+        errno = EINVAL;
+        return -1;
+    }
+    return position;
+}
+
+static gpgme_data_cbs deviceCallbacks = {deviceRead, deviceWrite, deviceSeek, nullptr};
+
 bool KGpgMe::encrypt(const QByteArray &inBuffer, unsigned long length, QByteArray *outBuffer, QString keyid /* = QString() */)
+{
+    QBuffer in;
+    in.setData(QByteArray::fromRawData(inBuffer.constData(), qMin<qsizetype>(length, inBuffer.size())));
+    in.open(QIODevice::ReadOnly);
+    outBuffer->resize(0);
+    QBuffer out(outBuffer);
+    out.open(QIODevice::WriteOnly);
+    return encrypt(&in, &out, keyid);
+}
+
+bool KGpgMe::encrypt(QIODevice *in, QIODevice *out, const QString &keyid)
 {
     gpgme_error_t err = 0;
-    gpgme_data_t in = nullptr, out = nullptr;
+    gpgme_data_t inData = nullptr, outData = nullptr;
     gpgme_key_t keys[2] = {NULL, NULL};
     gpgme_key_t *key = NULL;
     gpgme_encrypt_result_t result = nullptr;
 
-    outBuffer->resize(0);
     if (m_ctx) {
-        err = gpgme_data_new_from_mem(&in, inBuffer.data(), length, 1);
+        err = gpgme_data_new_from_cbs(&inData, &deviceCallbacks, in);
         if (!err) {
-            err = gpgme_data_new(&out);
+            err = gpgme_data_new_from_cbs(&outData, &deviceCallbacks, out);
             if (!err) {
                 if (keyid.isNull()) {
                     key = NULL;
@@ -283,7 +341,7 @@ bool KGpgMe::encrypt(const QByteArray &inBuffer, unsigned long length, QByteArra
                 }
 
                 if (!err) {
-                    err = gpgme_op_encrypt(m_ctx, key, GPGME_ENCRYPT_ALWAYS_TRUST, in, out);
+                    err = gpgme_op_encrypt(m_ctx, key, GPGME_ENCRYPT_ALWAYS_TRUST, inData, outData);
                     if (!err) {
                         result = gpgme_op_encrypt_result(m_ctx);
                         if (result->invalid_recipients) {
@@ -291,8 +349,6 @@ bool KGpgMe::encrypt(const QByteArray &inBuffer, unsigned long length, QByteArra
                                                QStringLiteral("%1: %2")
                                                    .arg(i18n("That public key is not meant for encryption"))
                                                    .arg(QString::fromLatin1(result->invalid_recipients->fpr)));
-                        } else {
-                            err = readToBuffer(out, outBuffer);
                         }
                     }
                 }
@@ -309,78 +365,99 @@ bool KGpgMe::encrypt(const QByteArray &inBuffer, unsigned long length, QByteArra
     }
     if (keys[0])
         gpgme_key_unref(keys[0]);
-    if (in)
-        gpgme_data_release(in);
-    if (out)
-        gpgme_data_release(out);
+    if (inData)
+        gpgme_data_release(inData);
+    if (outData)
+        gpgme_data_release(outData);
     return (err == GPG_ERR_NO_ERROR);
 }
 
 bool KGpgMe::decrypt(const QByteArray &inBuffer, QByteArray *outBuffer)
+{
+    // Every encrypted file has its own session key: remember them,
+    // so decrypting the same content again (eg. when reloading a basket) does not need a public-key operation:
+    const QByteArray contentHash = QCryptographicHash::hash(inBuffer, QCryptographicHash::Sha256);
+    QByteArray sessionKey = m_sessionKeys.value(contentHash);
+
+    QBuffer in;
+    in.setData(inBuffer);
+    in.open(QIODevice::ReadOnly);
+    outBuffer->resize(0);
+    QBuffer out(outBuffer);
+    out.open(QIODevice::WriteOnly);
+
+    bool success = false;
+    if (!sessionKey.isEmpty()) {
+        success = decrypt(&in, &out, &sessionKey);
+        if (!success) {
+            // The remembered session key did not work: forget it, and start the full decryption from an empty output:
+            m_sessionKeys.remove(contentHash);
+            sessionKey.clear();
+            outBuffer->resize(0);
+            in.seek(0);
+            out.seek(0);
+        }
+    }
+    if (!success)
+        success = decrypt(&in, &out, &sessionKey);
+    if (success && !sessionKey.isEmpty())
+        m_sessionKeys.insert(contentHash, sessionKey);
+    return success;
+}
+
+bool KGpgMe::decrypt(QIODevice *in, QIODevice *out, QByteArray *sessionKey)
 {
     gpgme_error_t err = 0;
-    gpgme_data_t in = nullptr, out = nullptr;
+    gpgme_data_t inData = nullptr, outData = nullptr;
     gpgme_decrypt_result_t result = nullptr;
+    bool withKnownSessionKey = (sessionKey && !sessionKey->isEmpty());
 
-    outBuffer->resize(0);
     if (m_ctx) {
-        err = gpgme_data_new_from_mem(&in, inBuffer.data(), inBuffer.size(), 1);
+        if (withKnownSessionKey)
+            gpgme_set_ctx_flag(m_ctx, "override-session-key", sessionKey->constData());
+        else if (sessionKey)
+            gpgme_set_ctx_flag(m_ctx, "export-session-key", "1");
+
+        err = gpgme_data_new_from_cbs(&inData, &deviceCallbacks, in);
         if (!err) {
-            err = gpgme_data_new(&out);
+            err = gpgme_data_new_from_cbs(&outData, &deviceCallbacks, out);
             if (!err) {
-                err = gpgme_op_decrypt(m_ctx, in, out);
+                err = gpgme_op_decrypt(m_ctx, inData, outData);
                 if (!err) {
                     result = gpgme_op_decrypt_result(m_ctx);
                     if (result->unsupported_algorithm) {
                         KMessageBox::error(qApp->activeWindow(),
                                            QStringLiteral("%1: %2").arg(i18n("Unsupported algorithm")).arg(QString::fromLatin1(result->unsupported_algorithm)));
-                    } else {
-                        err = readToBuffer(out, outBuffer);
+                    } else if (sessionKey && !withKnownSessionKey && result->session_key) {
+                        *sessionKey = QByteArray(result->session_key);
                     }
                 }
             }
         }
+
+        if (withKnownSessionKey)
+            gpgme_set_ctx_flag(m_ctx, "override-session-key", "");
+        else if (sessionKey)
+            gpgme_set_ctx_flag(m_ctx, "export-session-key", "0");
     }
+    if (inData)
+        gpgme_data_release(inData);
+    if (outData)
+        gpgme_data_release(outData);
+
+    // A remembered session key that does not work is not an error: the caller does the full decryption
+    if (err != GPG_ERR_NO_ERROR && withKnownSessionKey)
+        return false;
+
     if (err != GPG_ERR_NO_ERROR && err != GPG_ERR_CANCELED) {
         KMessageBox::error(qApp->activeWindow(),
                            QStringLiteral("%1: %2").arg(QString::fromLatin1(gpgme_strsource(err))).arg(QString::fromLatin1(gpgme_strerror(err))));
     }
     if (err != GPG_ERR_NO_ERROR)
         clearCache();
-    if (in)
-        gpgme_data_release(in);
-    if (out)
-        gpgme_data_release(out);
     return (err == GPG_ERR_NO_ERROR);
 }
 
-#define BUF_SIZE (32 * 1024)
-
-gpgme_error_t KGpgMe::readToBuffer(gpgme_data_t in, QByteArray *outBuffer) const
-{
-    int ret;
-    gpgme_error_t err = GPG_ERR_NO_ERROR;
-
-    ret = gpgme_data_seek(in, 0, SEEK_SET);
-    if (ret) {
-        err = gpgme_err_code_from_errno(errno);
-    } else {
-        char *buf = new char[BUF_SIZE + 2];
-
-        if (buf) {
-            while ((ret = gpgme_data_read(in, buf, BUF_SIZE)) > 0) {
-                uint size = outBuffer->size();
-                outBuffer->resize(size + ret);
-                memcpy(outBuffer->data() + size, buf, ret);
-            }
-            if (ret < 0)
-                err = gpgme_err_code_from_errno(errno);
-            delete[] buf;
-        }
-    }
-    return err;
-}
-
 bool KGpgMe::isGnuPGAgentAvailable()
 {
     QString agent_info = QString::fromLatin1(qgetenv("GPG_AGENT_INFO"));
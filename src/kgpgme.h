@@ -12,9 +12,15 @@
 
 #include <gpgme.h>
 
+#include <QByteArray>
+#include <QHash>
 #include <QList>
 #include <QString>
 
+#include "basket_export.h"
+
+class QIODevice;
+
 /**
     @author Petri Damsten <damu@iki.fi>
 */
@@ -29,7 +35,7 @@ public:
 
 using KGpgKeyList = QList<KGpgKey>;
 
-class KGpgMe
+class BASKET_EXPORT KGpgMe
 {
 public:
     KGpgMe();
@@ -69,9 +75,16 @@ private:
     bool m_saving;
     bool m_useGnuPGAgent;
     QString m_cache;
+    /** Hash of an encrypted content => its session key, to decrypt it again without a public-key operation.
+     * Only kept in memory, and cleared with the passphrase when the basket is locked: the first decryption of every file
+     * after opening or unlocking a basket is still a full one. Only reloads within the same unlocked session benefit.
+     */
+    QHash<QByteArray, QByteArray> m_sessionKeys;
 
     void init(gpgme_protocol_t proto);
-    gpgme_error_t readToBuffer(gpgme_data_t in, QByteArray *outBuffer) const;
+    /// Stream the data from @p in to @p out, without copying it in a gpgme buffer:
+    bool encrypt(QIODevice *in, QIODevice *out, const QString &keyid);
+    bool decrypt(QIODevice *in, QIODevice *out, QByteArray *sessionKey);
     void setPassphraseCb();
     static gpgme_error_t passphraseCb(void *hook, const char *uid_hint, const char *passphrase_info, int last_was_bad, int fd);
     gpgme_error_t passphrase(const char *uid_hint, const char *passphrase_info, int last_was_bad, int fd);
@@ -221,7 +221,7 @@ NewBasketDialog::NewBasketDialog(BasketScene *parentBasket, const NewBasketDefau
 
     m_basketsMap.clear();
     int index;
-    m_basketsMap.insert(/*index=*/0, /*basket=*/nullptr);
+    m_basketsMap.insert(/*index=*/0, /*item=*/nullptr);
     index = 1;
     for (int i = 0; i < Global::bnpView->topLevelItemCount(); i++) {
         index = populateBasketsList(Global::bnpView->topLevelItem(i), /*indent=*/1, /*index=*/index);
@@ -245,8 +245,8 @@ NewBasketDialog::NewBasketDialog(BasketScene *parentBasket, const NewBasketDefau
     if (parentBasket) {
         int index = 0;
 
-        for (QMap<int, BasketScene *>::Iterator it = m_basketsMap.begin(); it != m_basketsMap.end(); ++it) {
-            if (it.value() == parentBasket) {
+        for (QMap<int, BasketListViewItem *>::Iterator it = m_basketsMap.begin(); it != m_basketsMap.end(); ++it) {
+            if (it.value() && it.value()->basketIfCreated() == parentBasket) {
                 index = it.key();
                 break;
             }
@@ -270,9 +270,9 @@ void NewBasketDialog::returnPressed()
 int NewBasketDialog::populateBasketsList(QTreeWidgetItem *item, int indent, int index)
 {
     static const int ICON_SIZE = 16;
-    // Get the basket data:
-    BasketScene *basket = ((BasketListViewItem *)item)->basket();
-    QPixmap icon = KIconLoader::global()->loadIcon(basket->icon(),
+    // Get the basket data (without creating the basket):
+    auto *basketItem = (BasketListViewItem *)item;
+    QPixmap icon = KIconLoader::global()->loadIcon(basketItem->basketIcon(),
                                                    KIconLoader::NoGroup,
                                                    ICON_SIZE,
                                                    KIconLoader::DefaultState,
@@ -280,8 +280,8 @@ int NewBasketDialog::populateBasketsList(QTreeWidgetItem *item, int indent, int
                                                    nullptr,
                                                    /*canReturnNull=*/false);
     icon = Tools::indentPixmap(icon, indent, 2 * ICON_SIZE / 3);
-    m_createIn->addItem(icon, basket->basketName());
-    m_basketsMap.insert(index, basket);
+    m_createIn->addItem(icon, basketItem->basketName());
+    m_basketsMap.insert(index, basketItem);
     ++index;
 
     for (int i = 0; i < item->childCount(); i++) {
@@ -331,9 +331,10 @@ void NewBasketDialog::slotOk()
         textColor = m_defaultProperties.textColor;
     }
 
+    BasketListViewItem *parentItem = m_basketsMap[m_createIn->currentIndex()];
     BasketFactory::newBasket(m_icon->icon(),
                              m_name->text(),
-                             m_basketsMap[m_createIn->currentIndex()],
+                             parentItem ? parentItem->basket() : nullptr,
                              backgroundImage,
                              m_backgroundColor->color(),
                              textColor,
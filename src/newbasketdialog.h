@@ -19,6 +19,7 @@ class KComboBox;
 class QTreeWidgetItem;
 
 class BasketScene;
+class BasketListViewItem;
 
 class KColorCombo2;
 
@@ -85,7 +86,7 @@ private:
     KColorCombo2 *m_backgroundColor;
     QListWidget *m_templates;
     KComboBox *m_createIn;
-    QMap<int, BasketScene *> m_basketsMap;
+    QMap<int, BasketListViewItem *> m_basketsMap;
     QPushButton *okButton;
 };
 
@@ -31,11 +31,13 @@
 #include "common.h"
 #include "debugwindow.h"
 #include "filter.h"
+#include "notedrag.h"
 #include "notefactory.h" // For NoteFactory::filteredURL()
 #include "noteselection.h"
 #include "settings.h"
 #include "tag.h"
 #include "tools.h"
+#include "tracing.h"
 
 /** class Note: */
 
@@ -87,38 +89,33 @@ Note::Note(BasketScene *parent)
     , m_hoveredZone(Note::None)
     , m_focused(false)
     , m_selected(false)
+    , m_countSelectedDescendants(0)
     , m_wasInLastSelectionRect(false)
     , m_computedState()
     , m_emblemsCount(0)
     , m_haveInvisibleTags(false)
+    , m_materialized(true)
     , m_matching(true)
 {
     m_target_x = x();
     m_target_y = y();
-    m_animX = new NoteAnimation(this, "x");
-    m_animY = new NoteAnimation(this, "y");
-    // m_animX->setEasingCurve(QEasingCurve::InOutQuad);
-    // m_animY->setEasingCurve(QEasingCurve::InOutQuad);
-
-    connect(m_animX, &NoteAnimation::valueChanged, this, &Note::xAnimated);
-    connect(m_animY, &NoteAnimation::valueChanged, this, &Note::yAnimated);
 
     setHeight(MIN_HEIGHT);
     if (m_basket) {
         m_basket->addItem(this);
-        m_basket->addAnimation(m_animX);
-        m_basket->addAnimation(m_animY);
     }
 }
 
 Note::~Note()
 {
+    NoteDrag::noteAboutToChange(this); // The copied flavours must be computed while the note is complete
     if (m_basket) {
-        if (m_content && m_content->graphicsItem()) {
+        if (m_selected)
+            m_basket->removeSelectedNote(this);
+        if (m_content && m_content->graphicsItem() && m_content->graphicsItem()->scene() == m_basket) {
             m_basket->removeItem(m_content->graphicsItem());
         }
-        m_basket->removeAnimation(m_animX);
-        m_basket->removeAnimation(m_animY);
+        m_basket->animations()->stop(this);
         m_basket->removeItem(this);
     }
     delete m_content;
@@ -354,15 +351,32 @@ void Note::setSelected(bool selected)
     }
 
     if (selected)
-        basket()->addSelectedNote();
+        basket()->addSelectedNote(this);
     else
-        basket()->removeSelectedNote();
+        basket()->removeSelectedNote(this);
 
     m_selected = selected;
+    for (Note *parent = m_parentNote; parent; parent = parent->m_parentNote)
+        parent->m_countSelectedDescendants += (selected ? 1 : -1);
+
     unbufferize();
     update();
 }
 
+void Note::setParentNote(Note *note)
+{
+    // Move the selected notes of this branch from the old ancestors' counts to the new ones:
+    const int countSelected = (m_selected ? 1 : 0) + m_countSelectedDescendants;
+    if (countSelected > 0) {
+        for (Note *parent = m_parentNote; parent; parent = parent->m_parentNote)
+            parent->m_countSelectedDescendants -= countSelected;
+        for (Note *parent = note; parent; parent = parent->m_parentNote)
+            parent->m_countSelectedDescendants += countSelected;
+    }
+
+    m_parentNote = note;
+}
+
 void Note::resetWasInLastSelectionRect()
 {
     m_wasInLastSelectionRect = false;
@@ -373,14 +387,18 @@ void Note::resetWasInLastSelectionRect()
     }
 }
 
-void Note::finishLazyLoad()
+void Note::finishLazyLoad(QList<HtmlContent *> *htmlContents /*= nullptr*/)
 {
-    if (content())
-        content()->finishLazyLoad();
+    if (content()) {
+        if (htmlContents && content()->type() == NoteType::Html)
+            htmlContents->append(static_cast<HtmlContent *>(content()));
+        else
+            content()->finishLazyLoad();
+    }
 
     FOR_EACH_CHILD(child)
     {
-        child->finishLazyLoad();
+        child->finishLazyLoad(htmlContents);
     }
 }
 
@@ -408,17 +426,6 @@ void Note::selectIn(const QRectF &rect, bool invertSelection, bool unselectOther
 
     setSelected(toSelect);
     m_wasInLastSelectionRect = intersects;
-
-    Note *child = firstChild();
-    bool first = true;
-    while (child) {
-        if ((showSubNotes() || first) && child->matching())
-            child->selectIn(rect, invertSelection, unselectOthers);
-        else
-            child->setSelectedRecursively(false);
-        child = child->next();
-        first = false;
-    }
 }
 
 bool Note::allSelected()
@@ -460,44 +467,11 @@ void Note::invertSelectionRecursively()
     }
 }
 
-void Note::unselectAllBut(Note *toSelect)
-{
-    if (this == toSelect)
-        setSelectedRecursively(true);
-    else {
-        setSelected(false);
-
-        Note *child = firstChild();
-        bool first = true;
-        while (child) {
-            if ((showSubNotes() || first) && child->matching())
-                child->unselectAllBut(toSelect);
-            else
-                child->setSelectedRecursively(false);
-            child = child->next();
-            first = false;
-        }
-    }
-}
-
-void Note::invertSelectionOf(Note *toSelect)
-{
-    if (this == toSelect)
-        setSelectedRecursively(!isSelected());
-    else {
-        Note *child = firstChild();
-        bool first = true;
-        while (child) {
-            if ((showSubNotes() || first) && child->matching())
-                child->invertSelectionOf(toSelect);
-            child = child->next();
-            first = false;
-        }
-    }
-}
-
 Note *Note::theSelectedNote()
 {
+    if (!hasSelection())
+        return nullptr;
+
     if (!isGroup() && isSelected())
         return this;
 
@@ -515,6 +489,9 @@ Note *Note::theSelectedNote()
 
 NoteSelection *Note::selectedNotes()
 {
+    if (!hasSelection())
+        return nullptr;
+
     if (content()) {
         if (isSelected())
             return new NoteSelection(this);
@@ -1185,25 +1162,25 @@ void Note::relayoutAt(QPointF pos, bool animate)
 
 void Note::setX(qreal x, bool animate)
 {
+    m_target_x = x;
     if (!animate || !isAnimated()) {
+        if (m_basket)
+            m_basket->animations()->stopX(this);
         QGraphicsItemGroup::setX(x);
     } else {
-        qDebug() << "Note::setX: " << x << " : " << animate;
-        m_target_x = x;
-        m_animX->setEndValue(x);
-        m_animX->start();
+        m_basket->animations()->animateX(this, x);
     }
 }
 
 void Note::setY(qreal y, bool animate)
 {
+    m_target_y = y;
     if (!animate || !isAnimated()) {
+        if (m_basket)
+            m_basket->animations()->stopY(this);
         QGraphicsItemGroup::setY(y);
     } else {
-        qDebug() << "Note::setY: " << y << " : " << animate;
-        m_target_y = y;
-        m_animY->setEndValue(y);
-        m_animY->start();
+        m_basket->animations()->animateY(this, y);
     }
 }
 
@@ -1231,16 +1208,6 @@ void Note::setYRecursively(qreal y, bool animate)
     qDebug() << "Yrecursive done";
 }
 
-void Note::xAnimated(const QVariant &x)
-{
-    return;
-}
-
-void Note::yAnimated(const QVariant &y)
-{
-    return;
-}
-
 void Note::hideRecursively()
 {
     hide();
@@ -1691,6 +1658,7 @@ bool Note::isEditing()
 
 void Note::draw(QPainter *painter, const QRectF & /*clipRect*/)
 {
+    BASKET_TRACE("Note::draw");
     if (!matching())
         return;
 
@@ -1711,7 +1679,10 @@ void Note::draw(QPainter *painter, const QRectF & /*clipRect*/)
         return;
 
     /** Initialise buffer painter: */
-    m_bufferedPixmap = QPixmap(width(), height());
+    // At the screen device pixel ratio, so the background tiles are copied without being rescaled:
+    const qreal ratio = qApp->devicePixelRatio();
+    m_bufferedPixmap = QPixmap(QSizeF(width() * ratio, height() * ratio).toSize());
+    m_bufferedPixmap.setDevicePixelRatio(ratio);
     Q_ASSERT(!m_bufferedPixmap.isNull());
     QPainter painter2(&m_bufferedPixmap);
 
@@ -1774,9 +1745,9 @@ void Note::draw(QPainter *painter, const QRectF & /*clipRect*/)
     }
 
     if (!hovered && !isSelected()) {
-        // Draw background:
+        // Draw background (the opaque tile of the basket already has its color: no need to blend the image on it again):
         painter2.fillRect(0, 0, width(), height(), background);
-        basket()->blendBackground(painter2, boundingRect().translated(x(), y()));
+        basket()->blendBackground(painter2, boundingRect().translated(x(), y()), -1, -1, /*opaque=*/background == basket()->backgroundColor());
     } else {
         // Draw selection background:
         painter2.fillRect(0, 0, width(), height(), midColor);
@@ -1843,6 +1814,9 @@ void Note::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*option*/,
     if (boundingRect().width() <= 0.1 || boundingRect().height() <= 0.1)
         return;
 
+    if (m_content)
+        m_content->aboutToBeShown();
+
     draw(painter, boundingRect());
 
     if (hasResizer()) {
@@ -1879,13 +1853,40 @@ void Note::drawBufferOnScreen(QPainter *painter, const QPixmap &contentPixmap)
         if (rect.x() >= width()) // It's a rect of the resizer, don't draw it!
             continue;
 
-        painter->drawPixmap(rect.x(), rect.y(), contentPixmap, rect.x(), rect.y(), rect.width(), rect.height());
+        const qreal ratio = contentPixmap.devicePixelRatio();
+        painter->drawPixmap(rect, contentPixmap, QRectF(rect.x() * ratio, rect.y() * ratio, rect.width() * ratio, rect.height() * ratio));
     }
 }
 
 void Note::setContent(NoteContent *content)
 {
     m_content = content;
+    m_materialized = true; // Content constructors add their item to the note
+}
+
+void Note::updateMaterialization(const QRectF &area)
+{
+    // Look at both the current and final positions, so notes being animated into the area are ready when they get there:
+    bool materialize = area.intersects(QRectF(x(), y(), width(), height())) || area.intersects(QRectF(targetX(), targetY(), width(), height()));
+
+    if (materialize != m_materialized && m_content && m_content->graphicsItem()) {
+        QGraphicsItem *item = m_content->graphicsItem();
+        if (materialize) {
+            addToGroup(item);
+            item->setPos(contentX(), NOTE_MARGIN);
+        } else {
+            removeFromGroup(item);
+            if (item->scene())
+                item->scene()->removeItem(item);
+            unbufferize();
+        }
+        m_materialized = materialize;
+    }
+
+    FOR_EACH_CHILD(child)
+    {
+        child->updateMaterialization(area);
+    }
 }
 
 /*const */ State::List &Note::states() const
@@ -1898,35 +1899,29 @@ void Note::addState(State *state, bool orReplace)
     if (!content())
         return;
 
+    // States are kept in the order of their tags in Tag::all.
+    // Use the cached tag positions to find where to insert the state, instead of browsing every existing tag:
     Tag *tag = state->parentTag();
+    int position = Tag::tagPosition(tag);
+    if (position < 0)
+        return;
+
     State::List::iterator itStates = m_states.begin();
-    // Browse all tags, see if the note has it, increment itSates if yes, and then insert the state at this position...
-    // For each existing tags:
-    for (Tag::List::iterator it = Tag::all.begin(); it != Tag::all.end(); ++it) {
-        // If the current tag isn't the one to assign or the current one on the note, go to the next tag:
-        if (*it != tag && itStates != m_states.end() && *it != (*itStates)->parentTag())
-            continue;
-        // We found the tag to insert:
-        if (*it == tag) {
-            // And the note already have the tag:
-            if (itStates != m_states.end() && *it == (*itStates)->parentTag()) {
-                // We replace the state if wanted:
-                if (orReplace) {
-                    itStates = m_states.insert(itStates, state);
-                    ++itStates;
-                    m_states.erase(itStates);
-                    recomputeStyle();
-                }
-            } else {
-                m_states.insert(itStates, state);
-                recomputeStyle();
-            }
-            return;
+    while (itStates != m_states.end() && Tag::tagPosition((*itStates)->parentTag()) < position)
+        ++itStates;
+
+    // The note already have the tag:
+    if (itStates != m_states.end() && (*itStates)->parentTag() == tag) {
+        // We replace the state if wanted:
+        if (orReplace && *itStates != state) {
+            *itStates = state;
+            statesChanged();
         }
-        // The note has this tag:
-        if (itStates != m_states.end() && *it == (*itStates)->parentTag())
-            ++itStates;
+        return;
     }
+
+    m_states.insert(itStates, state);
+    statesChanged();
 }
 
 QFont Note::font()
@@ -1950,18 +1945,28 @@ QColor Note::textColor()
         return basket()->textColor();
 }
 
-void Note::recomputeStyle()
+void Note::recomputeStyle(bool refreshContent /*= true*/)
 {
-    State::merge(m_states, &m_computedState, &m_emblemsCount, &m_haveInvisibleTags, basket()->backgroundColor());
+    State::mergeCached(m_states, &m_computedState, &m_emblemsCount, &m_haveInvisibleTags, basket()->backgroundColor());
     //  unsetWidth();
     if (content()) {
         if (content()->graphicsItem())
             content()->graphicsItem()->setPos(contentX(), NOTE_MARGIN);
-        content()->fontChanged();
+        if (refreshContent)
+            content()->fontChanged();
     }
     //  requestRelayout(); // TODO!
 }
 
+void Note::statesChanged()
+{
+    // During bulk tag changes, the basket restyles every modified note once, when committing them:
+    if (basket()->isChangingTags())
+        basket()->noteStatesChanged(this);
+    else
+        recomputeStyle();
+}
+
 void Note::recomputeAllStyles()
 {
     if (content()) // We do the merge ourself, without calling recomputeStyle(), so there is no infinite recursion:
@@ -2001,7 +2006,7 @@ void Note::removeState(State *state)
     for (State::List::iterator it = m_states.begin(); it != m_states.end(); ++it)
         if (*it == state) {
             m_states.erase(it);
-            recomputeStyle();
+            statesChanged();
             return;
         }
 }
@@ -2011,77 +2016,17 @@ void Note::removeTag(Tag *tag)
     for (State::List::iterator it = m_states.begin(); it != m_states.end(); ++it)
         if ((*it)->parentTag() == tag) {
             m_states.erase(it);
-            recomputeStyle();
+            statesChanged();
             return;
         }
 }
 
 void Note::removeAllTags()
 {
+    if (m_states.isEmpty())
+        return;
     m_states.clear();
-    recomputeStyle();
-}
-
-void Note::addTagToSelectedNotes(Tag *tag)
-{
-    if (content() && isSelected())
-        addTag(tag);
-
-    FOR_EACH_CHILD(child)
-    child->addTagToSelectedNotes(tag);
-}
-
-void Note::removeTagFromSelectedNotes(Tag *tag)
-{
-    if (content() && isSelected()) {
-        if (hasTag(tag))
-            setWidth(0);
-        removeTag(tag);
-    }
-
-    FOR_EACH_CHILD(child)
-    child->removeTagFromSelectedNotes(tag);
-}
-
-void Note::removeAllTagsFromSelectedNotes()
-{
-    if (content() && isSelected()) {
-        if (m_states.count() > 0)
-            setWidth(0);
-        removeAllTags();
-    }
-
-    FOR_EACH_CHILD(child)
-    child->removeAllTagsFromSelectedNotes();
-}
-
-void Note::addStateToSelectedNotes(State *state, bool orReplace)
-{
-    if (content() && isSelected())
-        addState(state, orReplace);
-
-    FOR_EACH_CHILD(child)
-    child->addStateToSelectedNotes(state, orReplace); // TODO: BasketScene::addStateToSelectedNotes() does not have orReplace
-}
-
-void Note::changeStateOfSelectedNotes(State *state)
-{
-    if (content() && isSelected() && hasTag(state->parentTag()))
-        addState(state);
-
-    FOR_EACH_CHILD(child)
-    child->changeStateOfSelectedNotes(state);
-}
-
-bool Note::selectedNotesHaveTags()
-{
-    if (content() && isSelected() && m_states.count() > 0)
-        return true;
-
-    FOR_EACH_CHILD(child)
-    if (child->selectedNotesHaveTags())
-        return true;
-    return false;
+    statesChanged();
 }
 
 bool Note::hasState(State *state)
@@ -2191,6 +2136,29 @@ void Note::unbufferizeAll()
     }
 }
 
+static qint64 pixmapBytes(const QPixmap &pixmap)
+{
+    return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+qint64 Note::bufferedBytes() const
+{
+    qint64 total = pixmapBytes(m_bufferedPixmap) + pixmapBytes(m_bufferedSelectionPixmap);
+    for (Note *child = m_firstChild; child; child = child->next())
+        total += child->bufferedBytes();
+    return total;
+}
+
+qint64 Note::memoryUsage() const
+{
+    qint64 total = sizeof(Note) + pixmapBytes(m_bufferedPixmap) + pixmapBytes(m_bufferedSelectionPixmap);
+    if (m_content)
+        total += m_content->memoryUsage();
+    for (Note *child = m_firstChild; child; child = child->next())
+        total += child->memoryUsage();
+    return total;
+}
+
 QRectF Note::visibleRect()
 {
     QList<QRectF> areas;
@@ -19,6 +19,7 @@
 class BasketScene;
 struct FilterData;
 
+class HtmlContent;
 class NoteContent;
 class NoteSelection;
 
@@ -83,10 +84,6 @@ Q_SIGNALS:
     void xChanged();
     void yChanged();
 
-private Q_SLOTS:
-    void xAnimated(const QVariant &x);
-    void yAnimated(const QVariant &y);
-
 public:
     void hideRecursively();
     qreal width() const;
@@ -144,10 +141,7 @@ public:
         return m_parentNote;
     }
     /*inline*/ bool showSubNotes(); //            { return !m_isFolded || !m_collapseFinished; }
-    inline void setParentNote(Note *note)
-    {
-        m_parentNote = note;
-    }
+    void setParentNote(Note *note);
     inline void setFirstChild(Note *note)
     {
         m_firstChild = note;
@@ -232,6 +226,8 @@ public:
     void drawResizer(QPainter *painter, qreal x, qreal y, qreal width, qreal height, const QColor &background, const QColor &foreground, bool rounded);
     void drawRoundings(QPainter *painter, qreal x, qreal y, int type, qreal width = 0, qreal height = 0);
     void unbufferizeAll();
+    qint64 bufferedBytes() const; ///< Memory used by the buffered pixmaps of this note and of its children
+    qint64 memoryUsage() const; ///< Approximate memory used by this note and its children: the notes, their contents and their buffered pixmaps
     inline void unbufferize()
     {
         m_bufferedPixmap = QPixmap();
@@ -262,10 +258,6 @@ public:
     bool isEditing();
 
     /// MANAGE ANIMATION:
-private:
-    NoteAnimation *m_animX;
-    NoteAnimation *m_animY;
-
 public:
     // bool initAnimationLoad(QTimeLine *timeLine);
     // void animationFinished();
@@ -318,6 +310,7 @@ public:
     void setSelected(bool selected);
     void setSelectedRecursively(bool selected);
     void invertSelectionRecursively();
+    /// Select or unselect this note only, depending on its visible areas intersecting @p rect: BasketScene::selectNotesIn() finds the notes to update
     void selectIn(const QRectF &rect, bool invertSelection, bool unselectOthers = true);
     void setFocused(bool focused);
     inline bool isFocused()
@@ -328,15 +321,19 @@ public:
     {
         return m_selected;
     }
+    /// @return true if this note or one of its descendants is selected, without walking the children
+    inline bool hasSelection()
+    {
+        return m_selected || m_countSelectedDescendants > 0;
+    }
     bool allSelected();
     void resetWasInLastSelectionRect();
-    void unselectAllBut(Note *toSelect);
-    void invertSelectionOf(Note *toSelect);
     Note *theSelectedNote();
 
 private:
     bool m_focused;
     bool m_selected;
+    int m_countSelectedDescendants; // Kept up to date by setSelected() and setParentNote(), so walks can skip unselected branches
     bool m_wasInLastSelectionRect;
 
     /// TAGS:
@@ -345,6 +342,7 @@ private:
     State m_computedState;
     int m_emblemsCount;
     bool m_haveInvisibleTags;
+    void statesChanged();
 
 public:
     /*const */ State::List &states() const;
@@ -357,19 +355,13 @@ public:
     void removeState(State *state);
     void removeTag(Tag *tag);
     void removeAllTags();
-    void addTagToSelectedNotes(Tag *tag);
-    void removeTagFromSelectedNotes(Tag *tag);
-    void removeAllTagsFromSelectedNotes();
-    void addStateToSelectedNotes(State *state, bool orReplace = true);
-    void changeStateOfSelectedNotes(State *state);
-    bool selectedNotesHaveTags();
     void inheritTagsOf(Note *note);
     bool hasTag(Tag *tag);
     bool hasState(State *state);
     State *stateOfTag(Tag *tag);
     State *stateForEmblemNumber(int number) const;
     bool stateForTagFromSelectedNotes(Tag *tag, State **state);
-    void recomputeStyle();
+    void recomputeStyle(bool refreshContent = true); /// << @p refreshContent is false when the font and text color are known to be unchanged
     void recomputeAllStyles();
     bool removedStates(const QList<State *> &deletedStates);
     QFont font(); // Computed!
@@ -377,6 +369,17 @@ public:
     QColor textColor(); // Computed!
     bool allowCrossReferences();
 
+    /// VIRTUALISATION:
+private:
+    bool m_materialized; ///< Whether the graphics item of the content is in the scene
+
+public:
+    void updateMaterialization(const QRectF &area); /// << Keep the content item in the scene only if the note intersects @p area (recursive)
+    bool isMaterialized() const
+    {
+        return m_materialized;
+    }
+
     /// FILTERING:
 private:
     bool m_matching;
@@ -432,7 +435,8 @@ public:
 
     /// SPEED OPTIMIZATION
 public:
-    void finishLazyLoad();
+    void finishLazyLoad(QList<HtmlContent *> *htmlContents = nullptr); /// << If @p htmlContents is given, HTML contents are appended to it instead of
+                                                                       /// being loaded, to be laid out together by HtmlContent::finishLazyLoad()
 
 public:
     // Values are provided here as info:
@@ -24,16 +24,15 @@
 #include <QMovie>
 #include <QPainter>
 #include <QPixmap>
-#include <QRegularExpression>
+#include <QPointer>
 #include <QStringList>
+#include <QThread>
 #include <QWidget>
-#include <QtNetwork/QNetworkReply>
+#include <QtConcurrent/QtConcurrentMap>
 #include <QtXml/QDomElement>
 
-#include <KEncodingProber>
 #include <KFileItem>
 #include <KFileMetaData/Extractor>
-#include <KIO/PreviewJob> //For KIO::file_preview(...)
 #include <KLocalizedString>
 #include <KService>
 
@@ -42,12 +41,15 @@
 #include "config.h"
 #include "debugwindow.h"
 #include "file_metadata.h"
+#include "filenameallocator.h"
 #include "filter.h"
 #include "global.h"
 #include "htmlexporter.h"
 #include "note.h"
 #include "notefactory.h"
+#include "previewcache.h"
 #include "settings.h"
+#include "titlefetcher.h"
 #include "tools.h"
 #include "xmlwork.h"
 
@@ -221,8 +223,11 @@ bool NoteContent::trySetFileName(const QString &fileName)
 {
     if (useFile() && fileName != m_fileName) {
         QString newFileName = Tools::fileNameForNewFile(fileName, basket()->fullPath());
+        const QString oldPath = fullPath();
+        const QString newPath = basket()->fullPathForFileName(newFileName);
         QDir dir;
-        dir.rename(fullPath(), basket()->fullPathForFileName(newFileName));
+        // Hand out again the name that is not used anymore, eg. to rename the file back:
+        FileNameAllocator::release(dir.rename(oldPath, newPath) ? oldPath : newPath);
         return true;
     }
 
@@ -324,7 +329,7 @@ QString TextContent::toHtml(const QString & /*imageName*/, const QString & /*cut
 QString HtmlContent::toHtml(const QString & /*imageName*/, const QString & /*cuttedFullPath*/)
 {
     // extract HTML content exactly as is, with no further processing applied
-    return m_graphicsTextItem.document()->toHtml();
+    return document()->toHtml();
 }
 
 QString ImageContent::toHtml(const QString & /*imageName*/, const QString &cuttedFullPath)
@@ -381,6 +386,26 @@ QPixmap AnimationContent::toPixmap()
     return m_movie->currentPixmap();
 }
 
+qint64 NoteContent::memoryUsage()
+{
+    return qint64(sizeof(*this)) + m_fileName.size() * qint64(sizeof(QChar));
+}
+qint64 TextContent::memoryUsage()
+{
+    return NoteContent::memoryUsage() + text().size() * qint64(sizeof(QChar));
+}
+qint64 HtmlContent::memoryUsage()
+{
+    // The laid out document takes several times the size of its text:
+    const qint64 documentBytes = document()->characterCount() * qint64(sizeof(QChar)) * 4;
+    return NoteContent::memoryUsage() + (m_html.size() + m_textEquivalent.size()) * qint64(sizeof(QChar)) + documentBytes;
+}
+qint64 ImageContent::memoryUsage()
+{
+    const QPixmap &pixmap = m_pixmapItem.pixmap();
+    return NoteContent::memoryUsage() + qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
 void NoteContent::toLink(QUrl *url, QString *title, const QString &cuttedFullPath)
 {
     *url = QUrl();
@@ -681,7 +706,7 @@ void TextContent::fontChanged()
 }
 void HtmlContent::fontChanged()
 {
-    QTextDocument *richDoc = m_graphicsTextItem.document();
+    QTextDocument *richDoc = document();
     // This check is important when applying style to a note which is not loaded yet. Example:
     // Filter all -> open some basket for the first time -> close filter: if a note was tagged as TODO, then it would display no text
     if (!richDoc->isEmpty())
@@ -1031,40 +1056,68 @@ void TextContent::exportToHTML(HTMLExporter *exporter, int indent)
  */
 
 HtmlContent::HtmlContent(Note *parent, const QString &fileName, bool lazyLoad)
+    : HtmlContent(parent, fileName, lazyLoad, BasketCache::HtmlSummary())
+{
+}
+
+HtmlContent::HtmlContent(Note *parent, const QString &fileName, bool lazyLoad, const BasketCache::HtmlSummary &summary)
     : NoteContent(parent, NoteType::Html, fileName)
     , m_graphicsTextItem(parent)
+    , m_layoutDocument(nullptr)
+    , m_minWidthMeasured(false)
+    , m_fileSize(-1)
+    , m_fileModified(0)
 {
     if (parent) {
         parent->addToGroup(&m_graphicsTextItem);
         m_graphicsTextItem.setPos(parent->contentX(), Note::NOTE_MARGIN);
     }
     basket()->addWatchedFile(fullPath());
-    HtmlContent::loadFromFile(lazyLoad);
+    loadFromFile(lazyLoad, summary);
 }
 
 HtmlContent::~HtmlContent()
 {
+    delete m_layoutDocument;
     if (note())
         note()->removeFromGroup(&m_graphicsTextItem);
 }
 
+QTextDocument *HtmlContent::document() const
+{
+    return (m_layoutDocument ? m_layoutDocument : m_graphicsTextItem.document());
+}
+
 qreal HtmlContent::setWidthAndGetHeight(qreal width)
 {
     width -= 1;
+    // Not shown yet: measure the detached document, the text item will get it with this width
+    if (m_layoutDocument) {
+        m_layoutDocument->setTextWidth(width);
+        return m_layoutDocument->size().height();
+    }
     m_graphicsTextItem.setTextWidth(width);
     return m_graphicsTextItem.boundingRect().height();
 }
 
 bool HtmlContent::loadFromFile(bool lazyLoad)
+{
+    return loadFromFile(lazyLoad, BasketCache::HtmlSummary());
+}
+
+bool HtmlContent::loadFromFile(bool lazyLoad, const BasketCache::HtmlSummary &summary)
 {
     DEBUG_WIN << QStringLiteral("Loading HtmlContent From ") + basket()->folderName() + fileName();
 
     QString content;
     bool success = FileStorage::loadFromFile(fullPath(), &content);
 
-    if (success)
-        setHtml(content, lazyLoad);
-    else {
+    if (success) {
+        stampFile();
+        // The summary is only valid for the file it was made from:
+        const bool upToDate = (summary.isValid() && m_fileSize == summary.fileSize && m_fileModified == summary.fileModified);
+        setHtml(content, lazyLoad, upToDate ? &summary : nullptr);
+    } else {
         setHtml(QString(), lazyLoad);
         if (!QFile::exists(fullPath()))
             HtmlContent::saveToFile(); // Reserve the fileName so no new note will have the same name!
@@ -1074,6 +1127,11 @@ bool HtmlContent::loadFromFile(bool lazyLoad)
 
 bool HtmlContent::finishLazyLoad()
 {
+    if (m_layoutDocument) {
+        delete m_layoutDocument;
+        m_layoutDocument = nullptr;
+    }
+
     qreal width = m_graphicsTextItem.document()->idealWidth();
 
     m_graphicsTextItem.setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsFocusable);
@@ -1091,19 +1149,101 @@ bool HtmlContent::finishLazyLoad()
     m_graphicsTextItem.setTextWidth(1); // We put a width of 1 pixel, so usedWidth() is equal to the minimum width
     int minWidth = m_graphicsTextItem.document()->idealWidth();
     m_graphicsTextItem.setTextWidth(width);
+    m_minWidthMeasured = true;
     contentChanged(minWidth + 1);
 
     return true;
 }
 
+void HtmlContent::finishLazyLoad(const QList<HtmlContent *> &contents)
+{
+    struct Layout {
+        QString html;
+        QFont font;
+        QTextDocument *document = nullptr;
+        qreal minWidth = 0;
+    };
+
+    // The cross references are resolved against the basket tree, so the HTML is prepared here, in the GUI thread:
+    QList<Layout> layouts;
+    layouts.reserve(contents.size());
+    for (HtmlContent *content : contents) {
+        Layout layout;
+        layout.html = Tools::detectURLs(content->m_html);
+        if (content->note()->allowCrossReferences())
+            layout.html = Tools::detectCrossReferences(layout.html);
+        layout.font = content->note()->font();
+        layouts.append(layout);
+    }
+
+    // Parsing and measuring the documents is the expensive part: do it in parallel, with detached documents:
+    QThread *guiThread = QThread::currentThread();
+    QtConcurrent::blockingMap(layouts, [guiThread](Layout &layout) {
+        layout.document = new QTextDocument();
+        layout.document->setDefaultFont(layout.font);
+        layout.document->setHtml(layout.html);
+        layout.document->setTextWidth(1); // We put a width of 1 pixel, so idealWidth() is equal to the minimum width
+        layout.minWidth = layout.document->idealWidth();
+        layout.document->setTextWidth(-1);
+        layout.document->moveToThread(guiThread);
+    });
+
+    for (int i = 0; i < contents.size(); ++i) {
+        HtmlContent *content = contents[i];
+        delete content->m_layoutDocument;
+        content->m_layoutDocument = layouts[i].document;
+        content->m_minWidthMeasured = true;
+        content->contentChanged(layouts[i].minWidth + 1);
+    }
+}
+
+void HtmlContent::aboutToBeShown()
+{
+    if (!m_layoutDocument)
+        return;
+
+    // The note is about to be painted for the first time: give the measured document to the text item
+    QTextDocument *document = m_layoutDocument;
+    m_layoutDocument = nullptr;
+    qreal width = document->textWidth();
+    document->setParent(&m_graphicsTextItem);
+    // The text item only deletes the document it created itself, and only if it is still its own:
+    QPointer<QTextDocument> replacedDocument = m_graphicsTextItem.document();
+    m_graphicsTextItem.setDocument(document);
+    delete replacedDocument;
+    m_graphicsTextItem.setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsFocusable);
+    m_graphicsTextItem.setTextInteractionFlags(Qt::TextEditorInteraction);
+    m_graphicsTextItem.setDefaultTextColor(note()->textColor());
+    m_graphicsTextItem.setTextWidth(width);
+}
+
 bool HtmlContent::saveToFile()
 {
-    return FileStorage::saveToFile(fullPath(), html());
+    const bool success = FileStorage::saveToFile(fullPath(), html());
+    stampFile();
+    return success;
+}
+
+void HtmlContent::stampFile()
+{
+    const QFileInfo info(fullPath());
+    m_fileSize = (info.exists() ? info.size() : -1);
+    m_fileModified = (info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0);
+}
+
+BasketCache::HtmlSummary HtmlContent::cacheSummary() const
+{
+    BasketCache::HtmlSummary summary;
+    summary.fileSize = m_fileSize;
+    summary.fileModified = m_fileModified;
+    summary.textEquivalent = m_textEquivalent;
+    summary.minWidth = (m_minWidthMeasured ? qRound(minWidth()) : 0);
+    return summary;
 }
 
 QString HtmlContent::linkAt(const QPointF &pos)
 {
-    return m_graphicsTextItem.document()->documentLayout()->anchorAt(pos);
+    return document()->documentLayout()->anchorAt(pos);
 }
 
 QString HtmlContent::messageWhenOpening(OpenMessage where)
@@ -1127,6 +1267,11 @@ QString HtmlContent::messageWhenOpening(OpenMessage where)
 }
 
 void HtmlContent::setHtml(const QString &html, bool lazyLoad)
+{
+    setHtml(html, lazyLoad, nullptr);
+}
+
+void HtmlContent::setHtml(const QString &html, bool lazyLoad, const BasketCache::HtmlSummary *summary)
 {
     m_html = html;
     /* The code was commented, so now non-Latin text is stored directly in Unicode.
@@ -1135,11 +1280,16 @@ void HtmlContent::setHtml(const QString &html, bool lazyLoad)
     while (m_html.contains(rx)) {
         m_html.replace( rx.cap().unicode()[0], QString("&#%1;").arg(rx.cap().unicode()[0].unicode()) );
     }*/
-    m_textEquivalent = HtmlContent::toText(QString()); // OPTIM_FILTER
-    if (!lazyLoad)
+    m_textEquivalent = (summary ? summary->textEquivalent : HtmlContent::toText(QString())); // OPTIM_FILTER
+    if (!lazyLoad) {
         HtmlContent::finishLazyLoad();
-    else
+    } else if (summary && summary->minWidth > 0) {
+        m_minWidthMeasured = true;
+        contentChanged(summary->minWidth);
+    } else {
+        m_minWidthMeasured = false;
         contentChanged(10);
+    }
 }
 
 void HtmlContent::exportToHTML(HTMLExporter *exporter, int indent)
@@ -1426,7 +1576,6 @@ void AnimationContent::exportToHTML(HTMLExporter *exporter, int /*indent*/)
 FileContent::FileContent(Note *parent, const QString &fileName)
     : NoteContent(parent, NoteType::File, fileName)
     , m_linkDisplayItem(parent)
-    , m_previewJob(nullptr)
 {
     basket()->addWatchedFile(fullPath());
     FileContent::setFileName(fileName); // FIXME: TO THAT HERE BECAUSE NoteContent() constructor seems to don't be able to call virtual methods???
@@ -1564,7 +1713,7 @@ void FileContent::linkLookChanged()
     // startFetchingUrlPreview();
 }
 
-void FileContent::newPreview(const KFileItem &, const QPixmap &preview)
+void FileContent::newPreview(const QPixmap &preview)
 {
     LinkLook *linkLook = this->linkLook();
     m_linkDisplayItem.linkDisplay().setLink(fileName(),
@@ -1575,27 +1724,16 @@ void FileContent::newPreview(const KFileItem &, const QPixmap &preview)
     contentChanged(m_linkDisplayItem.linkDisplay().minWidth());
 }
 
-void FileContent::removePreview(const KFileItem &ki)
-{
-    newPreview(ki, QPixmap());
-}
-
 void FileContent::startFetchingUrlPreview()
 {
-    /*
-    KUrl url(fullPath());
+    QUrl url = QUrl::fromLocalFile(fullPath());
     LinkLook *linkLook = this->linkLook();
 
-//  delete m_previewJob;
-    if (!url.isEmpty() && linkLook->previewSize() > 0) {
-        QUrl filteredUrl = NoteFactory::filteredURL(url);//KURIFilter::self()->filteredURI(url);
-        KUrl::List urlList;
-        urlList.append(filteredUrl);
-        m_previewJob = KIO::filePreview(urlList, linkLook->previewSize(), linkLook->previewSize(), linkLook->iconSize());
-        connect(m_previewJob, &KIO::PreviewJob::gotPreview, this, &KIO::PreviewJob::newPreview);
-        connect(m_previewJob, &KIO::PreviewJob::failed, this, &KIO::PreviewJob::removePreview);
+    if (!fileName().isEmpty() && linkLook->previewSize() > 0) {
+        PreviewCache::instance()->request(url, linkLook->previewSize(), this, [this](const QPixmap &preview) {
+            newPreview(preview);
+        });
     }
-    */
 }
 
 void FileContent::exportToHTML(HTMLExporter *exporter, int indent)
@@ -1701,9 +1839,6 @@ void SoundContent::setFileName(const QString &fileName)
 LinkContent::LinkContent(Note *parent, const QUrl &url, const QString &title, const QString &icon, bool autoTitle, bool autoIcon)
     : NoteContent(parent, NoteType::Link)
     , m_linkDisplayItem(parent)
-    , m_access_manager(nullptr)
-    , m_acceptingData(false)
-    , m_previewJob(nullptr)
 {
     setLink(url, title, icon, autoTitle, autoIcon);
     if (parent) {
@@ -1828,81 +1963,19 @@ void LinkContent::linkLookChanged()
     fontChanged();
 }
 
-void LinkContent::newPreview(const KFileItem &, const QPixmap &preview)
+void LinkContent::newPreview(const QPixmap &preview)
 {
     LinkLook *linkLook = LinkLook::lookForURL(url());
     m_linkDisplayItem.linkDisplay().setLink(title(), icon(), (linkLook->previewEnabled() ? preview : QPixmap()), linkLook, note()->font());
     contentChanged(m_linkDisplayItem.linkDisplay().minWidth());
 }
 
-void LinkContent::removePreview(const KFileItem &ki)
-{
-    newPreview(ki, QPixmap());
-}
-
-// QHttp slots for getting link title
-void LinkContent::httpReadyRead()
-{
-    if (!m_acceptingData)
-        return;
-
-    // Check for availability
-    qint64 bytesAvailable = m_reply->bytesAvailable();
-    if (bytesAvailable <= 0)
-        return;
-
-    QByteArray buf = m_reply->read(bytesAvailable);
-    m_httpBuff.append(buf);
-
-    // Stop at 10k bytes
-    if (m_httpBuff.length() > 10000) {
-        m_acceptingData = false;
-        m_reply->abort();
-        endFetchingLinkTitle();
-    }
-}
-
-void LinkContent::httpDone(QNetworkReply *reply)
-{
-    if (m_acceptingData) {
-        m_acceptingData = false;
-        endFetchingLinkTitle();
-    }
-
-    // If all done, close and delete the reply.
-    reply->deleteLater();
-}
-
 void LinkContent::startFetchingLinkTitle()
 {
-    QUrl newUrl = this->url();
-
-    // If this is not an HTTP request, just ignore it.
-    if (newUrl.scheme() != QStringLiteral("http") && newUrl.scheme() != QStringLiteral("https")) {
-        return;
-    }
-
-    // If we have no access_manager, create one.
-    if (m_access_manager == nullptr) {
-        m_access_manager = new QNetworkAccessManager(this);
-        connect(m_access_manager, &QNetworkAccessManager::finished, this, &LinkContent::httpDone);
-    }
-
-    // If no explicit port, default to port 80.
-    if (newUrl.port() == 0) {
-        newUrl.setPort(80);
-    }
-
-    // If no path or query part, default to /
-    QString query = newUrl.path() + newUrl.query();
-    if (query.isEmpty()) {
-        newUrl = QUrl::fromLocalFile(QStringLiteral("/"));
-    }
-
-    // Issue request
-    m_reply = m_access_manager->get(QNetworkRequest(newUrl));
-    m_acceptingData = true;
-    connect(m_reply, &QNetworkReply::readyRead, this, &LinkContent::httpReadyRead);
+    const QUrl url = this->url();
+    TitleFetcher::instance()->fetch(url, this, [this, url](const QString &title) {
+        newTitle(url, title);
+    });
 }
 
 // Code duplicated from FileContent::startFetchingUrlPreview()
@@ -1911,26 +1984,13 @@ void LinkContent::startFetchingUrlPreview()
     QUrl url = this->url();
     LinkLook *linkLook = LinkLook::lookForURL(this->url());
 
-    //  delete m_previewJob;
     if (!url.isEmpty() && linkLook->previewSize() > 0) {
-        KFileItem itemUrl(NoteFactory::filteredURL(url)); // KURIFilter::self()->filteredURI(url);
-        m_previewJob = KIO::filePreview({itemUrl}, QSize(linkLook->previewSize(), linkLook->previewSize()), nullptr);
-        // setOverlayIconSize deprecated
-        // m_previewJob->setOverlayIconSize(linkLook->iconSize());
-        connect(m_previewJob, &KIO::PreviewJob::gotPreview, this, &LinkContent::newPreview);
-        connect(m_previewJob, &KIO::PreviewJob::failed, this, &LinkContent::removePreview);
+        PreviewCache::instance()->request(NoteFactory::filteredURL(url), linkLook->previewSize(), this, [this](const QPixmap &preview) {
+            newPreview(preview);
+        });
     }
 }
 
-void LinkContent::endFetchingLinkTitle()
-{
-    if (m_httpBuff.length() > 0) {
-        decodeHtmlTitle();
-        m_httpBuff.clear();
-    } else
-        DEBUG_WIN << QStringLiteral("LinkContent: empty buffer on endFetchingLinkTitle for ") + m_url.toString();
-}
-
 void LinkContent::exportToHTML(HTMLExporter *exporter, int indent)
 {
     QString linkTitle = title();
@@ -2097,7 +2157,7 @@ void CrossReferenceContent::exportToHTML(HTMLExporter *exporter, int /*indent*/)
     if (url.endsWith(QLatin1Char('/')))
         url = url.left(url.length() - 1);
 
-    BasketScene *basket = Global::bnpView->basketForFolderName(url);
+    BasketScene *basket = (Global::bnpView ? Global::bnpView->basketForFolderName(url) : nullptr); // Not in basketbatch
 
     if (!basket)
         title = QStringLiteral("unknown basket");
@@ -2544,34 +2604,18 @@ void UnknownContent::exportToHTML(HTMLExporter *exporter, int indent)
                      << mimeTypes().replace(QStringLiteral("\n"), QLatin1Char('\n') + spaces.fill(QLatin1Char(' '), indent + 1 + 1)) << "</div>";
 }
 
-void LinkContent::decodeHtmlTitle()
+void LinkContent::newTitle(const QUrl &url, const QString &title)
 {
-    KEncodingProber prober;
-    prober.feed(m_httpBuff);
-
-    // Fallback scheme: KEncodingProber - QTextCodec::codecForHtml - UTF-8
-    // QTextCodec *textCodec; // QTextCodec not available in Qt6
-    // if (prober.confidence() > 0.5)
-    //     textCodec = QTextCodec::codecForName(prober.encoding());
-    // else
-    //     textCodec = QTextCodec::codecForHtml(m_httpBuff, QTextCodec::codecForName("utf-8"));
-
-    QString httpBuff = QString::fromUtf8(m_httpBuff);
-
-    // todo: this should probably strip odd html tags like &nbsp; etc
-    QRegularExpression reg(QStringLiteral("<title>[\\s]*(&nbsp;)?([^<]+)[\\s]*</title>"), QRegularExpression::CaseInsensitiveOption);
-
-    // qDebug() << *m_httpBuff << " bytes: " << bytes_read;
+    // The URL may have been changed, or the title set by the user, while the page was fetched:
+    if (title.isEmpty() || url != m_url || !m_autoTitle)
+        return;
 
-    if (httpBuff.indexOf(reg) >= 0) {
-        QRegularExpressionMatch m = reg.match(httpBuff);
-        m_title = m.captured(2);
-        m_autoTitle = false;
-        setEdited();
+    m_title = title;
+    m_autoTitle = false;
+    setEdited();
 
-        // refresh the title
-        setLink(url(), title(), icon(), autoTitle(), autoIcon());
-    }
+    // refresh the title
+    setLink(url(), this->title(), icon(), autoTitle(), autoIcon());
 }
 
 #include "moc_notecontent.cpp"
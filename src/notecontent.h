@@ -9,12 +9,12 @@
 
 #include <QGraphicsItem>
 #include <QMap>
-#include <QNetworkAccessManager>
 #include <QObject>
 #include <QUrl>
 #include <QXmlStreamWriter>
 
 #include "basket_export.h"
+#include "basketcache.h"
 #include "linklabel.h"
 
 class QBuffer;
@@ -33,11 +33,6 @@ class QWidget;
 class KFileItem;
 class QUrl;
 
-namespace KIO
-{
-class PreviewJob;
-}
-
 class BasketScene;
 struct FilterData;
 class Note;
@@ -127,6 +122,7 @@ public:
     } /// << @return an image equivalent of the content.
     virtual void
     toLink(QUrl *url, QString *title, const QString &cuttedFullPath); /// << Set the link to the content. By default, it set them to fullPath() if useFile().
+    virtual qint64 memoryUsage(); /// << @return the approximate memory used by the content, in bytes, to unload baskets over the memory budget.
     virtual bool useFile() const = 0; /// << @return true if it use a file to store the content.
     virtual bool canBeSavedAs() const = 0; /// << @return true if the content can be saved as a file by the user.
     virtual QString saveAsFilters() const = 0; /// << @return the filters for the user to choose a file destination to save the note as.
@@ -156,6 +152,9 @@ public:
     virtual void linkLookChanged()
     {
     } /// << If your content use LinkDisplay with preview enabled, reload the preview (can have changed size)
+    virtual void aboutToBeShown()
+    {
+    } /// << Called before the note is painted: contents that defer the creation of their visible item can do it now.
     virtual QString editToolTipText() const = 0; /// << @return "Edit this [text|image|...]" to put in the tooltip for the note's content zone.
     virtual QMap<QString, QString> toolTipInfos()
     {
@@ -276,6 +275,7 @@ public:
     // Simple Generic Methods:
     QString toText(const QString & /*cuttedFullPath*/) override;
     QString toHtml(const QString &imageName, const QString &cuttedFullPath) override;
+    qint64 memoryUsage() override;
     bool useFile() const override;
     bool canBeSavedAs() const override;
     QString saveAsFilters() const override;
@@ -321,10 +321,13 @@ class BASKET_EXPORT HtmlContent : public NoteContent
 public:
     // Constructor and destructor:
     HtmlContent(Note *parent, const QString &fileName, bool lazyLoad = false);
+    /// Load the note with the text equivalent and the minimum width of @p summary, from the basket cache, if the file did not change since
+    HtmlContent(Note *parent, const QString &fileName, bool lazyLoad, const BasketCache::HtmlSummary &summary);
     ~HtmlContent() override;
     // Simple Generic Methods:
     QString toText(const QString & /*cuttedFullPath*/) override;
     QString toHtml(const QString &imageName, const QString &cuttedFullPath) override;
+    qint64 memoryUsage() override;
     bool useFile() const override;
     bool canBeSavedAs() const override;
     QString saveAsFilters() const override;
@@ -354,11 +357,27 @@ public:
     {
         return &m_graphicsTextItem;
     }
+    void aboutToBeShown() override;
+    /** Finish the lazy loading of several notes at once: the HTML of each note is parsed and measured by worker threads,
+     * in detached documents that are given to the text items only when the notes are shown for the first time.
+     */
+    static void finishLazyLoad(const QList<HtmlContent *> &contents);
+    BasketCache::HtmlSummary cacheSummary() const; ///< @return what the basket cache keeps of this note, stamped with the size and modification time of its file when it was last loaded or saved
 
 protected:
     QString m_html;
     QString m_textEquivalent; // OPTIM_FILTER
     QGraphicsTextItem m_graphicsTextItem;
+    QTextDocument *m_layoutDocument; ///< Document measured by a worker thread and not yet displayed by m_graphicsTextItem, or nullptr.
+    bool m_minWidthMeasured; ///< False while the minimum width is a guess, until the lazy load is finished
+    qint64 m_fileSize; ///< Size of the note file when it was last loaded or saved, or -1 if unknown
+    qint64 m_fileModified; ///< Modification time of the note file then, in milliseconds since the epoch
+
+private:
+    QTextDocument *document() const; ///< @return the pending layout document if any, or the document of m_graphicsTextItem.
+    void stampFile(); ///< Record the size and modification time of the note file, read by cacheSummary()
+    bool loadFromFile(bool lazyLoad, const BasketCache::HtmlSummary &summary);
+    void setHtml(const QString &html, bool lazyLoad, const BasketCache::HtmlSummary *summary);
 };
 
 /** Real implementation of image notes:
@@ -373,6 +392,7 @@ public:
     // Simple Generic Methods:
     QString toHtml(const QString &imageName, const QString &cuttedFullPath) override;
     QPixmap toPixmap() override;
+    qint64 memoryUsage() override;
     bool useFile() const override;
     bool canBeSavedAs() const override;
     QString saveAsFilters() const override;
@@ -518,13 +538,9 @@ public:
 protected:
     LinkDisplayItem m_linkDisplayItem;
     // File Preview Management:
-protected Q_SLOTS:
-    void newPreview(const KFileItem &, const QPixmap &preview);
-    void removePreview(const KFileItem &);
-    void startFetchingUrlPreview();
-
 protected:
-    KIO::PreviewJob *m_previewJob;
+    void newPreview(const QPixmap &preview);
+    void startFetchingUrlPreview();
 };
 
 /** Real implementation of sound notes:
@@ -638,24 +654,13 @@ protected:
     bool m_autoTitle;
     bool m_autoIcon;
     LinkDisplayItem m_linkDisplayItem;
-    QNetworkAccessManager *m_access_manager;
-    QNetworkReply *m_reply;
-    QByteArray m_httpBuff; ///< Accumulator for downloaded HTTP data with yet unknown encoding
-    bool m_acceptingData; ///< When false, don't accept any HTTP data
     // File Preview Management:
-protected Q_SLOTS:
-    void httpReadyRead();
-    void httpDone(QNetworkReply *reply);
-    void newPreview(const KFileItem &, const QPixmap &preview);
-    void removePreview(const KFileItem &);
-    void startFetchingUrlPreview();
-
 protected:
-    KIO::PreviewJob *m_previewJob;
+    void newPreview(const QPixmap &preview);
+    void startFetchingUrlPreview();
 
 private:
-    void decodeHtmlTitle(); ///< Detect encoding of \p m_httpBuff and extract the title from HTML
-    void endFetchingLinkTitle(); ///< Extract title and clear http buffer
+    void newTitle(const QUrl &url, const QString &title); ///< Use the title found by TitleFetcher for @p url
 };
 
 /** Real implementation of cross reference notes:
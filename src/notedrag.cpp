@@ -9,27 +9,195 @@
 #include <QApplication>
 #include <QBuffer>
 #include <QDir>
+#include <QDebug>
 #include <QDragEnterEvent>
+#include <QFile>
 #include <QList>
 #include <QMimeData>
 #include <QPainter>
 #include <QPixmap>
+#include <QSet>
 #include <QStringEncoder>
 #include <QTextStream>
 
 #include <KIO/CopyJob>
 
 #include "basketscene.h"
+#include "bnpview.h"
 #include "global.h"
 #include "notefactory.h"
 #include "noteselection.h"
 #include "tools.h"
 
+/** NoteMimeData */
+
+/** The data of copied or dragged notes, whose text, HTML and image flavours are computed the first time they are asked for:
+ * copying or dragging thousands of notes does not freeze the application, and most drops and pastes only need the native flavour.
+ * Cut notes are kept, hidden, until then.
+ */
+class NoteMimeData : public QMimeData
+{
+public:
+    NoteMimeData(NoteSelection *noteList, bool cutting);
+    ~NoteMimeData() override;
+
+    QStringList formats() const override;
+    bool contains(Note *note) const
+    {
+        return m_noteSet.contains(note);
+    }
+    void materialize(); ///< Compute the flavours not asked for yet, and forget the notes
+    bool adopt(Note *note); ///< Keep @p note, removed from its basket, if it was cut with this data. @return true if it is kept
+    bool hasAdoptedNotesOf(BasketScene *basket) const;
+
+    static QList<NoteMimeData *> s_instances;
+
+protected:
+    QVariant retrieveData(const QString &mimeType, QMetaType type) const override;
+
+private:
+    enum Flavour { NoFlavour = 0, TextFlavour = 1, HtmlFlavour = 2, ImageFlavour = 4 };
+    static int flavourOf(const QString &mimeType);
+    void produce(int flavours) const;
+
+    QList<NoteDrag::DraggedNote> m_notes;
+    QSet<Note *> m_noteSet;
+    QList<Note *> m_adoptedNotes; ///< The cut notes, deleted once the flavours do not need them anymore
+    bool m_cutting;
+    mutable int m_pendingFlavours;
+};
+
+QList<NoteMimeData *> NoteMimeData::s_instances;
+
+NoteMimeData::NoteMimeData(NoteSelection *noteList, bool cutting)
+    : m_cutting(cutting)
+    , m_pendingFlavours(TextFlavour | HtmlFlavour)
+{
+    for (NoteSelection *node = noteList->firstStacked(); node; node = node->nextStacked()) {
+        m_notes.append({node->note, node->fullPath});
+        m_noteSet.insert(node->note);
+        const NoteType::Id type = node->note->content()->type();
+        if (type == NoteType::Image || type == NoteType::Animation)
+            m_pendingFlavours |= ImageFlavour;
+    }
+    s_instances.append(this);
+}
+
+NoteMimeData::~NoteMimeData()
+{
+    s_instances.removeOne(this);
+    qDeleteAll(m_adoptedNotes);
+}
+
+int NoteMimeData::flavourOf(const QString &mimeType)
+{
+    if (mimeType.startsWith(QStringLiteral("text/plain")))
+        return TextFlavour;
+    if (mimeType == QStringLiteral("text/html") || mimeType == QStringLiteral("application/x-qrichtext"))
+        return HtmlFlavour;
+    if (mimeType == QStringLiteral("application/x-qt-image"))
+        return ImageFlavour;
+    return NoFlavour;
+}
+
+QStringList NoteMimeData::formats() const
+{
+    QStringList formats = QMimeData::formats();
+    if (m_pendingFlavours & TextFlavour)
+        formats << QStringLiteral("text/plain");
+    if (m_pendingFlavours & HtmlFlavour)
+        formats << QStringLiteral("text/html") << QStringLiteral("application/x-qrichtext");
+    if (m_pendingFlavours & ImageFlavour)
+        formats << QStringLiteral("application/x-qt-image");
+    return formats;
+}
+
+QVariant NoteMimeData::retrieveData(const QString &mimeType, QMetaType type) const
+{
+    produce(flavourOf(mimeType));
+    return QMimeData::retrieveData(mimeType, type);
+}
+
+void NoteMimeData::produce(int flavours) const
+{
+    flavours &= m_pendingFlavours;
+    if (flavours == NoFlavour)
+        return;
+    m_pendingFlavours &= ~flavours;
+
+    // Computing a flavour does not change what was copied, only when it is computed:
+    auto *self = const_cast<NoteMimeData *>(this);
+    if (flavours & TextFlavour)
+        NoteDrag::serializeText(m_notes, self);
+    if (flavours & HtmlFlavour)
+        NoteDrag::serializeHtml(m_notes, self);
+    if (flavours & ImageFlavour)
+        NoteDrag::serializeImage(m_notes, self);
+}
+
+void NoteMimeData::materialize()
+{
+    produce(TextFlavour | HtmlFlavour | ImageFlavour);
+    m_notes.clear();
+    m_noteSet.clear();
+    QList<Note *> adoptedNotes;
+    adoptedNotes.swap(m_adoptedNotes);
+    qDeleteAll(adoptedNotes);
+}
+
+bool NoteMimeData::adopt(Note *note)
+{
+    if (!m_cutting || !contains(note))
+        return false;
+
+    // The note is not in the basket anymore, but still in its scene. Its group may be deleted:
+    note->setParentNote(nullptr);
+    note->basket()->animations()->stop(note);
+    note->hide();
+    m_adoptedNotes.append(note);
+    return true;
+}
+
+bool NoteMimeData::hasAdoptedNotesOf(BasketScene *basket) const
+{
+    for (Note *note : m_adoptedNotes) {
+        if (note->basket() == basket)
+            return true;
+    }
+    return false;
+}
+
 /** NoteDrag */
 
 const char *NoteDrag::NOTE_MIME_STRING = "application/x-basket-note";
 QList<Note *> NoteDrag::selectedNotes;
 
+void NoteDrag::noteAboutToChange(Note *note)
+{
+    // Usually none, or only the one of the clipboard:
+    for (NoteMimeData *mimeData : std::as_const(NoteMimeData::s_instances)) {
+        if (mimeData->contains(note))
+            mimeData->materialize();
+    }
+}
+
+bool NoteDrag::adoptCutNote(Note *note)
+{
+    for (NoteMimeData *mimeData : std::as_const(NoteMimeData::s_instances)) {
+        if (mimeData->adopt(note))
+            return true;
+    }
+    return false;
+}
+
+void NoteDrag::basketAboutToBeDeleted(BasketScene *basket)
+{
+    for (NoteMimeData *mimeData : std::as_const(NoteMimeData::s_instances)) {
+        if (mimeData->hasAdoptedNotesOf(basket))
+            mimeData->materialize();
+    }
+}
+
 void NoteDrag::createAndEmptyCuttingTmpFolder()
 {
     Tools::deleteRecursively(Global::tempCutFolder());
@@ -44,9 +212,6 @@ QDrag *NoteDrag::dragObject(NoteSelection *noteList, bool cutting, QWidget *sour
 
     auto *multipleDrag = new QDrag(source);
 
-    // The MimeSource:
-    auto *mimeData = new QMimeData;
-
     // Make sure the temporary folder exists and is empty (we delete previously moved file(s) (if exists)
     // since we override the content of the clipboard and previous file willn't be accessable anymore):
     createAndEmptyCuttingTmpFolder();
@@ -60,15 +225,15 @@ QDrag *NoteDrag::dragObject(NoteSelection *noteList, bool cutting, QWidget *sour
 
         // And finally the notes themselves:
         serializeNotes(noteList, stream, cutting);
-        // Append the object:
         buffer.close();
-        mimeData->setData(QString::fromUtf8(NOTE_MIME_STRING), buffer.buffer());
     }
 
-    // The "Other Flavors" Serialization:
-    serializeText(noteList, mimeData);
-    serializeHtml(noteList, mimeData);
-    serializeImage(noteList, mimeData);
+    // The MimeSource, created after the notes are serialized, for it to know the paths of the cut files:
+    auto *mimeData = new NoteMimeData(noteList, cutting);
+    if (!buffer.buffer().isEmpty())
+        mimeData->setData(QString::fromUtf8(NOTE_MIME_STRING), buffer.buffer());
+
+    // The "Other Flavors" Serialization (the text, HTML and image ones are computed by NoteMimeData when asked for):
     serializeLinks(noteList, mimeData, cutting);
 
     // The Alternate Flavors:
@@ -99,9 +264,11 @@ void NoteDrag::serializeNotes(NoteSelection *noteList, QDataStream &stream, bool
             stream << content->fileName();
             if (content->shouldSerializeFile()) {
                 if (cutting) {
-                    // Move file in a temporary place:
+                    // Move file in a temporary place. It is in the saves folder, like the basket, so this is a mere rename.
+                    // fileNameForNewFile() does not create the file, so rename(), which does not overwrite, can use the name:
                     QString fullPath = Global::tempCutFolder() + Tools::fileNameForNewFile(content->fileName(), Global::tempCutFolder());
-                    KIO::move(QUrl::fromLocalFile(content->fullPath()), QUrl::fromLocalFile(fullPath), KIO::HideProgressInfo);
+                    if (!QFile::rename(content->fullPath(), fullPath))
+                        qWarning() << "Could not move" << content->fullPath() << "to" << fullPath;
                     node->fullPath = fullPath;
                     stream << fullPath;
                 } else
@@ -119,12 +286,12 @@ void NoteDrag::serializeNotes(NoteSelection *noteList, QDataStream &stream, bool
     stream << (quint64)0; // Mark the end of the notes in this group/hierarchy.
 }
 
-void NoteDrag::serializeText(NoteSelection *noteList, QMimeData *mimeData)
+void NoteDrag::serializeText(const QList<DraggedNote> &notes, QMimeData *mimeData)
 {
     QString textEquivalent;
     QString text;
-    for (NoteSelection *node = noteList->firstStacked(); node; node = node->nextStacked()) {
-        text = node->note->toText(node->fullPath); // note->toText() and not note->content()->toText() because the first one will also export the tags as text.
+    for (const DraggedNote &node : notes) {
+        text = node.note->toText(node.fullPath); // note->toText() and not note->content()->toText() because the first one will also export the tags as text.
         if (!text.isEmpty())
             textEquivalent += (!textEquivalent.isEmpty() ? QStringLiteral("\n") : QString()) + text;
     }
@@ -133,12 +300,12 @@ void NoteDrag::serializeText(NoteSelection *noteList, QMimeData *mimeData)
     }
 }
 
-void NoteDrag::serializeHtml(NoteSelection *noteList, QMimeData *mimeData)
+void NoteDrag::serializeHtml(const QList<DraggedNote> &notes, QMimeData *mimeData)
 {
     QString htmlEquivalent;
     QString html;
-    for (NoteSelection *node = noteList->firstStacked(); node; node = node->nextStacked()) {
-        html = node->note->content()->toHtml(QString(), node->fullPath);
+    for (const DraggedNote &node : notes) {
+        html = node.note->content()->toHtml(QString(), node.fullPath);
         if (!html.isEmpty())
             htmlEquivalent += (!htmlEquivalent.isEmpty() ? QStringLiteral("<br>\n") : QString()) + html;
     }
@@ -152,12 +319,12 @@ void NoteDrag::serializeHtml(NoteSelection *noteList, QMimeData *mimeData)
     }
 }
 
-void NoteDrag::serializeImage(NoteSelection *noteList, QMimeData *mimeData)
+void NoteDrag::serializeImage(const QList<DraggedNote> &notes, QMimeData *mimeData)
 {
     QList<QPixmap> pixmaps;
     QPixmap pixmap;
-    for (NoteSelection *node = noteList->firstStacked(); node; node = node->nextStacked()) {
-        pixmap = node->note->content()->toPixmap();
+    for (const DraggedNote &node : notes) {
+        pixmap = node.note->content()->toPixmap();
         if (!pixmap.isNull())
             pixmaps.append(pixmap);
     }
@@ -294,6 +461,9 @@ QPixmap NoteDrag::feedbackPixmap(NoteSelection *noteList)
             if (height > qApp->primaryScreen()->geometry().height() / 2)
                 elipsisImage = true;
         }
+        // Drawing the notes that would not be shown anyway would only delay the drag:
+        if (i + 1 >= MAX_FEEDBACK_NOTES)
+            elipsisImage = true;
     }
     if (!pixmaps.isEmpty()) {
         QPixmap result(MARGIN + width + MARGIN, MARGIN + height - SPACING + MARGIN - (spaces.last() ? 1 : 0));
@@ -410,11 +580,16 @@ Note *NoteDrag::decode(const QMimeData *source, BasketScene *parent, bool moveFi
         quint64 basketPointer;
         stream >> (quint64 &)basketPointer;
         auto *basket = (BasketScene *)basketPointer;
+        // The notes may have been copied from a basket that was released since then:
+        if (!Global::bnpView->listViewItemForBasket(basket))
+            basket = nullptr;
         // Decode the note hierarchy:
-        Note *hierarchy = decodeHierarchy(stream, parent, moveFiles, moveNotes, basket);
+        Note *hierarchy = decodeHierarchy(stream, parent, moveFiles, moveNotes && basket, basket);
         // In case we moved notes from one basket to another, save the source basket where notes were removed:
-        basket->filterAgainDelayed(); // Delayed, because if a note is moved to the same basket, the note is not at its
-        basket->save(); //  new position yet, and the call to ensureNoteVisible would make the interface flicker!!
+        if (basket) {
+            basket->filterAgainDelayed(); // Delayed, because if a note is moved to the same basket, the note is not at its
+            basket->save(); //  new position yet, and the call to ensureNoteVisible would make the interface flicker!!
+        }
         return hierarchy;
     } else
         return nullptr;
@@ -466,22 +641,31 @@ Note *NoteDrag::decodeHierarchy(QDataStream &stream, BasketScene *parent, bool m
         } else {
             stream >> fileName >> fullPath >> addedDate >> lastModificationDate;
             if (moveNotes) {
+                // The note comes from this process: move it as is, with its loaded content, instead of creating it again
                 originalBasket->unplugNote(oldNote);
                 note = oldNote;
+                bool fileRenamed = false;
                 if (note->basket() != parent && (!fileName.isEmpty() && !fullPath.isEmpty())) {
                     QString newFileName = Tools::fileNameForNewFile(fileName, parent->fullPath());
                     note->content()->setFileName(newFileName);
 
-                    KIO::CopyJob *copyJob = KIO::move(QUrl::fromLocalFile(fullPath),
-                                                      QUrl::fromLocalFile(parent->fullPath() + newFileName),
-                                                      KIO::Overwrite | KIO::Resume | KIO::HideProgressInfo);
-                    parent->connect(copyJob, &KIO::CopyJob::copyingDone, parent, &BasketScene::slotCopyingDone2);
+                    // Both baskets are in the saves folder, so this is a mere rename, and the content does not need to be loaded again:
+                    fileRenamed = QFile::rename(fullPath, parent->fullPath() + newFileName);
+                    if (!fileRenamed) {
+                        KIO::CopyJob *copyJob = KIO::move(QUrl::fromLocalFile(fullPath),
+                                                          QUrl::fromLocalFile(parent->fullPath() + newFileName),
+                                                          KIO::Overwrite | KIO::Resume | KIO::HideProgressInfo);
+                        parent->connect(copyJob, &KIO::CopyJob::copyingDone, parent, &BasketScene::slotCopyingDone2);
+                    }
                 }
                 note->setGroupWidth(groupWidth);
                 note->setParentNote(nullptr);
                 note->setPrev(nullptr);
                 note->setNext(nullptr);
                 note->setParentBasket(parent);
+                // The renamed file is still encrypted (or not) like the original basket: write it again for the new one
+                if (fileRenamed && (parent->isEncrypted() || originalBasket->isEncrypted()))
+                    note->content()->saveToFile();
                 NoteFactory::consumeContent(stream, (NoteType::Id)type);
             } else if ((note = NoteFactory::decodeContent(stream, (NoteType::Id)type, parent))) {
                 note->setGroupWidth(groupWidth);
@@ -26,11 +26,14 @@ class NoteSelection;
  *   - And then browse all notes and call the virtual Note::serialize() with the stream as parameter for them to serialize their content in the "native format".
  *   - This give the MIME type "application/x-basket-note" that will be used by the application to paste the notes exactly as they were.
  *   - Then the method try to set alternate formats for the dragged objects:
- *   - It call successively toText() for each notes and stack up the result so there is ONE big text flavour to add to the QDrag object
- *   - It do the same with toHtml(), toImage() and toLink() to have those flavors as well, if possible...
+ *   - The text, HTML and image flavours are only announced: they are computed the first time another application asks for them,
+ *     by calling successively toText(), toHtml() or toPixmap() for each notes and stacking up the results.
+ *     They are all computed before a note of the selection is edited or deleted, so they are always what was copied.
+ *     The notes that are cut are not deleted but kept by the data, until all its flavours are computed or the clipboard changes.
+ *   - It do the same with toLink() to have the links flavour as well, if possible, but right away because it is cheap...
  *   - If there is only ONE copied note, addAlternateDragObjects() is called on it, so that Unknown objects can be dragged "as is".
- *   - It's OK for the flavors. The method finally set the drag feedback pixmap by asking every selected notes to draw the content to a small pixmap.
- *   - The pixmaps are joined to one big pixmap (but it should not exceed a defined size) and a border is drawn on this image.
+ *   - It's OK for the flavors. The method finally set the drag feedback pixmap by asking the first selected notes to draw the content to a small pixmap.
+ *   - The pixmaps are joined to one big pixmap (but it should not exceed a defined size nor MAX_FEEDBACK_NOTES notes) and a border is drawn on this image.
  *
  * Pasting/Dropping Scenario:
  *
@@ -38,11 +41,19 @@ class NoteSelection;
  */
 class NoteDrag
 {
+    friend class NoteMimeData;
+
 protected:
+    /// A note of a copied selection, with the path of its file in the cut folder if it is cut
+    struct DraggedNote {
+        Note *note;
+        QString fullPath;
+    };
+
     static void serializeNotes(NoteSelection *noteList, QDataStream &stream, bool cutting);
-    static void serializeText(NoteSelection *noteList, QMimeData *mimeData);
-    static void serializeHtml(NoteSelection *noteList, QMimeData *mimeData);
-    static void serializeImage(NoteSelection *noteList, QMimeData *mimeData);
+    static void serializeText(const QList<DraggedNote> &notes, QMimeData *mimeData);
+    static void serializeHtml(const QList<DraggedNote> &notes, QMimeData *mimeData);
+    static void serializeImage(const QList<DraggedNote> &notes, QMimeData *mimeData);
     static void serializeLinks(NoteSelection *noteList, QMimeData *mimeData, bool cutting);
     static void setFeedbackPixmap(NoteSelection *noteList, QDrag *multipleDrag);
     static Note *decodeHierarchy(QDataStream &stream, BasketScene *parent, bool moveFiles, bool moveNotes, BasketScene *originalBasket);
@@ -56,8 +67,15 @@ public:
     static QList<Note *> notesOf(QGraphicsSceneDragDropEvent *source);
     static void saveNoteSelectionToList(NoteSelection *selection); ///< Traverse @p selection and save all note pointers to @p selectedNotes
     static void createAndEmptyCuttingTmpFolder();
+    /// Compute the flavours of the copied or dragged notes not asked for yet, if @p note is one of them, before it is edited or deleted
+    static void noteAboutToChange(Note *note);
+    /// @return true if @p note was cut and is now owned by the data of the clipboard, instead of being deleted
+    static bool adoptCutNote(Note *note);
+    /// Compute the flavours of the cut notes of @p basket, for them to be deleted with it
+    static void basketAboutToBeDeleted(BasketScene *basket);
 
     static const char *NOTE_MIME_STRING;
+    static const int MAX_FEEDBACK_NOTES = 32; ///< Maximum number of notes drawn in the drag feedback pixmap
 
     static QList<Note *> selectedNotes; ///< The notes being selected and dragged
 };
@@ -994,8 +994,6 @@ void CrossReferenceEditDialog::generateBasketList(KComboBox *targetList, BasketL
         for (int i = 0; i < Global::bnpView->topLevelItemCount(); ++i)
             this->generateBasketList(targetList, Global::bnpView->topLevelItem(i));
     } else {
-        BasketScene *bv = item->basket();
-
         // TODO: add some fancy deco stuff to make it look like a tree list.
         QString pad;
         QString text = item->text(0); // user text
@@ -1004,10 +1002,10 @@ void CrossReferenceEditDialog::generateBasketList(KComboBox *targetList, BasketL
 
         // create the link text
         QString link = QStringLiteral("basket://");
-        link.append(bv->folderName().toLower()); // unique ref.
+        link.append(item->folderName().toLower()); // unique ref.
         QStringList data;
         data.append(link);
-        data.append(bv->icon());
+        data.append(item->basketIcon());
 
         targetList->addItem(item->icon(0), text, QVariant(data));
 
@@ -46,6 +46,7 @@
 #include "basketlistview.h"
 #include "basketscene.h"
 #include "file_mimetypes.h"
+#include "filenameallocator.h"
 #include "global.h"
 #include "note.h"
 #include "notedrag.h"
@@ -857,31 +858,19 @@ QString NoteFactory::fileNameForNewNote(BasketScene *parent, const QString &want
 //  (extension willn't be used for that case)
 QString NoteFactory::createFileForNewNote(BasketScene *parent, const QString &extension, const QString &wantedName)
 {
+    // Create the file right away (exclusively), so the name is reserved:
     QString fileName;
-    QString fullName;
-
-    if (wantedName.isEmpty()) { // TODO: fileNameForNewNote(parent, "note1."+extension);
-        QDir dir;
-        int nb = parent->count() + 1;
-        QString time = QTime::currentTime().toString(QStringLiteral("hhmmss"));
-
-        for (;; ++nb) {
-            fileName = QStringLiteral("note%1-%2.%3").arg(nb).arg(time).arg(extension);
-            fullName = parent->fullPath() + fileName;
-            dir = QDir(fullName);
-            if (!dir.exists(fullName))
-                break;
-        }
-    } else {
-        fileName = fileNameForNewNote(parent, wantedName);
-        fullName = parent->fullPath() + fileName;
-    }
+    QString wanted = wantedName;
+    if (wanted.isEmpty()) { // TODO: fileNameForNewNote(parent, "note1."+extension);
+        QString pattern = QStringLiteral("note%1-") + QTime::currentTime().toString(QStringLiteral("hhmmss")) + QLatin1Char('.') + extension;
+        fileName = FileNameAllocator::reserveNumbered(parent->fullPath(), pattern, parent->count() + 1);
+        wanted = pattern.arg(parent->count() + 1);
+    } else
+        fileName = FileNameAllocator::reserve(parent->fullPath(), wanted);
 
-    // Create the file
-    //  parent->dontCareOfCreation(fullName);
-    QFile file(fullName);
-    file.open(QIODevice::WriteOnly);
-    file.close();
+    // The file cannot be created: still return a free name, saving the note will report the error
+    if (fileName.isEmpty())
+        fileName = FileNameAllocator::allocate(parent->fullPath(), wanted);
 
     return fileName;
 }
@@ -1072,41 +1061,41 @@ Note *NoteFactory::importFileContent(BasketScene *parent)
     return nullptr;
 }
 
-void NoteFactory::loadNode(const QDomElement &content, const QString &lowerTypeName, Note *parent, bool lazyLoad)
+void NoteFactory::loadNode(const QString &content, const QHash<QString, QString> &attributes, const QString &lowerTypeName, Note *parent, bool lazyLoad)
 {
     if (lowerTypeName == QStringLiteral("text")) {
-        new TextContent(parent, content.text(), lazyLoad);
+        new TextContent(parent, content, lazyLoad);
     } else if (lowerTypeName == QStringLiteral("html")) {
-        new HtmlContent(parent, content.text(), lazyLoad);
+        new HtmlContent(parent, content, lazyLoad);
     } else if (lowerTypeName == QStringLiteral("image")) {
-        new ImageContent(parent, content.text(), lazyLoad);
+        new ImageContent(parent, content, lazyLoad);
     } else if (lowerTypeName == QStringLiteral("animation")) {
-        new AnimationContent(parent, content.text(), lazyLoad);
+        new AnimationContent(parent, content, lazyLoad);
     } else if (lowerTypeName == QStringLiteral("sound")) {
-        new SoundContent(parent, content.text());
+        new SoundContent(parent, content);
     } else if (lowerTypeName == QStringLiteral("file")) {
-        new FileContent(parent, content.text());
+        new FileContent(parent, content);
     } else if (lowerTypeName == QStringLiteral("link")) {
-        bool autoTitle = content.attribute(QStringLiteral("title")) == content.text();
-        bool autoIcon = content.attribute(QStringLiteral("icon")) == NoteFactory::iconForURL(QUrl::fromUserInput(content.text()));
-        autoTitle = XMLWork::trueOrFalse(content.attribute(QStringLiteral("autoTitle")), autoTitle);
-        autoIcon = XMLWork::trueOrFalse(content.attribute(QStringLiteral("autoIcon")), autoIcon);
+        bool autoTitle = attributes.value(QStringLiteral("title")) == content;
+        bool autoIcon = attributes.value(QStringLiteral("icon")) == NoteFactory::iconForURL(QUrl::fromUserInput(content));
+        autoTitle = XMLWork::trueOrFalse(attributes.value(QStringLiteral("autoTitle")), autoTitle);
+        autoIcon = XMLWork::trueOrFalse(attributes.value(QStringLiteral("autoIcon")), autoIcon);
         new LinkContent(parent,
-                        QUrl::fromUserInput(content.text()),
-                        content.attribute(QStringLiteral("title")),
-                        content.attribute(QStringLiteral("icon")),
+                        QUrl::fromUserInput(content),
+                        attributes.value(QStringLiteral("title")),
+                        attributes.value(QStringLiteral("icon")),
                         autoTitle,
                         autoIcon);
     } else if (lowerTypeName == QStringLiteral("cross_reference")) {
         new CrossReferenceContent(parent,
-                                  QUrl::fromUserInput(content.text()),
-                                  content.attribute(QStringLiteral("title")),
-                                  content.attribute(QStringLiteral("icon")));
+                                  QUrl::fromUserInput(content),
+                                  attributes.value(QStringLiteral("title")),
+                                  attributes.value(QStringLiteral("icon")));
     } else if (lowerTypeName == QStringLiteral("launcher")) {
-        new LauncherContent(parent, content.text());
+        new LauncherContent(parent, content);
     } else if (lowerTypeName == QStringLiteral("color")) {
-        new ColorContent(parent, QColor(content.text()));
+        new ColorContent(parent, QColor(content));
     } else if (lowerTypeName == QStringLiteral("unknown")) {
-        new UnknownContent(parent, content.text());
+        new UnknownContent(parent, content);
     }
 }
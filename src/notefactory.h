@@ -9,6 +9,7 @@
 
 #include "notecontent.h" //For NoteType::Id
 #include <QDomElement>
+#include <QHash>
 
 class QColor;
 class QPixmap;
@@ -83,7 +84,9 @@ Note *importKMenuLauncher(BasketScene *parent);
 Note *importIcon(BasketScene *parent);
 Note *importFileContent(BasketScene *parent);
 
-void loadNode(const QDomElement &content, const QString &lowerTypeName, Note *parent, bool lazyLoad);
+/** Create the content of a loaded note, from the text and the attributes of its content element.
+ * The attributes are only used by link and cross reference notes. */
+void loadNode(const QString &content, const QHash<QString, QString> &attributes, const QString &lowerTypeName, Note *parent, bool lazyLoad);
 }
 
 #endif // NOTEFACTORY_H
@@ -0,0 +1,203 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "noteingestion.h"
+
+#include <QDBusMetaType>
+#include <QFile>
+#include <QFileInfo>
+#include <QUrl>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "basketscene.h"
+#include "note.h"
+#include "notefactory.h"
+#include "tag.h"
+
+QDBusArgument &operator<<(QDBusArgument &arg, const NoteToCreate &note)
+{
+    arg.beginStructure();
+    arg << note.type << note.content << note.tags;
+    arg.endStructure();
+    return arg;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &arg, NoteToCreate &note)
+{
+    arg.beginStructure();
+    arg >> note.type >> note.content >> note.tags;
+    arg.endStructure();
+    return arg;
+}
+
+QDBusArgument &operator<<(QDBusArgument &arg, const NoteToCreateFromFd &note)
+{
+    arg.beginStructure();
+    arg << note.type << note.name << note.fd << note.tags;
+    arg.endStructure();
+    return arg;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &arg, NoteToCreateFromFd &note)
+{
+    arg.beginStructure();
+    arg >> note.type >> note.name >> note.fd >> note.tags;
+    arg.endStructure();
+    return arg;
+}
+
+namespace
+{
+const int READ_TIMEOUT_MS = 30000; ///< How long a sender can keep its end open without writing anything
+
+/// Call @p write with each chunk read from @p fd, until its end. Fails if nothing can be read from @p fd for READ_TIMEOUT_MS
+template<typename Write>
+bool readChunks(int fd, Write write)
+{
+#ifdef Q_OS_UNIX
+    QByteArray buffer(1 << 16, Qt::Uninitialized);
+    for (;;) {
+        pollfd request = {fd, POLLIN, 0};
+        const int ready = ::poll(&request, 1, READ_TIMEOUT_MS);
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready <= 0)
+            return false;
+        const ssize_t size = ::read(fd, buffer.data(), buffer.size());
+        if (size < 0 && (errno == EINTR || errno == EAGAIN))
+            continue;
+        if (size <= 0)
+            return (size == 0);
+        if (!write(buffer.constData(), size))
+            return false;
+    }
+#else
+    Q_UNUSED(fd)
+    Q_UNUSED(write)
+    return false; // No file descriptor is passed through D-Bus on this platform
+#endif
+}
+
+QByteArray readDescriptor(int fd, bool *ok)
+{
+    QByteArray content;
+    *ok = readChunks(fd, [&content](const char *data, qint64 size) {
+        content.append(data, size);
+        return true;
+    });
+    return (*ok ? content : QByteArray());
+}
+
+bool copyDescriptorToFile(int fd, const QString &path)
+{
+    QFile destination(path);
+    if (!destination.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered))
+        return false;
+
+#ifdef Q_OS_LINUX
+    // When the sender gave a regular file, the kernel copies it (or shares its blocks) without bringing the data to user space:
+    qint64 copied = 0;
+    for (;;) {
+        const ssize_t chunk = ::copy_file_range(fd, nullptr, destination.handle(), nullptr, 1 << 30, 0);
+        if (chunk > 0) {
+            copied += chunk;
+            continue;
+        }
+        if (chunk == 0)
+            return true;
+        if (copied > 0) // Failing in the middle of the copy: the file would be truncated
+            return false;
+        break; // Eg. a pipe or a socket: read it below
+    }
+#endif
+
+    return readChunks(fd, [&destination](const char *data, qint64 size) {
+        return destination.write(data, size) == size;
+    });
+}
+}
+
+void NoteIngestion::registerMetaTypes()
+{
+    qDBusRegisterMetaType<NoteToCreate>();
+    qDBusRegisterMetaType<QList<NoteToCreate>>();
+    qDBusRegisterMetaType<NoteToCreateFromFd>();
+    qDBusRegisterMetaType<QList<NoteToCreateFromFd>>();
+}
+
+Note *NoteIngestion::createNote(const NoteToCreate &wanted, BasketScene *basket)
+{
+    if (wanted.type == QStringLiteral("html"))
+        return NoteFactory::createNoteHtml(wanted.content, basket);
+    if (wanted.type == QStringLiteral("text"))
+        return NoteFactory::createNoteText(wanted.content, basket);
+    if (wanted.type == QStringLiteral("link"))
+        return NoteFactory::createNoteLink(QUrl::fromUserInput(wanted.content), basket);
+    if (wanted.type == QStringLiteral("file") && !wanted.content.isEmpty())
+        return NoteFactory::copyFileAndLoad(QUrl::fromUserInput(wanted.content), basket);
+    return nullptr;
+}
+
+QString NoteIngestion::reserveFile(const NoteToCreateFromFd &wanted, BasketScene *basket)
+{
+    if (wanted.type != QStringLiteral("file") || !wanted.fd.isValid())
+        return QString();
+    const QString name = QFileInfo(wanted.name).fileName(); // Never write outside of the basket folder
+    return (name.isEmpty() ? NoteFactory::createFileForNewNote(basket, QStringLiteral("bin")) : NoteFactory::createFileForNewNote(basket, QString(), name));
+}
+
+NoteIngestion::Content NoteIngestion::readContent(const NoteToCreateFromFd &wanted, const QString &fullPath)
+{
+    Content content;
+    if (!wanted.fd.isValid())
+        return content;
+    if (wanted.type == QStringLiteral("html") || wanted.type == QStringLiteral("text"))
+        content.data = readDescriptor(wanted.fd.fileDescriptor(), &content.ok);
+    else if (wanted.type == QStringLiteral("file") && !fullPath.isEmpty())
+        content.ok = copyDescriptorToFile(wanted.fd.fileDescriptor(), fullPath);
+    return content;
+}
+
+Note *NoteIngestion::createNote(const NoteToCreateFromFd &wanted, const QString &fileName, const Content &content, BasketScene *basket)
+{
+    if (!content.ok) {
+        if (!fileName.isEmpty())
+            QFile::remove(basket->fullPathForFileName(fileName));
+        return nullptr;
+    }
+
+    if (wanted.type == QStringLiteral("html"))
+        return NoteFactory::createNoteHtml(QString::fromUtf8(content.data), basket);
+    if (wanted.type == QStringLiteral("text"))
+        return NoteFactory::createNoteText(QString::fromUtf8(content.data), basket);
+    if (wanted.type == QStringLiteral("file"))
+        return NoteFactory::loadFile(fileName, NoteFactory::typeForURL(QUrl::fromLocalFile(basket->fullPathForFileName(fileName)), basket), basket);
+    return nullptr;
+}
+
+void NoteIngestion::addTags(Note *note, const QStringList &tags)
+{
+    for (const QString &wanted : tags) {
+        State *found = nullptr;
+        for (Tag *tag : std::as_const(Tag::all)) {
+            for (State *state : tag->states()) {
+                if (state->id() == wanted || state->name() == wanted || tag->name() == wanted) {
+                    found = state;
+                    break;
+                }
+            }
+            if (found)
+                break;
+        }
+        if (found)
+            note->addState(found);
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef NOTEINGESTION_H
+#define NOTEINGESTION_H
+
+#include <QByteArray>
+#include <QDBusArgument>
+#include <QDBusUnixFileDescriptor>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+
+class BasketScene;
+class Note;
+
+/** A note to create with BNPView::createNotes(), D-Bus signature (ssas).
+ * @p type is "html", "text", "link", or "file" (an image, a sound... depending on the file type).
+ * @p content is the HTML, the text, the URL of the link, or the URL of the file to copy in the basket.
+ * @p tags are names or ids of tags or states.
+ */
+struct NoteToCreate {
+    QString type;
+    QString content;
+    QStringList tags;
+};
+
+/** A note to create with BNPView::createNotesFromFds(), D-Bus signature (sshas).
+ * The content is read from @p fd instead of being sent in the message, so big files are not copied through the bus.
+ * @p type is "html", "text" or "file". @p name is the wanted file name for "file" notes (its extension is used to know the file type).
+ */
+struct NoteToCreateFromFd {
+    QString type;
+    QString name;
+    QDBusUnixFileDescriptor fd;
+    QStringList tags;
+};
+
+Q_DECLARE_METATYPE(NoteToCreate)
+Q_DECLARE_METATYPE(NoteToCreateFromFd)
+
+QDBusArgument &operator<<(QDBusArgument &arg, const NoteToCreate &note);
+const QDBusArgument &operator>>(const QDBusArgument &arg, NoteToCreate &note);
+QDBusArgument &operator<<(QDBusArgument &arg, const NoteToCreateFromFd &note);
+const QDBusArgument &operator>>(const QDBusArgument &arg, NoteToCreateFromFd &note);
+
+/** Create notes requested by other applications, to insert them in one go with BasketScene::insertCreatedNote()
+ */
+namespace NoteIngestion
+{
+void registerMetaTypes();
+
+/// What readContent() read from the file descriptor of a NoteToCreateFromFd
+struct Content {
+    bool ok = false;
+    QByteArray data; ///< The HTML or the text. Empty for "file" notes: their content is copied to their file
+};
+
+/// @return the new note, not inserted in @p basket yet, or nullptr if the type is unknown or the content cannot be read
+Note *createNote(const NoteToCreate &wanted, BasketScene *basket);
+
+/** Create the file of @p wanted in @p basket, if it is a "file" note, so its name is reserved while its content is read.
+ * @return the file name, or an empty string for the other notes
+ */
+QString reserveFile(const NoteToCreateFromFd &wanted, BasketScene *basket);
+
+/** Read the content of @p wanted, and copy it to @p fullPath (the file from reserveFile()) for "file" notes. Can be called from any thread.
+ * Fails if the sender neither writes nor closes its end for a while, so a client cannot block the reading forever.
+ */
+Content readContent(const NoteToCreateFromFd &wanted, const QString &fullPath);
+
+/// Same as createNote(), from what readContent() read. The file reserved for @p wanted is removed if the note cannot be created
+Note *createNote(const NoteToCreateFromFd &wanted, const QString &fileName, const Content &content, BasketScene *basket);
+
+/// Add the states named @p tags (names or ids of tags or states) to @p note. Unknown names are ignored
+void addTags(Note *note, const QStringList &tags);
+}
+
+#endif // NOTEINGESTION_H
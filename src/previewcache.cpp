@@ -0,0 +1,163 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "previewcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QThreadPool>
+
+#include <KFileItem>
+#include <KIO/PreviewJob>
+
+#include "debugwindow.h"
+#include "global.h"
+
+#include <algorithm>
+
+PreviewCache *PreviewCache::instance()
+{
+    static PreviewCache *instance = nullptr;
+    if (!instance)
+        instance = new PreviewCache();
+    return instance;
+}
+
+PreviewCache::PreviewCache()
+    : m_previews(MAX_MEMORY_KB)
+    , m_runningJobs(0)
+{
+    // Previews of files that changed or of another size are never read again: sweep them out of the way of the GUI thread
+    const QString folder = Global::previewsFolder();
+    QThreadPool::globalInstance()->start([folder]() {
+        pruneStore(folder, qint64(MAX_DISK_KB) * 1024);
+    });
+}
+
+void PreviewCache::pruneStore(const QString &folder, qint64 maxBytes)
+{
+    QFileInfoList files = QDir(folder, QStringLiteral("*.png"), QDir::NoSort, QDir::Files).entryInfoList();
+    qint64 totalBytes = 0;
+    for (const QFileInfo &file : std::as_const(files))
+        totalBytes += file.size();
+    if (totalBytes <= maxBytes)
+        return;
+
+    // The access time is only updated once a day with relatime, which is precise enough to tell the previews still in use:
+    std::sort(files.begin(), files.end(), [](const QFileInfo &a, const QFileInfo &b) {
+        return a.lastRead() < b.lastRead();
+    });
+    for (const QFileInfo &file : std::as_const(files)) {
+        if (totalBytes <= maxBytes)
+            break;
+        if (QFile::remove(file.filePath()))
+            totalBytes -= file.size();
+    }
+}
+
+QString PreviewCache::keyFor(const QUrl &url, int size)
+{
+    // A local file that changed needs a new preview:
+    qint64 modificationTime = 0;
+    if (url.isLocalFile())
+        modificationTime = QFileInfo(url.toLocalFile()).lastModified().toSecsSinceEpoch();
+
+    return url.toString() + QLatin1Char('|') + QString::number(modificationTime) + QLatin1Char('|') + QString::number(size);
+}
+
+QString PreviewCache::pathForKey(const QString &key)
+{
+    return Global::previewsFolder() + QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex())
+        + QStringLiteral(".png");
+}
+
+void PreviewCache::request(const QUrl &url, int size, QObject *receiver, const Callback &callback)
+{
+    const QString key = keyFor(url, size);
+
+    // Already known:
+    if (QPixmap *preview = m_previews.object(key)) {
+        callback(*preview);
+        return;
+    }
+    if (m_failed.contains(key)) {
+        callback(QPixmap());
+        return;
+    }
+
+    // Computed by a previous session:
+    QPixmap stored(pathForKey(key));
+    if (!stored.isNull()) {
+        m_previews.insert(key, new QPixmap(stored), qMax<qint64>(1, stored.sizeInBytes() / 1024));
+        callback(stored);
+        return;
+    }
+
+    // Being computed or waiting for a job: just wait for it
+    auto pending = m_pending.find(key);
+    if (pending != m_pending.end()) {
+        pending->waiters.append({receiver, callback});
+        return;
+    }
+
+    m_pending.insert(key, Pending{url, size, {{receiver, callback}}});
+    m_queue.enqueue(key);
+    startJobs();
+}
+
+void PreviewCache::startJobs()
+{
+    while (m_runningJobs < MAX_JOBS && !m_queue.isEmpty()) {
+        const QString key = m_queue.dequeue();
+        const Pending &pending = m_pending[key];
+
+        KIO::PreviewJob *job = KIO::filePreview({KFileItem(pending.url)}, QSize(pending.size, pending.size), nullptr);
+        ++m_runningJobs;
+        connect(job, &KIO::PreviewJob::gotPreview, this, [this, key](const KFileItem &, const QPixmap &preview) {
+            finish(key, preview);
+        });
+        connect(job, &KJob::result, this, [this, key]() {
+            --m_runningJobs;
+            // No preview was produced:
+            if (m_pending.contains(key))
+                finish(key, QPixmap());
+            startJobs();
+        });
+    }
+    reportUsage();
+}
+
+void PreviewCache::finish(const QString &key, const QPixmap &preview)
+{
+    if (preview.isNull()) {
+        m_failed.insert(key);
+    } else {
+        m_previews.insert(key, new QPixmap(preview), qMax<qint64>(1, preview.sizeInBytes() / 1024));
+        QDir().mkpath(Global::previewsFolder());
+        preview.save(pathForKey(key), "PNG");
+    }
+
+    const QList<Waiter> waiters = m_pending.take(key).waiters;
+    for (const Waiter &waiter : waiters) {
+        if (waiter.receiver)
+            waiter.callback(preview);
+    }
+}
+
+void PreviewCache::reportUsage() const
+{
+    if (Global::debugWindow)
+        Global::debugWindow->setCounter(QStringLiteral("Preview cache"),
+                                        QStringLiteral("%1 KiB in memory, %2 jobs running, %3 queued")
+                                            .arg(m_previews.totalCost())
+                                            .arg(m_runningJobs)
+                                            .arg(m_queue.size()));
+}
+
+#include "moc_previewcache.cpp"
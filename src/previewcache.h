@@ -0,0 +1,78 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PREVIEWCACHE_H
+#define PREVIEWCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QObject>
+#include <QPixmap>
+#include <QPointer>
+#include <QQueue>
+#include <QSet>
+#include <QUrl>
+
+#include <functional>
+
+#include "basket_export.h"
+
+/** Previews of the links and files shown in notes, shared by every basket.
+ * A preview is identified by its URL, the modification time of the file (for local files) and the preview size.
+ * Previews are kept in memory and saved as PNG files in Global::previewsFolder(), so loading a basket again
+ * does not start any KIO preview job. Requests for a preview being computed wait for that job, and only
+ * MAX_JOBS preview jobs run at the same time.
+ * The stored previews are pruned when the cache is created: above MAX_DISK_KB, the least recently read ones are removed.
+ * They are not versioned with the saves folder (see GitWrapper).
+ */
+class BASKET_EXPORT PreviewCache : public QObject
+{
+    Q_OBJECT
+public:
+    using Callback = std::function<void(const QPixmap &preview)>;
+
+    static PreviewCache *instance();
+
+    /** Get the preview of @p url at @p size pixels.
+     * @p callback is called with the preview, or a null pixmap if none can be computed.
+     * It is called right away if the preview is cached, later otherwise, and never if @p receiver has been deleted meanwhile.
+     */
+    void request(const QUrl &url, int size, QObject *receiver, const Callback &callback);
+
+    static const int MAX_JOBS = 4;
+    static const int MAX_MEMORY_KB = 32 * 1024;
+    static const int MAX_DISK_KB = 64 * 1024;
+
+    /// Remove the least recently read PNG files of @p folder until they weigh no more than @p maxBytes
+    static void pruneStore(const QString &folder, qint64 maxBytes);
+
+private:
+    PreviewCache();
+
+    struct Waiter {
+        QPointer<QObject> receiver;
+        Callback callback;
+    };
+    struct Pending {
+        QUrl url;
+        int size;
+        QList<Waiter> waiters;
+    };
+
+    static QString keyFor(const QUrl &url, int size);
+    static QString pathForKey(const QString &key);
+    void startJobs();
+    void finish(const QString &key, const QPixmap &preview);
+    void reportUsage() const;
+
+    QCache<QString, QPixmap> m_previews;
+    QSet<QString> m_failed; ///< Keys of the previews that cannot be computed, to not try again
+    QHash<QString, Pending> m_pending;
+    QQueue<QString> m_queue;
+    int m_runningJobs;
+};
+
+#endif // PREVIEWCACHE_H
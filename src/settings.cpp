@@ -55,6 +55,9 @@ int Settings::s_defImageX = 300;
 int Settings::s_defImageY = 200;
 bool Settings::s_enableReLockTimeout = true;
 int Settings::s_reLockTimeoutMinutes = 0;
+bool Settings::s_releaseIdleBaskets = true;
+int Settings::s_releaseIdleBasketsMinutes = 30;
+int Settings::s_basketsMemoryBudget = 256;
 int Settings::s_newNotesPlace = 1;
 int Settings::s_viewTextFileContent = false;
 int Settings::s_viewHtmlFileContent = false;
@@ -126,6 +129,9 @@ void Settings::loadConfig()
     setBlinkedFilter(config.readEntry("blinkedFilter", false));
     setEnableReLockTimeout(config.readEntry("enableReLockTimeout", true));
     setReLockTimeoutMinutes(config.readEntry("reLockTimeoutMinutes", 0));
+    setReleaseIdleBaskets(config.readEntry("releaseIdleBaskets", true));
+    setReleaseIdleBasketsMinutes(config.readEntry("releaseIdleBasketsMinutes", 30));
+    setBasketsMemoryBudget(config.readEntry("basketsMemoryBudget", 256));
     setMiddleAction(config.readEntry("middleAction", 0));
     setGroupOnInsertionLine(config.readEntry("groupOnInsertionLine", false));
     setSpellCheckTextNotes(config.readEntry("spellCheckTextNotes", true));
@@ -212,6 +218,9 @@ void Settings::saveConfig()
     config.writeEntry("blinkedFilter", blinkedFilter());
     config.writeEntry("enableReLockTimeout", enableReLockTimeout());
     config.writeEntry("reLockTimeoutMinutes", reLockTimeoutMinutes());
+    config.writeEntry("releaseIdleBaskets", releaseIdleBaskets());
+    config.writeEntry("releaseIdleBasketsMinutes", releaseIdleBasketsMinutes());
+    config.writeEntry("basketsMemoryBudget", basketsMemoryBudget());
     config.writeEntry("middleAction", middleAction());
     config.writeEntry("groupOnInsertionLine", groupOnInsertionLine());
     config.writeEntry("spellCheckTextNotes", spellCheckTextNotes());
@@ -616,6 +625,51 @@ BasketsPage::BasketsPage(QObject *parent, const KPluginMetaData &data)
     connect(m_useGnuPGAgent, &QCheckBox::toggled, this, &KCModule::markAsChanged);
 #endif
 
+    // Memory:
+
+    auto *memoryBox = new QGroupBox(i18n("Memory"), this->widget());
+    auto *memoryLayout = new QVBoxLayout;
+    layout->addWidget(memoryBox);
+    memoryBox->setLayout(memoryLayout);
+    widget = new QWidget(memoryBox);
+    memoryLayout->addWidget(widget);
+
+    hLay = new QHBoxLayout(widget);
+    hLay->setContentsMargins(0, 0, 0, 0);
+    m_releaseIdleBaskets = new QCheckBox(i18n("&Free the memory of baskets not shown for"), widget);
+    hLay->addWidget(m_releaseIdleBaskets);
+    m_releaseIdleBasketsMinutes = new QSpinBox(widget);
+    m_releaseIdleBasketsMinutes->setMinimum(1);
+    m_releaseIdleBasketsMinutes->setMaximum(24 * 60);
+    m_releaseIdleBasketsMinutes->setSuffix(i18n(" minutes"));
+    hLay->addWidget(m_releaseIdleBasketsMinutes);
+    hLay->addStretch();
+    connect(m_releaseIdleBaskets, &QCheckBox::toggled, this, &KCModule::markAsChanged);
+    connect(m_releaseIdleBasketsMinutes, &QSpinBox::valueChanged, this, &KCModule::markAsChanged);
+    connect(m_releaseIdleBaskets, &QCheckBox::toggled, m_releaseIdleBasketsMinutes, &QWidget::setEnabled);
+
+    widget = new QWidget(memoryBox);
+    memoryLayout->addWidget(widget);
+    hLay = new QHBoxLayout(widget);
+    hLay->setContentsMargins(0, 0, 0, 0);
+    m_basketsMemoryBudget = new QSpinBox(widget);
+    m_basketsMemoryBudget->setRange(0, 64 * 1024);
+    m_basketsMemoryBudget->setSingleStep(64);
+    m_basketsMemoryBudget->setSuffix(i18n(" MiB"));
+    m_basketsMemoryBudget->setSpecialValueText(i18n("No limit"));
+    auto *budgetLabel = new QLabel(i18n("Unload the least recently shown baskets &above:"), widget);
+    budgetLabel->setBuddy(m_basketsMemoryBudget);
+    hLay->addWidget(budgetLabel);
+    hLay->addWidget(m_basketsMemoryBudget);
+    hLabel = new HelpLabel(i18n("How does it work?"),
+                           i18n("<p>When the notes of the loaded baskets take more memory than this, the baskets that were not shown for the longest time "
+                                "are unloaded, until the others fit in this memory.</p>"
+                                "<p>An unloaded basket is loaded again the next time it is shown. The current basket is never unloaded.</p>"),
+                           widget);
+    hLay->addWidget(hLabel);
+    hLay->addStretch();
+    connect(m_basketsMemoryBudget, &QSpinBox::valueChanged, this, &KCModule::markAsChanged);
+
     layout->insertStretch(-1);
     BasketsPage::load();
 }
@@ -637,6 +691,10 @@ void BasketsPage::load()
     // being true - otherwise, the reLockTimeoutMinutes widget is not disabled properly.
     m_enableReLockTimeoutMinutes->setChecked(Settings::enableReLockTimeout());
     m_reLockTimeoutMinutes->setValue(Settings::reLockTimeoutMinutes());
+    m_releaseIdleBaskets->setChecked(Settings::releaseIdleBaskets());
+    m_releaseIdleBasketsMinutes->setValue(Settings::releaseIdleBasketsMinutes());
+    m_releaseIdleBasketsMinutes->setEnabled(Settings::releaseIdleBaskets());
+    m_basketsMemoryBudget->setValue(Settings::basketsMemoryBudget());
 #ifdef HAVE_LIBGPGME
     m_useGnuPGAgent->setChecked(Settings::useGnuPGAgent());
 
@@ -666,6 +724,9 @@ void BasketsPage::save()
 
     Settings::setEnableReLockTimeout(m_enableReLockTimeoutMinutes->isChecked());
     Settings::setReLockTimeoutMinutes(m_reLockTimeoutMinutes->value());
+    Settings::setReleaseIdleBaskets(m_releaseIdleBaskets->isChecked());
+    Settings::setReleaseIdleBasketsMinutes(m_releaseIdleBasketsMinutes->value());
+    Settings::setBasketsMemoryBudget(m_basketsMemoryBudget->value());
 #ifdef HAVE_LIBGPGME
     Settings::setUseGnuPGAgent(m_useGnuPGAgent->isChecked());
 #endif
@@ -89,6 +89,9 @@ protected:
     static bool s_blinkedFilter;
     static bool s_enableReLockTimeout;
     static int s_reLockTimeoutMinutes;
+    static bool s_releaseIdleBaskets;
+    static int s_releaseIdleBasketsMinutes;
+    static int s_basketsMemoryBudget; // In MiB. 0: no limit
     /** Note Addition */
     static int s_newNotesPlace; // 0:OnTop ; 1:OnBottom ; 2:AtCurrentNote
     static int s_viewTextFileContent;
@@ -167,6 +170,18 @@ public: /* And the following methods are just getter / setters */
     {
         return s_reLockTimeoutMinutes;
     }
+    static inline bool releaseIdleBaskets()
+    {
+        return s_releaseIdleBaskets;
+    }
+    static inline int releaseIdleBasketsMinutes()
+    {
+        return s_releaseIdleBasketsMinutes;
+    }
+    static inline int basketsMemoryBudget()
+    {
+        return s_basketsMemoryBudget;
+    }
     static inline int middleAction()
     {
         return s_middleAction;
@@ -345,6 +360,18 @@ public: /* And the following methods are just getter / setters */
     {
         s_reLockTimeoutMinutes = minutes;
     }
+    static inline void setReleaseIdleBaskets(bool yes)
+    {
+        s_releaseIdleBaskets = yes;
+    }
+    static inline void setReleaseIdleBasketsMinutes(int minutes)
+    {
+        s_releaseIdleBasketsMinutes = minutes;
+    }
+    static inline void setBasketsMemoryBudget(int mebibytes)
+    {
+        s_basketsMemoryBudget = mebibytes;
+    }
     static inline void setMiddleAction(int action)
     {
         s_middleAction = action;
@@ -571,6 +598,11 @@ private:
     QCheckBox *m_useGnuPGAgent;
     QCheckBox *m_enableReLockTimeoutMinutes;
     QSpinBox *m_reLockTimeoutMinutes;
+
+    // Memory
+    QCheckBox *m_releaseIdleBaskets;
+    QSpinBox *m_releaseIdleBasketsMinutes;
+    QSpinBox *m_basketsMemoryBudget;
 };
 
 class BASKET_EXPORT NewNotesPage : public AbstractSettingsPage
@@ -9,6 +9,7 @@
 #include <QDialogButtonBox>
 #include <QDir>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QGroupBox>
 #include <QHBoxLayout>
 #include <QLocale>
@@ -207,27 +208,37 @@ void SoftwareImporters::importTextFile()
         return;
     QString separator = dialog.separator();
 
+    if (!QFileInfo(fileName).isReadable())
+        return;
+
+    // First create a basket for it:
+    QString title = i18nc("From TextFile.txt", "From %1", QUrl::fromLocalFile(fileName).fileName());
+    BasketFactory::newBasket(QStringLiteral("txt"), title);
+    BasketScene *basket = Global::bnpView->currentBasket();
+    basket->load();
+
+    importTextFile(fileName, separator, basket);
+}
+
+bool SoftwareImporters::importTextFile(const QString &fileName, const QString &separator, BasketScene *basket)
+{
     QFile file(fileName);
-    if (file.open(QIODevice::ReadOnly)) {
-        QTextStream stream(&file);
-        QString content = stream.readAll();
-        QStringList list = (separator.isEmpty() ? QStringList(content) : content.split(separator));
-
-        // First create a basket for it:
-        QString title = i18nc("From TextFile.txt", "From %1", QUrl::fromLocalFile(fileName).fileName());
-        BasketFactory::newBasket(QStringLiteral("txt"), title);
-        BasketScene *basket = Global::bnpView->currentBasket();
-        basket->load();
-
-        // Import every notes:
-        for (QStringList::Iterator it = list.begin(); it != list.end(); ++it) {
-            Note *note = NoteFactory::createNoteFromText((*it).trimmed(), basket);
-            basket->insertNote(note, basket->firstNote(), Note::BottomColumn);
-        }
-
-        // Finish the export:
-        finishImport(basket);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QTextStream stream(&file);
+    QString content = stream.readAll();
+    QStringList list = (separator.isEmpty() ? QStringList(content) : content.split(separator));
+
+    // Import every notes:
+    for (QStringList::Iterator it = list.begin(); it != list.end(); ++it) {
+        Note *note = NoteFactory::createNoteFromText((*it).trimmed(), basket);
+        basket->insertNote(note, basket->firstNote(), Note::BottomColumn);
     }
+
+    // Finish the export:
+    finishImport(basket);
+    return true;
 }
 
 #include "moc_softwareimporters.cpp"
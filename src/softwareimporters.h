@@ -9,6 +9,8 @@
 
 #include <QDialog>
 
+#include "basket_export.h"
+
 class QString;
 class QGroupBox;
 class QRadioButton;
@@ -70,6 +72,11 @@ void finishImport(BasketScene *basket);
 
 // The importers in themselves:
 void importTextFile();
+/** Import the text file @p fileName in @p basket without asking anything, eg. from basketbatch.
+ * The file is split into one note per part separated by @p separator, or imported as a single note if it is empty.
+ * @return false if the file could not be read
+ */
+BASKET_EXPORT bool importTextFile(const QString &fileName, const QString &separator, BasketScene *basket);
 }
 
 #endif // SOFTWAREIMPORTERS_H
@@ -9,8 +9,11 @@
 #include <KActionCollection>
 #include <KLocalizedString>
 
+#include <QAction>
+#include <QColor>
 #include <QDir>
 #include <QFont>
+#include <QHash>
 #include <QIcon>
 #include <QList>
 #include <QLocale>
@@ -182,6 +185,84 @@ void State::merge(const List &states, State *result, int *emblemsCount, bool *ha
     }
 }
 
+namespace
+{
+/// The states of a note (in the note order) and the basket background color they are merged against:
+struct MergeKey {
+    State::List states;
+    QRgb backgroundColor;
+    bool backgroundColorValid;
+
+    bool operator==(const MergeKey &other) const
+    {
+        return states == other.states && backgroundColor == other.backgroundColor && backgroundColorValid == other.backgroundColorValid;
+    }
+};
+
+size_t qHash(const MergeKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.states, key.backgroundColor, key.backgroundColorValid);
+}
+
+struct MergedState {
+    State state;
+    int emblemsCount;
+    bool haveInvisibleTags;
+};
+
+/// Every note with the same tag combination shares the same merge result:
+QHash<MergeKey, MergedState> mergeCache;
+}
+
+void State::mergeCached(const List &states, State *result, int *emblemsCount, bool *haveInvisibleTags, const QColor &backgroundColor)
+{
+    if (states.isEmpty()) {
+        merge(states, result, emblemsCount, haveInvisibleTags, backgroundColor);
+        return;
+    }
+
+    MergeKey key{states, backgroundColor.isValid() ? backgroundColor.rgba() : 0, backgroundColor.isValid()};
+    QHash<MergeKey, MergedState>::const_iterator it = mergeCache.constFind(key);
+    if (it == mergeCache.constEnd()) {
+        MergedState merged;
+        merge(states, &merged.state, &merged.emblemsCount, &merged.haveInvisibleTags, backgroundColor);
+        it = mergeCache.insert(key, merged);
+    }
+
+    *result = it->state;
+    *emblemsCount = it->emblemsCount;
+    *haveInvisibleTags = it->haveInvisibleTags;
+}
+
+void State::invalidateMergeCache(const List &changedStates)
+{
+    if (changedStates.isEmpty()) {
+        mergeCache.clear();
+        return;
+    }
+
+    for (QHash<MergeKey, MergedState>::iterator it = mergeCache.begin(); it != mergeCache.end();) {
+        bool containsChangedState = false;
+        for (State *state : changedStates) {
+            if (it.key().states.contains(state)) {
+                containsChangedState = true;
+                break;
+            }
+        }
+        if (containsChangedState)
+            it = mergeCache.erase(it);
+        else
+            ++it;
+    }
+}
+
+bool State::hasSameLookAs(const State *other) const
+{
+    return emblem() == other->emblem() && bold() == other->bold() && italic() == other->italic() && underline() == other->underline()
+        && strikeOut() == other->strikeOut() && textColor() == other->textColor() && fontName() == other->fontName() && fontSize() == other->fontSize()
+        && backgroundColor() == other->backgroundColor();
+}
+
 void State::copyTo(State *other)
 {
     other->m_id = m_id;
@@ -211,6 +292,10 @@ QRegularExpression Tag::regexpDetectTags = QRegularExpression();
 
 QHash<QString, State *> Tag::dictStatesByEquiv = QHash<QString, State *>();
 
+QHash<QString, State *> Tag::dictStatesById = QHash<QString, State *>();
+
+QHash<Tag *, int> Tag::dictTagPositions = QHash<Tag *, int>();
+
 long Tag::getNextStateUid()
 {
     return nextStateUid++; // Return the next Uid and THEN increment the Uid
@@ -222,13 +307,17 @@ Tag::Tag()
     ++tagNumber;
     QString sAction = QStringLiteral("tag_shortcut_number_") + QString::number(tagNumber);
 
-    KActionCollection *ac = Global::bnpView->actionCollection();
-    m_action = ac->addAction(sAction, Global::bnpView, &BNPView::activatedTagShortcut);
+    // Without main window (eg. in basketbatch), the action only keeps the shortcut, and is never registered:
+    if (Global::bnpView) {
+        KActionCollection *ac = Global::bnpView->actionCollection();
+        m_action = ac->addAction(sAction, Global::bnpView, &BNPView::activatedTagShortcut);
+        ac->setShortcutsConfigurable(m_action, false); // We do it in the tag properties dialog
+    } else {
+        m_action = new QAction();
+    }
     m_action->setText(QStringLiteral("FAKE TEXT"));
     m_action->setIcon(QIcon::fromTheme(QStringLiteral("FAKE ICON")));
 
-    ac->setShortcutsConfigurable(m_action, false); // We do it in the tag properties dialog
-
     m_inheritedBySiblings = false;
 }
 
@@ -245,11 +334,12 @@ void Tag::setName(const QString &name)
 
 State *Tag::stateById(const QString &id)
 {
-    for (List::iterator it = all.begin(); it != all.end(); ++it)
-        for (State::List::iterator it2 = (*it)->states().begin(); it2 != (*it)->states().end(); ++it2)
-            if ((*it2)->id() == id)
-                return *it2;
-    return nullptr;
+    return dictStatesById.value(id, nullptr);
+}
+
+int Tag::tagPosition(Tag *tag)
+{
+    return dictTagPositions.value(tag, -1);
 }
 
 State *Tag::stateByTextEquiv(const QString &text)
@@ -414,39 +504,7 @@ Tag *Tag::tagSimilarTo(Tag *tagToTest)
             if (state->name() != stateToTest->name()) {
                 sameName = false;
             }
-            if (state->emblem() != stateToTest->emblem()) {
-                same = false;
-                break;
-            }
-            if (state->bold() != stateToTest->bold()) {
-                same = false;
-                break;
-            }
-            if (state->italic() != stateToTest->italic()) {
-                same = false;
-                break;
-            }
-            if (state->underline() != stateToTest->underline()) {
-                same = false;
-                break;
-            }
-            if (state->strikeOut() != stateToTest->strikeOut()) {
-                same = false;
-                break;
-            }
-            if (state->textColor() != stateToTest->textColor()) {
-                same = false;
-                break;
-            }
-            if (state->fontName() != stateToTest->fontName()) {
-                same = false;
-                break;
-            }
-            if (state->fontSize() != stateToTest->fontSize()) {
-                same = false;
-                break;
-            }
-            if (state->backgroundColor() != stateToTest->backgroundColor()) {
+            if (!state->hasSameLookAs(stateToTest)) {
                 same = false;
                 break;
             }
@@ -755,9 +813,19 @@ const QRegularExpression &Tag::regexpDetectTagsInPlainText()
 
 void Tag::updateCaches()
 {
+    dictStatesByEquiv.clear();
+    dictStatesById.clear();
+    dictTagPositions.clear();
+
     QString patternAllTags;
+    int position = 0;
     for (Tag *tag : Tag::all) {
+        dictTagPositions.insert(tag, position++);
         for (State *state : tag->states()) {
+            // Keep the first state registered for an id, like the former linear lookup did:
+            if (!dictStatesById.contains(state->id()))
+                dictStatesById.insert(state->id(), state);
+
             QString textEquivalent = state->textEquivalent().trimmed();
             if (textEquivalent.isEmpty())
                 continue;
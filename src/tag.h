@@ -160,6 +160,9 @@ public:
     QFont font(QFont base);
     QString toCSS(const QString &gradientFolderPath, const QString &gradientFolderName, const QFont &baseFont);
     static void merge(const List &states, State *result, int *emblemsCount, bool *haveInvisibleTags, const QColor &backgroundColor);
+    static void mergeCached(const List &states, State *result, int *emblemsCount, bool *haveInvisibleTags, const QColor &backgroundColor);
+    static void invalidateMergeCache(const List &changedStates); /// << Forget the cached merges containing one of @p changedStates (all of them if empty)
+    bool hasSameLookAs(const State *other) const;
     void copyTo(State *other);
 
 private:
@@ -193,6 +196,7 @@ public:
     using List = QList<Tag *>;
     static Tag::List all;
     static State *stateById(const QString &id);
+    static int tagPosition(Tag *tag); /// << Index of @p tag in Tag::all, or -1. Kept up to date by updateCaches()
     static State *stateByTextEquiv(const QString &text);
     static Tag *tagForKAction(QAction *action);
     static Tag *tagSimilarTo(Tag *tagToTest);
@@ -210,6 +214,8 @@ public:
 private:
     static long nextStateUid;
     static QHash<QString, State *> dictStatesByEquiv;
+    static QHash<QString, State *> dictStatesById;
+    static QHash<Tag *, int> dictTagPositions;
     static QRegularExpression regexpDetectTags;
 
 public:
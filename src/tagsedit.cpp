@@ -1257,6 +1257,9 @@ void TagsEditDialog::reject()
 
 void TagsEditDialog::accept()
 {
+    // Only the merged styles of notes having a modified or removed state need to be recomputed:
+    State::List changedStates = m_deletedStates;
+
     Tag::all.clear();
     for (TagCopy::List::iterator tagCopyIt = m_tagCopies.begin(); tagCopyIt != m_tagCopies.end(); ++tagCopyIt) {
         TagCopy *tagCopy = *tagCopyIt;
@@ -1274,8 +1277,11 @@ void TagsEditDialog::accept()
         for (StateCopy::List::iterator stateCopyIt = stateCopies.begin(); stateCopyIt != stateCopies.end(); ++stateCopyIt) {
             StateCopy *stateCopy = *stateCopyIt;
             // Copy changes to the state and append in the list of tags:
-            if (stateCopy->oldState)
+            if (stateCopy->oldState) {
+                if (!stateCopy->newState->hasSameLookAs(stateCopy->oldState))
+                    changedStates.append(stateCopy->oldState);
                 stateCopy->newState->copyTo(stateCopy->oldState);
+            }
             State *state = (stateCopy->oldState ? stateCopy->oldState : stateCopy->newState);
             states.append(state);
             state->setParentTag(tag);
@@ -1283,6 +1289,8 @@ void TagsEditDialog::accept()
     }
     Tag::saveTags();
     Tag::updateCaches();
+    if (!changedStates.isEmpty())
+        State::invalidateMergeCache(changedStates);
 
     // Notify removed states and tags, and then remove them:
     if (!m_deletedStates.isEmpty())
@@ -0,0 +1,451 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <KActionCollection>
+
+#include <QCommandLineParser>
+#include <QObject>
+#include <QStatusBar>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include <optional>
+
+#include <config.h>
+
+#include <archive.h>
+#include <basketcache.h>
+#include <basketscene.h>
+#include <basketstatusbar.h>
+#include <bnpview.h>
+#include <corpusgenerator.h>
+#include <filter.h>
+#include <global.h>
+#ifdef HAVE_LIBGPGME
+#include <kgpgme.h>
+#endif
+#include <note.h>
+#include <notecontent.h>
+#include <settings.h>
+#include <tools.h>
+
+/** Benchmarks of the hot paths, on a synthetic basket written by CorpusGenerator.
+ * The corpus is configured by environment variables, so the same binary can be run on several sizes:
+ *   BASKET_BENCHMARK_NOTES (1000), BASKET_BENCHMARK_GROUP_DEPTH (2), BASKET_BENCHMARK_TAGGED (30 percent of the notes),
+ *   BASKET_BENCHMARK_MIX (the weights of the HTML, image, link and file notes: "70,10,15,5") and BASKET_BENCHMARK_SEED (1).
+ * The encryption benchmarks use a key without passphrase, created in a temporary GnuPG home, on BASKET_BENCHMARK_ENCRYPTED_NOTES (100) notes.
+ * Results can be written in a machine-readable format with the usual QtTest options, eg.
+ *   basketbenchmark -o results.xml,xml -o -,txt
+ * or with the "benchmark" build target, which writes benchmark-results.xml in the build folder.
+ */
+class BasketBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkLoad_data();
+    void benchmarkLoad();
+    void benchmarkSave();
+    void benchmarkFilter_data();
+    void benchmarkFilter();
+    void benchmarkMatch_data();
+    void benchmarkMatch();
+    void benchmarkRelayout();
+    void benchmarkNoteAt();
+    void benchmarkHtmlToText();
+    void benchmarkDetectURLs();
+    void benchmarkArchiveSave();
+    void benchmarkArchiveExtract();
+    void benchmarkEncrypt();
+    void benchmarkDecrypt_data();
+    void benchmarkDecrypt();
+
+private:
+    static int environmentValue(const char *name, int defaultValue);
+    static void collectNotes(Note *note, QList<Note *> &notes);
+    static void addFilterRows();
+    QList<Note *> allNotes() const;
+    bool setUpKeyring();
+    QList<QByteArray> plainNotes() const;
+    bool encryptNotes(const QList<QByteArray> &notes, QList<QByteArray> *encrypted);
+
+    QTemporaryDir m_savesFolder;
+    QTemporaryDir m_workFolder;
+    BNPView *m_view = nullptr;
+    BasketScene *m_basket = nullptr;
+    QStringList m_htmlFiles;
+    QString m_gpgKey; ///< Fingerprint of the key of the test keyring
+    std::optional<QByteArray> m_savedGnupgHome; ///< GNUPGHOME before the test keyring replaced it, if it was set
+    bool m_gnupgHomeReplaced = false;
+    QList<QByteArray> m_encryptedNotes;
+};
+
+QTEST_MAIN(BasketBenchmark)
+
+int BasketBenchmark::environmentValue(const char *name, int defaultValue)
+{
+    bool ok;
+    int value = qEnvironmentVariableIntValue(name, &ok);
+    return (ok ? value : defaultValue);
+}
+
+void BasketBenchmark::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_savesFolder.isValid());
+    QVERIFY(m_workFolder.isValid());
+
+    CorpusGenerator::Parameters parameters;
+    parameters.seed = environmentValue("BASKET_BENCHMARK_SEED", 1);
+    parameters.notesPerBasket = environmentValue("BASKET_BENCHMARK_NOTES", 1000);
+    parameters.groupDepth = environmentValue("BASKET_BENCHMARK_GROUP_DEPTH", 2);
+    parameters.taggedPercent = environmentValue("BASKET_BENCHMARK_TAGGED", 30);
+    const QStringList mix = qEnvironmentVariable("BASKET_BENCHMARK_MIX").split(QLatin1Char(','));
+    if (mix.count() == 4) {
+        parameters.htmlWeight = mix[0].toInt();
+        parameters.imageWeight = mix[1].toInt();
+        parameters.linkWeight = mix[2].toInt();
+        parameters.fileWeight = mix[3].toInt();
+    }
+
+    const QString savesFolder = m_savesFolder.path() + QLatin1Char('/');
+    CorpusGenerator generator(parameters);
+    QVERIFY(generator.generate(savesFolder));
+    qInfo() << "Corpus:" << generator.statistics().notes << "notes," << generator.statistics().groups << "groups," << generator.statistics().bytes
+            << "bytes";
+
+    const QString basketFolder = savesFolder + QStringLiteral("baskets/") + generator.folderNames().first();
+    const QStringList htmlFileNames = QDir(basketFolder).entryList({QStringLiteral("*.html")}, QDir::Files, QDir::Name);
+    for (const QString &fileName : htmlFileNames)
+        m_htmlFiles.append(basketFolder + fileName);
+
+    // Bootstrap the application like the main window does, without showing it:
+    Global::setCustomSavesFolder(savesFolder);
+    Global::commandLineOpts = new QCommandLineParser;
+    m_view = new BNPView(nullptr, "benchmark", nullptr, new KActionCollection(this), new BasketStatusBar(new QStatusBar));
+    Settings::setWelcomeBasketsAdded(true); // After the configuration is loaded by the constructor
+
+    // The baskets are loaded by BNPView::lateInit(), and the last opened one becomes the current one:
+    QTRY_VERIFY(m_view->currentBasket() && m_view->currentBasket()->isLoaded());
+    m_basket = m_view->currentBasket();
+    QVERIFY(m_basket->count() > 0);
+}
+
+void BasketBenchmark::cleanupTestCase()
+{
+    delete m_view;
+    m_view = nullptr;
+    delete Global::commandLineOpts;
+    Global::commandLineOpts = nullptr;
+
+    // Give the user's keyring back to the next tests of this process:
+    if (m_gnupgHomeReplaced) {
+        if (m_savedGnupgHome)
+            qputenv("GNUPGHOME", *m_savedGnupgHome);
+        else
+            qunsetenv("GNUPGHOME");
+    }
+}
+
+void BasketBenchmark::collectNotes(Note *note, QList<Note *> &notes)
+{
+    for (; note; note = note->next()) {
+        if (note->isGroup())
+            collectNotes(note->firstChild(), notes);
+        else
+            notes.append(note);
+    }
+}
+
+QList<Note *> BasketBenchmark::allNotes() const
+{
+    QList<Note *> notes;
+    collectNotes(m_basket->firstNote(), notes);
+    return notes;
+}
+
+void BasketBenchmark::benchmarkLoad_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("cold") << false; // From the XML of the .basket file
+    QTest::newRow("warm") << true; // From the basket cache
+}
+
+void BasketBenchmark::benchmarkLoad()
+{
+    QFETCH(bool, cached);
+
+    BasketCache::waitForRebuilds();
+    BasketCache::setEnabled(cached);
+    if (cached)
+        QVERIFY(BasketCache::write(m_basket->fullPath(), m_basket->htmlSummaries()));
+
+    QBENCHMARK {
+        m_basket->reload();
+        m_basket->load();
+    }
+    QVERIFY(m_basket->isLoaded());
+    BasketCache::setEnabled(true);
+}
+
+void BasketBenchmark::benchmarkSave()
+{
+    QBENCHMARK {
+        QVERIFY(m_basket->save());
+    }
+}
+
+void BasketBenchmark::addFilterRows()
+{
+    QTest::addColumn<QString>("string");
+    QTest::addColumn<int>("tagFilterType");
+
+    QTest::newRow("frequent word") << QStringLiteral("basket") << int(FilterData::DontCareTagsFilter);
+    QTest::newRow("no match") << QStringLiteral("zzzz") << int(FilterData::DontCareTagsFilter);
+    QTest::newRow("tagged") << QString() << int(FilterData::TaggedFilter);
+    QTest::newRow("word in tagged") << QStringLiteral("project") << int(FilterData::TaggedFilter);
+}
+
+void BasketBenchmark::benchmarkFilter_data()
+{
+    addFilterRows();
+}
+
+void BasketBenchmark::benchmarkFilter()
+{
+    QFETCH(QString, string);
+    QFETCH(int, tagFilterType);
+
+    FilterData data;
+    data.string = string;
+    data.tagFilterType = tagFilterType;
+    data.isFiltering = true;
+
+    QBENCHMARK {
+        m_basket->newFilter(data, /*andEnsureVisible=*/false);
+    }
+    m_basket->newFilter(FilterData(), /*andEnsureVisible=*/false);
+}
+
+void BasketBenchmark::benchmarkMatch_data()
+{
+    addFilterRows();
+}
+
+void BasketBenchmark::benchmarkMatch()
+{
+    QFETCH(QString, string);
+    QFETCH(int, tagFilterType);
+
+    FilterData data;
+    data.string = string;
+    data.tagFilterType = tagFilterType;
+    data.isFiltering = true;
+
+    const QList<Note *> notes = allNotes();
+    int matches = 0;
+    QBENCHMARK {
+        matches = 0;
+        for (Note *note : notes)
+            matches += (note->content()->match(data) ? 1 : 0);
+    }
+    QVERIFY(matches <= notes.count());
+}
+
+void BasketBenchmark::benchmarkRelayout()
+{
+    QBENCHMARK {
+        m_basket->relayoutNotes();
+    }
+}
+
+void BasketBenchmark::benchmarkNoteAt()
+{
+    // A grid of points covering the whole basket:
+    const QRectF rect = m_basket->sceneRect();
+    QList<QPointF> points;
+    for (int x = 0; x < 20; ++x)
+        for (int y = 0; y < 50; ++y)
+            points.append(QPointF(rect.left() + rect.width() * x / 20, rect.top() + rect.height() * y / 50));
+
+    int found = 0;
+    QBENCHMARK {
+        found = 0;
+        for (const QPointF &point : std::as_const(points))
+            found += (m_basket->noteAt(point) ? 1 : 0);
+    }
+    QVERIFY(found > 0);
+}
+
+void BasketBenchmark::benchmarkHtmlToText()
+{
+    QStringList htmls;
+    for (const QString &path : std::as_const(m_htmlFiles)) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        htmls.append(QString::fromUtf8(file.readAll()));
+    }
+
+    QBENCHMARK {
+        for (const QString &html : std::as_const(htmls))
+            Tools::htmlToText(html);
+    }
+}
+
+void BasketBenchmark::benchmarkDetectURLs()
+{
+    QStringList texts;
+    for (const QString &path : std::as_const(m_htmlFiles)) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        texts.append(Tools::htmlToText(QString::fromUtf8(file.readAll())));
+    }
+
+    QBENCHMARK {
+        for (const QString &text : std::as_const(texts))
+            Tools::detectURLs(text);
+    }
+}
+
+void BasketBenchmark::benchmarkArchiveSave()
+{
+    const QString archive = m_workFolder.filePath(QStringLiteral("benchmark.baskets"));
+    QBENCHMARK {
+        Archive::save(m_basket, /*withSubBaskets=*/true, archive);
+    }
+    QVERIFY(QFile::exists(archive));
+}
+
+void BasketBenchmark::benchmarkArchiveExtract()
+{
+    const QString archive = m_workFolder.filePath(QStringLiteral("benchmark.baskets"));
+    if (!QFile::exists(archive))
+        Archive::save(m_basket, /*withSubBaskets=*/true, archive);
+
+    const QString destination = m_workFolder.filePath(QStringLiteral("extracted/"));
+    QBENCHMARK {
+        QCOMPARE(Archive::extractArchive(archive, destination, /*protectDestination=*/false), Archive::IOErrorCode::NoError);
+    }
+}
+
+bool BasketBenchmark::setUpKeyring()
+{
+#ifdef HAVE_LIBGPGME
+    if (!m_gpgKey.isEmpty())
+        return true;
+
+    // A keyring of its own, so the benchmark neither needs nor touches the one of the user:
+    const QString home = m_workFolder.filePath(QStringLiteral("gnupg"));
+    if (!QDir().mkpath(home) || !QFile::setPermissions(home, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner))
+        return false;
+    if (!m_gnupgHomeReplaced) {
+        if (qEnvironmentVariableIsSet("GNUPGHOME"))
+            m_savedGnupgHome = qgetenv("GNUPGHOME");
+        m_gnupgHomeReplaced = true;
+    }
+    qputenv("GNUPGHOME", QFile::encodeName(home));
+
+    gpgme_check_version(nullptr);
+    gpgme_ctx_t ctx = nullptr;
+    if (gpgme_new(&ctx) != GPG_ERR_NO_ERROR)
+        return false;
+    gpgme_error_t err = gpgme_op_createkey(ctx,
+                                           "BasKet Benchmark <benchmark@basket.invalid>",
+                                           "default",
+                                           0,
+                                           0,
+                                           nullptr,
+                                           GPGME_CREATE_NOPASSWD | GPGME_CREATE_NOEXPIRE);
+    if (err == GPG_ERR_NO_ERROR)
+        m_gpgKey = QString::fromLatin1(gpgme_op_genkey_result(ctx)->fpr);
+    gpgme_release(ctx);
+    return !m_gpgKey.isEmpty();
+#else
+    return false;
+#endif
+}
+
+QList<QByteArray> BasketBenchmark::plainNotes() const
+{
+    QList<QByteArray> notes;
+    const int count = environmentValue("BASKET_BENCHMARK_ENCRYPTED_NOTES", 100);
+    for (int i = 0; i < count && !m_htmlFiles.isEmpty(); ++i) {
+        QFile file(m_htmlFiles[i % m_htmlFiles.count()]);
+        if (file.open(QIODevice::ReadOnly))
+            notes.append(file.readAll());
+    }
+    return notes;
+}
+
+bool BasketBenchmark::encryptNotes(const QList<QByteArray> &notes, QList<QByteArray> *encrypted)
+{
+#ifdef HAVE_LIBGPGME
+    KGpgMe gpg;
+    encrypted->clear();
+    for (const QByteArray &note : notes) {
+        QByteArray encryptedNote;
+        if (!gpg.encrypt(note, note.size(), &encryptedNote, m_gpgKey))
+            return false;
+        encrypted->append(encryptedNote);
+    }
+    return true;
+#else
+    Q_UNUSED(notes)
+    Q_UNUSED(encrypted)
+    return false;
+#endif
+}
+
+void BasketBenchmark::benchmarkEncrypt()
+{
+#ifdef HAVE_LIBGPGME
+    if (!setUpKeyring())
+        QSKIP("Could not create the test keyring");
+
+    const QList<QByteArray> notes = plainNotes();
+    QBENCHMARK {
+        QVERIFY(encryptNotes(notes, &m_encryptedNotes));
+    }
+#else
+    QSKIP("Built without GPG support");
+#endif
+}
+
+void BasketBenchmark::benchmarkDecrypt_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("first open") << false; // A public-key operation per note
+    QTest::newRow("reload") << true; // With the session keys remembered since the first open
+}
+
+void BasketBenchmark::benchmarkDecrypt()
+{
+#ifdef HAVE_LIBGPGME
+    QFETCH(bool, cached);
+
+    if (m_encryptedNotes.isEmpty() && !(setUpKeyring() && encryptNotes(plainNotes(), &m_encryptedNotes)))
+        QSKIP("Could not encrypt the notes with the test keyring");
+
+    KGpgMe gpg;
+    QByteArray decrypted;
+    for (const QByteArray &note : std::as_const(m_encryptedNotes))
+        QVERIFY(gpg.decrypt(note, &decrypted));
+
+    QBENCHMARK {
+        if (!cached)
+            gpg.clearCache(); // Like locking the basket
+        for (const QByteArray &note : std::as_const(m_encryptedNotes))
+            QVERIFY(gpg.decrypt(note, &decrypted));
+    }
+#else
+    QSKIP("Built without GPG support");
+#endif
+}
+
+#include "basketbenchmark.moc"
@@ -0,0 +1,186 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <QObject>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+#include <QtXml/QDomDocument>
+
+#include <basketcache.h>
+
+class BasketCacheTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testNotesFromXml();
+    void testRoundTrip();
+    void testModifiedBasket();
+    void testModifiedNoteFile();
+    void testStaleSummary();
+
+private:
+    static void writeFile(const QString &path, const QByteArray &data);
+    static QString basketXml(const QString &name);
+    static BasketCache::HtmlSummary summaryOf(const QString &path, const QString &textEquivalent);
+};
+
+QTEST_MAIN(BasketCacheTest)
+
+void BasketCacheTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void BasketCacheTest::writeFile(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(data);
+}
+
+BasketCache::HtmlSummary BasketCacheTest::summaryOf(const QString &path, const QString &textEquivalent)
+{
+    const QFileInfo info(path);
+    BasketCache::HtmlSummary summary;
+    summary.fileSize = info.size();
+    summary.fileModified = info.lastModified().toMSecsSinceEpoch();
+    summary.textEquivalent = textEquivalent;
+    return summary;
+}
+
+QString BasketCacheTest::basketXml(const QString &name)
+{
+    return QStringLiteral(
+               "<!DOCTYPE basket><basket><properties><name>%1</name></properties><notes>"
+               "<group width=\"300\">"
+               "<note added=\"2026-01-02T03:04:05\" lastModification=\"2026-01-02T03:04:06\" type=\"html\"><content>note1.html</content><tags>todo;important</tags></note>"
+               "<group folded=\"true\"><note type=\"link\"><content title=\"KDE\" autoTitle=\"false\">https://kde.org</content></note></group>"
+               "</group>"
+               "<item type=\"color\" x=\"10\" y=\"20\"><content>#ff0000</content></item>"
+               "</notes></basket>")
+        .arg(name);
+}
+
+void BasketCacheTest::testNotesFromXml()
+{
+    QDomDocument document;
+    QVERIFY(document.setContent(basketXml(QStringLiteral("Basket"))));
+    const QList<BasketCache::Note> notes = BasketCache::notesFromXml(document.documentElement().firstChildElement(QStringLiteral("notes")));
+
+    QCOMPARE(notes.count(), 2);
+    QVERIFY(notes[0].isGroup);
+    QCOMPARE(notes[0].width, 300);
+    QCOMPARE(notes[0].children.count(), 2);
+
+    const BasketCache::Note &html = notes[0].children[0];
+    QCOMPARE(html.type, QStringLiteral("html"));
+    QCOMPARE(html.content, QStringLiteral("note1.html"));
+    QCOMPARE(html.tags, QStringLiteral("todo;important"));
+    QCOMPARE(html.added, QDateTime(QDate(2026, 1, 2), QTime(3, 4, 5)));
+    QVERIFY(!html.html.isValid());
+
+    QVERIFY(notes[0].children[1].folded);
+    const BasketCache::Note &link = notes[0].children[1].children[0];
+    QCOMPARE(link.contentAttributes.value(QStringLiteral("title")), QStringLiteral("KDE"));
+    QCOMPARE(link.contentAttributes.value(QStringLiteral("autoTitle")), QStringLiteral("false"));
+    QVERIFY(link.added.isNull());
+
+    // Compatibility with 0.6.0 Alpha 1:
+    QCOMPARE(notes[1].type, QStringLiteral("color"));
+    QCOMPARE(notes[1].x, 10);
+    QCOMPARE(notes[1].y, 20);
+}
+
+void BasketCacheTest::testRoundTrip()
+{
+    QTemporaryDir dir;
+    const QString folder = dir.path() + QLatin1Char('/');
+    writeFile(folder + QStringLiteral(".basket"), basketXml(QStringLiteral("Basket")).toUtf8());
+    writeFile(folder + QStringLiteral("note1.html"), "<html><body>Hello</body></html>");
+
+    BasketCache::Structure structure;
+    QVERIFY(!BasketCache::read(folder, &structure));
+
+    BasketCache::HtmlSummary summary = summaryOf(folder + QStringLiteral("note1.html"), QStringLiteral("Hello"));
+    summary.minWidth = 42;
+    QVERIFY(BasketCache::write(folder, {{QStringLiteral("note1.html"), summary}}));
+
+    QVERIFY(BasketCache::read(folder, &structure));
+    QVERIFY(structure.properties.contains(QStringLiteral("<name>Basket</name>")));
+    QCOMPARE(structure.notes.count(), 2);
+    const BasketCache::Note &html = structure.notes[0].children[0];
+    QVERIFY(html.html.isValid());
+    QCOMPARE(html.html.textEquivalent, QStringLiteral("Hello"));
+    QCOMPARE(html.html.minWidth, 42);
+    QCOMPARE(html.html.fileSize, QFileInfo(folder + QStringLiteral("note1.html")).size());
+    QCOMPARE(html.added, QDateTime(QDate(2026, 1, 2), QTime(3, 4, 5)));
+    QCOMPARE(structure.notes[0].children[1].children[0].contentAttributes.value(QStringLiteral("title")), QStringLiteral("KDE"));
+
+    BasketCache::remove(folder);
+    QVERIFY(!BasketCache::read(folder, &structure));
+}
+
+void BasketCacheTest::testModifiedBasket()
+{
+    QTemporaryDir dir;
+    const QString folder = dir.path() + QLatin1Char('/');
+    const QString basketPath = folder + QStringLiteral(".basket");
+    writeFile(basketPath, basketXml(QStringLiteral("Basket")).toUtf8());
+    QVERIFY(BasketCache::write(folder, {}));
+
+    // Same size and modification time, but another content: only the hash can tell
+    const QDateTime modified = QFileInfo(basketPath).lastModified();
+    writeFile(basketPath, basketXml(QStringLiteral("Other!")).toUtf8());
+    QFile file(basketPath);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+    file.close();
+
+    BasketCache::Structure structure;
+    QVERIFY(!BasketCache::read(folder, &structure));
+}
+
+void BasketCacheTest::testModifiedNoteFile()
+{
+    QTemporaryDir dir;
+    const QString folder = dir.path() + QLatin1Char('/');
+    writeFile(folder + QStringLiteral(".basket"), basketXml(QStringLiteral("Basket")).toUtf8());
+    writeFile(folder + QStringLiteral("note1.html"), "<html><body>Hello</body></html>");
+
+    const BasketCache::HtmlSummary summary = summaryOf(folder + QStringLiteral("note1.html"), QStringLiteral("Hello"));
+    QVERIFY(BasketCache::write(folder, {{QStringLiteral("note1.html"), summary}}));
+    writeFile(folder + QStringLiteral("note1.html"), "<html><body>Hello, world</body></html>");
+
+    // The basket did not change, so its cache is still read, but the summary does not match the note file anymore:
+    BasketCache::Structure structure;
+    QVERIFY(BasketCache::read(folder, &structure));
+    const BasketCache::HtmlSummary &cached = structure.notes[0].children[0].html;
+    QVERIFY(cached.fileSize != QFileInfo(folder + QStringLiteral("note1.html")).size());
+}
+
+void BasketCacheTest::testStaleSummary()
+{
+    QTemporaryDir dir;
+    const QString folder = dir.path() + QLatin1Char('/');
+    writeFile(folder + QStringLiteral(".basket"), basketXml(QStringLiteral("Basket")).toUtf8());
+    writeFile(folder + QStringLiteral("note1.html"), "<html><body>Hello</body></html>");
+
+    // The note file changes between the summary and the (background) write: the summary must not be stamped with the new file
+    const BasketCache::HtmlSummary summary = summaryOf(folder + QStringLiteral("note1.html"), QStringLiteral("Hello"));
+    writeFile(folder + QStringLiteral("note1.html"), "<html><body>Hello, world</body></html>");
+    QVERIFY(BasketCache::write(folder, {{QStringLiteral("note1.html"), summary}}));
+
+    BasketCache::Structure structure;
+    QVERIFY(BasketCache::read(folder, &structure));
+    QVERIFY(!structure.notes[0].children[0].html.isValid());
+
+    // Without stamp, a summary cannot be checked, so it is not kept either
+    QVERIFY(BasketCache::write(folder, {{QStringLiteral("note1.html"), BasketCache::HtmlSummary()}}));
+    QVERIFY(BasketCache::read(folder, &structure));
+    QVERIFY(!structure.notes[0].children[0].html.isValid());
+}
+
+#include "basketcachetest.moc"
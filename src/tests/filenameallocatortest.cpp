@@ -0,0 +1,112 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <QObject>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include <filenameallocator.h>
+
+class FileNameAllocatorTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testAllocate();
+    void testReserve();
+    void testReserveNumbered();
+    void testStaleCache();
+    void testRelease();
+
+private:
+    static void touch(const QString &path);
+};
+
+QTEST_MAIN(FileNameAllocatorTest)
+
+void FileNameAllocatorTest::touch(const QString &path)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+}
+
+void FileNameAllocatorTest::testAllocate()
+{
+    QTemporaryDir dir;
+    const QString folder = dir.path() + QLatin1Char('/');
+    touch(folder + QStringLiteral("image.png"));
+    touch(folder + QStringLiteral("image-7.png"));
+
+    QCOMPARE(FileNameAllocator::allocate(folder, QStringLiteral("text.txt")), QStringLiteral("text.txt"));
+    // The name is handed out only once, even if the file is not created:
+    QCOMPARE(FileNameAllocator::allocate(folder, QStringLiteral("text.txt")), QStringLiteral("text-2.txt"));
+    QCOMPARE(FileNameAllocator::allocate(folder, QStringLiteral("image.png")), QStringLiteral("image-8.png"));
+    QCOMPARE(FileNameAllocator::allocate(folder, QStringLiteral("image-7.png")), QStringLiteral("image-9.png"));
+    QVERIFY(!QFile::exists(folder + QStringLiteral("image-9.png")));
+}
+
+void FileNameAllocatorTest::testReserve()
+{
+    QTemporaryDir dir;
+    const QString folder = dir.path() + QLatin1Char('/');
+
+    QCOMPARE(FileNameAllocator::reserve(folder, QStringLiteral("note.html")), QStringLiteral("note.html"));
+    QCOMPARE(FileNameAllocator::reserve(folder, QStringLiteral("note.html")), QStringLiteral("note-2.html"));
+    QVERIFY(QFile::exists(folder + QStringLiteral("note.html")));
+    QVERIFY(QFile::exists(folder + QStringLiteral("note-2.html")));
+
+    // No file can be created in a missing folder:
+    QCOMPARE(FileNameAllocator::reserve(folder + QStringLiteral("missing/"), QStringLiteral("note.html")), QString());
+}
+
+void FileNameAllocatorTest::testReserveNumbered()
+{
+    QTemporaryDir dir;
+    const QString folder = dir.path() + QLatin1Char('/');
+    touch(folder + QStringLiteral("note3-101500.txt"));
+
+    QCOMPARE(FileNameAllocator::reserveNumbered(folder, QStringLiteral("note%1-101500.txt"), 3), QStringLiteral("note4-101500.txt"));
+    QCOMPARE(FileNameAllocator::reserveNumbered(folder, QStringLiteral("note%1-101500.txt"), 3), QStringLiteral("note5-101500.txt"));
+    QCOMPARE(FileNameAllocator::reserveNumbered(folder, QStringLiteral("note%1-101501.txt"), 3), QStringLiteral("note3-101501.txt"));
+}
+
+void FileNameAllocatorTest::testStaleCache()
+{
+    QTemporaryDir dir;
+    const QString folder = dir.path() + QLatin1Char('/');
+    QCOMPARE(FileNameAllocator::reserve(folder, QStringLiteral("a.txt")), QStringLiteral("a.txt"));
+
+    // Files created by someone else after the folder was listed are never handed out:
+    touch(folder + QStringLiteral("b.txt"));
+    touch(folder + QStringLiteral("b-2.txt"));
+    QCOMPARE(FileNameAllocator::allocate(folder, QStringLiteral("b.txt")), QStringLiteral("b-3.txt"));
+    touch(folder + QStringLiteral("c.txt"));
+    QCOMPARE(FileNameAllocator::reserve(folder, QStringLiteral("c.txt")), QStringLiteral("c-2.txt"));
+
+    FileNameAllocator::invalidate(folder);
+    QCOMPARE(FileNameAllocator::allocate(folder, QStringLiteral("b.txt")), QStringLiteral("b-3.txt"));
+}
+
+void FileNameAllocatorTest::testRelease()
+{
+    QTemporaryDir dir;
+    const QString folder = dir.path() + QLatin1Char('/');
+    QCOMPARE(FileNameAllocator::reserve(folder, QStringLiteral("a.txt")), QStringLiteral("a.txt"));
+
+    // A deleted or renamed file gives its name back:
+    QVERIFY(QFile::rename(folder + QStringLiteral("a.txt"), folder + QStringLiteral("b.txt")));
+    FileNameAllocator::release(folder + QStringLiteral("a.txt"));
+    QCOMPARE(FileNameAllocator::reserve(folder, QStringLiteral("a.txt")), QStringLiteral("a.txt"));
+
+    // Removing a folder forgets it, with its sub-folders, however the path is written:
+    const QString subFolder = folder + QStringLiteral("files/");
+    QVERIFY(QDir().mkdir(subFolder));
+    QCOMPARE(FileNameAllocator::reserve(subFolder, QStringLiteral("x.png")), QStringLiteral("x.png"));
+    QVERIFY(QDir(subFolder).removeRecursively());
+    FileNameAllocator::release(folder + QStringLiteral("/files"));
+    QVERIFY(QDir().mkdir(subFolder));
+    QCOMPARE(FileNameAllocator::reserve(subFolder, QStringLiteral("x.png")), QStringLiteral("x.png"));
+}
+
+#include "filenameallocatortest.moc"
@@ -0,0 +1,136 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include <titlefetcher.h>
+
+/**
+ * A stand-in HTTP server: it answers every request with the page of its path, and counts the requests
+ */
+class PageServer : public QTcpServer
+{
+public:
+    PageServer()
+    {
+        connect(this, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket *socket = nextPendingConnection()) {
+                connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+                    const QByteArray request = socket->readAll();
+                    const QByteArray path = request.split(' ').value(1);
+                    ++requests[path];
+                    const QByteArray page = pages.value(path);
+                    socket->write("HTTP/1.1 " + QByteArray(page.isNull() ? "404 Not Found" : "200 OK")
+                                  + "\r\nContent-Type: text/html\r\nConnection: close\r\nContent-Length: " + QByteArray::number(page.size()) + "\r\n\r\n"
+                                  + page);
+                    socket->disconnectFromHost();
+                });
+            }
+        });
+        listen(QHostAddress::LocalHost);
+    }
+
+    QUrl url(const QString &path) const
+    {
+        return QUrl(QStringLiteral("http://127.0.0.1:%1%2").arg(serverPort()).arg(path));
+    }
+
+    QHash<QByteArray, QByteArray> pages;
+    QHash<QByteArray, int> requests;
+};
+
+class TitleFetcherTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testExtractTitle_data();
+    void testExtractTitle();
+    void testFetch();
+    void testCache();
+};
+
+QTEST_MAIN(TitleFetcherTest)
+
+void TitleFetcherTest::testExtractTitle_data()
+{
+    QTest::addColumn<QByteArray>("html");
+    QTest::addColumn<QString>("title");
+    QTest::addColumn<bool>("finished");
+
+    QTest::newRow("simple") << QByteArray("<html><head><title>Basket</title></head>") << QStringLiteral("Basket") << true;
+    QTest::newRow("entities") << QByteArray("<TITLE lang=\"en\">\n &nbsp;Tom &amp; Jerry </TITLE>") << QStringLiteral("Tom & Jerry") << true;
+    QTest::newRow("incomplete") << QByteArray("<html><head><title>Bas") << QString() << false;
+    QTest::newRow("no title") << QByteArray("<html><head></head><body>Basket") << QString() << true;
+}
+
+void TitleFetcherTest::testExtractTitle()
+{
+    QFETCH(QByteArray, html);
+    QFETCH(QString, title);
+    QFETCH(bool, finished);
+
+    bool isFinished = !finished;
+    QCOMPARE(TitleFetcher::extractTitle(html, &isFinished), title);
+    QCOMPARE(isFinished, finished);
+}
+
+void TitleFetcherTest::testFetch()
+{
+    PageServer server;
+    QVERIFY(server.isListening());
+    server.pages.insert("/page", "<html><head><title>A page</title></head><body>" + QByteArray(100000, 'x') + "</body></html>");
+
+    TitleFetcher fetcher(QString());
+    QStringList titles;
+    // Two notes with the same link share one download:
+    for (int i = 0; i < 2; ++i) {
+        fetcher.fetch(server.url(QStringLiteral("/page")), this, [&titles](const QString &title) {
+            titles.append(title);
+        });
+    }
+    bool missingFetched = false;
+    fetcher.fetch(server.url(QStringLiteral("/missing")), this, [&missingFetched](const QString &title) {
+        QVERIFY(title.isEmpty());
+        missingFetched = true;
+    });
+
+    QTRY_COMPARE(titles.size(), 2);
+    QCOMPARE(titles, QStringList({QStringLiteral("A page"), QStringLiteral("A page")}));
+    QTRY_VERIFY(missingFetched);
+    QCOMPARE(server.requests.value("/page"), 1);
+    QTRY_COMPARE(fetcher.runningRequests(), 0);
+}
+
+void TitleFetcherTest::testCache()
+{
+    PageServer server;
+    server.pages.insert("/page", "<html><head><title>Cached</title></head></html>");
+    QTemporaryDir dir;
+    const QString cacheFile = dir.filePath(QStringLiteral("linktitles.xml"));
+
+    {
+        TitleFetcher fetcher(cacheFile);
+        QString title;
+        fetcher.fetch(server.url(QStringLiteral("/page")), this, [&title](const QString &fetched) {
+            title = fetched;
+        });
+        QTRY_COMPARE(title, QStringLiteral("Cached"));
+    } // Saves the cache
+
+    // A new session answers without downloading the page again:
+    TitleFetcher fetcher(cacheFile);
+    QString title;
+    fetcher.fetch(server.url(QStringLiteral("/page")), this, [&title](const QString &fetched) {
+        title = fetched;
+    });
+    QTRY_COMPARE(title, QStringLiteral("Cached"));
+    QCOMPARE(server.requests.value("/page"), 1);
+}
+
+#include "titlefetchertest.moc"
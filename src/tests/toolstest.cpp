@@ -14,6 +14,7 @@ class ToolsTest : public QObject
 private Q_SLOTS:
     void testHtmlToText_data();
     void testHtmlToText();
+    void testCopyRecursively();
 
 private:
     bool readAll(QString fileName, QString &text);
@@ -44,6 +45,24 @@ void ToolsTest::testHtmlToText()
     QCOMPARE(Tools::htmlToText(html), text);
 }
 
+void ToolsTest::testCopyRecursively()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString source = dir.filePath(QStringLiteral("source"));
+    QVERIFY(QDir().mkpath(source + QStringLiteral("/sub")));
+    QFile file(source + QStringLiteral("/sub/note.txt"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("content");
+    file.close();
+
+    const QString destination = dir.filePath(QStringLiteral("destination"));
+    QVERIFY(Tools::copyRecursively(source, destination));
+    QFile copy(destination + QStringLiteral("/sub/note.txt"));
+    QVERIFY(copy.open(QIODevice::ReadOnly));
+    QCOMPARE(copy.readAll(), QByteArray("content"));
+}
+
 bool ToolsTest::readAll(QString fileName, QString &text)
 {
     QFile f(fileName);
@@ -0,0 +1,240 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "titlefetcher.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QTextDocumentFragment>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+#include "debugwindow.h"
+#include "global.h"
+
+namespace
+{
+QPointer<TitleFetcher> s_instance;
+}
+
+TitleFetcher::TitleFetcher(const QString &cacheFile, QObject *parent)
+    : QObject(parent)
+    , m_manager(new QNetworkAccessManager(this))
+    , m_cacheFile(cacheFile)
+{
+    loadCache();
+
+    // Save the new titles in one go, when no more comes:
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(2000);
+    connect(&m_saveTimer, &QTimer::timeout, this, &TitleFetcher::saveCache);
+    // The timer would not fire anymore:
+    if (QCoreApplication::instance())
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &TitleFetcher::flushCache);
+}
+
+TitleFetcher::~TitleFetcher()
+{
+    flushCache();
+}
+
+void TitleFetcher::createInstance(const QString &cacheFile)
+{
+    if (s_instance) {
+        // Titles were already asked for: keep them, and add the saved ones
+        const int fetchedTitles = s_instance->m_titles.size();
+        s_instance->m_cacheFile = cacheFile;
+        s_instance->loadCache();
+        if (fetchedTitles > 0 && !cacheFile.isEmpty())
+            s_instance->m_saveTimer.start();
+        return;
+    }
+    s_instance = new TitleFetcher(cacheFile, QCoreApplication::instance());
+}
+
+TitleFetcher *TitleFetcher::instance()
+{
+    if (!s_instance)
+        s_instance = new TitleFetcher(QString(), QCoreApplication::instance());
+    return s_instance;
+}
+
+void TitleFetcher::flushCache()
+{
+    if (!m_saveTimer.isActive())
+        return;
+    m_saveTimer.stop();
+    saveCache();
+}
+
+void TitleFetcher::fetch(const QUrl &url, QObject *receiver, const Callback &callback)
+{
+    // If this is not an HTTP request, just ignore it.
+    if (url.scheme() != QStringLiteral("http") && url.scheme() != QStringLiteral("https"))
+        return;
+
+    // Known title: still answer asynchronously, like for a download, so callers don't get re-entered
+    auto known = m_titles.constFind(url);
+    if (known != m_titles.constEnd()) {
+        const QString title = *known;
+        QPointer<QObject> guard(receiver);
+        QTimer::singleShot(0, this, [guard, callback, title]() {
+            if (guard)
+                callback(title);
+        });
+        return;
+    }
+
+    auto waiters = m_waiters.find(url);
+    if (waiters != m_waiters.end()) {
+        waiters->append({receiver, callback});
+        return;
+    }
+
+    m_waiters.insert(url, {{receiver, callback}});
+    m_queue.append(url);
+    startRequests();
+}
+
+void TitleFetcher::startRequests()
+{
+    for (auto it = m_queue.begin(); it != m_queue.end() && m_replies.size() < MAX_REQUESTS;) {
+        const QString host = it->host();
+        if (m_requestsPerHost.value(host) >= MAX_REQUESTS_PER_HOST) {
+            ++it;
+            continue;
+        }
+
+        QNetworkRequest request(*it);
+        request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+        QNetworkReply *reply = m_manager->get(request);
+        m_replies.insert(reply, Download{*it, QByteArray()});
+        ++m_requestsPerHost[host];
+        connect(reply, &QNetworkReply::readyRead, this, [this, reply]() {
+            readReply(reply);
+        });
+        connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+            readReply(reply);
+        });
+        it = m_queue.erase(it);
+    }
+}
+
+void TitleFetcher::readReply(QNetworkReply *reply)
+{
+    auto download = m_replies.find(reply);
+    if (download == m_replies.end())
+        return; // Already done (eg. finished() after an abort)
+
+    download->data.append(reply->readAll());
+    bool found = false;
+    QString title = extractTitle(download->data, &found);
+    if (!found && reply->isRunning() && download->data.size() < MAX_BYTES)
+        return; // Wait for more data
+    // The title of an error page is not the title of the link:
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() >= 400)
+        title.clear();
+
+    const QUrl url = download->url;
+    m_replies.erase(download);
+    if (--m_requestsPerHost[url.host()] <= 0)
+        m_requestsPerHost.remove(url.host());
+    if (reply->isRunning())
+        reply->abort(); // No need for the rest of the page
+    reply->deleteLater();
+
+    finish(url, title);
+    startRequests();
+}
+
+void TitleFetcher::finish(const QUrl &url, const QString &title)
+{
+    if (!title.isEmpty()) {
+        m_titles.insert(url, title);
+        if (!m_cacheFile.isEmpty())
+            m_saveTimer.start();
+    } else {
+        DEBUG_WIN << QStringLiteral("TitleFetcher: no title found for ") + url.toString();
+    }
+
+    const QList<Waiter> waiters = m_waiters.take(url);
+    for (const Waiter &waiter : waiters) {
+        if (waiter.receiver)
+            waiter.callback(title);
+    }
+}
+
+QString TitleFetcher::extractTitle(const QByteArray &html, bool *finished)
+{
+    static const QRegularExpression titleExpression(QStringLiteral("<title[^>]*>([^<]*)</title>"), QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression endOfHeadExpression(QStringLiteral("</head>|<body"), QRegularExpression::CaseInsensitiveOption);
+
+    const QString text = QString::fromUtf8(html);
+    QRegularExpressionMatch match = titleExpression.match(text);
+    if (match.hasMatch()) {
+        if (finished)
+            *finished = true;
+        // Decode the entities (eg. "&amp;" or "&nbsp;") and collapse the spaces:
+        return QTextDocumentFragment::fromHtml(match.captured(1)).toPlainText().simplified();
+    }
+
+    if (finished)
+        *finished = text.contains(endOfHeadExpression);
+    return {};
+}
+
+void TitleFetcher::loadCache()
+{
+    QFile file(m_cacheFile);
+    if (m_cacheFile.isEmpty() || !file.open(QIODevice::ReadOnly))
+        return;
+
+    QXmlStreamReader xml(&file);
+    while (xml.readNextStartElement()) {
+        if (xml.name() == QStringLiteral("linkTitles"))
+            continue;
+        if (xml.name() == QStringLiteral("link")) {
+            QUrl url(xml.attributes().value(QStringLiteral("url")).toString());
+            QString title = xml.readElementText();
+            if (url.isValid() && !title.isEmpty() && !m_titles.contains(url))
+                m_titles.insert(url, title);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+}
+
+void TitleFetcher::saveCache()
+{
+    QDir().mkpath(QFileInfo(m_cacheFile).absolutePath()); // The cache folder may not exist yet
+    QSaveFile file(m_cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        DEBUG_WIN << QStringLiteral("TitleFetcher: <font color=red>FAILED to save</font> ") + m_cacheFile;
+        return;
+    }
+
+    QXmlStreamWriter xml(&file);
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
+    xml.writeStartElement(QStringLiteral("linkTitles"));
+    for (auto it = m_titles.cbegin(); it != m_titles.cend(); ++it) {
+        xml.writeStartElement(QStringLiteral("link"));
+        xml.writeAttribute(QStringLiteral("url"), it.key().toString());
+        xml.writeCharacters(it.value());
+        xml.writeEndElement();
+    }
+    xml.writeEndElement();
+    xml.writeEndDocument();
+    file.commit();
+}
+
+#include "moc_titlefetcher.cpp"
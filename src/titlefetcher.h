@@ -0,0 +1,97 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef TITLEFETCHER_H
+#define TITLEFETCHER_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+
+#include <functional>
+
+#include "basket_export.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/** Fetches the titles of web pages for link notes, for every basket.
+ * Only MAX_REQUESTS requests run at the same time, and at most MAX_REQUESTS_PER_HOST to the same host.
+ * A page is read until its title is found or its head section ends, then the download is aborted.
+ * Requests for a URL being fetched wait for the same download, and the titles found are kept in a file,
+ * so they are not downloaded again.
+ */
+class BASKET_EXPORT TitleFetcher : public QObject
+{
+    Q_OBJECT
+public:
+    using Callback = std::function<void(const QString &title)>;
+
+    /// @p cacheFile is the file where the titles are saved, or an empty string to not save them.
+    explicit TitleFetcher(const QString &cacheFile, QObject *parent = nullptr);
+    ~TitleFetcher() override;
+
+    /** Create the fetcher used by the application, saving its titles in @p cacheFile.
+     * Called once the saves folder is known. The fetcher belongs to the application, and saves its last titles when it quits.
+     */
+    static void createInstance(const QString &cacheFile);
+    /// The fetcher used by the application. It does not save its titles if createInstance() was not called yet.
+    static TitleFetcher *instance();
+
+    /// Save the titles now if some are waiting to be saved
+    void flushCache();
+
+    /** Get the title of the page at @p url (http and https only).
+     * @p callback is called later with the title, or with an empty string if it cannot be found.
+     * It is never called if @p receiver has been deleted meanwhile.
+     */
+    void fetch(const QUrl &url, QObject *receiver, const Callback &callback);
+
+    /** Extract the title from the beginning of an HTML page.
+     * @param finished set to true if the title is found, or if @p html goes past the head section (and thus has no title).
+     */
+    static QString extractTitle(const QByteArray &html, bool *finished = nullptr);
+
+    int runningRequests() const
+    {
+        return m_replies.size();
+    }
+
+    static const int MAX_REQUESTS = 6;
+    static const int MAX_REQUESTS_PER_HOST = 2;
+    static const int MAX_BYTES = 64 * 1024; ///< Give up on pages that have no title in their first bytes
+
+private:
+    struct Waiter {
+        QPointer<QObject> receiver;
+        Callback callback;
+    };
+    struct Download {
+        QUrl url;
+        QByteArray data;
+    };
+
+    void startRequests();
+    void readReply(QNetworkReply *reply);
+    void finish(const QUrl &url, const QString &title);
+    void loadCache();
+    void saveCache();
+
+    QNetworkAccessManager *m_manager;
+    QString m_cacheFile;
+    QHash<QUrl, QString> m_titles;
+    QHash<QUrl, QList<Waiter>> m_waiters; ///< URLs queued or being downloaded, with the requests waiting for them
+    QList<QUrl> m_queue;
+    QHash<QNetworkReply *, Download> m_replies;
+    QHash<QString, int> m_requestsPerHost;
+    QTimer m_saveTimer;
+};
+
+#endif // TITLEFETCHER_H
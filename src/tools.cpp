@@ -9,6 +9,7 @@
 
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QFont>
 #include <QFontInfo>
@@ -20,7 +21,6 @@
 #include <QPixmap>
 #include <QRegularExpression>
 #include <QString>
-#include <QTime>
 
 #include <QTextBlock>
 #include <QTextDocument>
@@ -28,8 +28,10 @@
 #include <KIO/CopyJob> //For KIO::trash
 #include <KLocalizedString>
 
+#include "basketscene.h"
 #include "config.h"
 #include "debugwindow.h"
+#include "filenameallocator.h"
 
 // cross reference
 #include "bnpview.h"
@@ -39,34 +41,13 @@
 
 #include <langinfo.h>
 
-QVector<QTime> StopWatch::starts;
-QVector<double> StopWatch::totals;
-QVector<uint> StopWatch::counts;
-
-void StopWatch::start(int id)
-{
-    if (id >= starts.size()) {
-        totals.resize(id + 1);
-        counts.resize(id + 1);
-        for (int i = starts.size(); i <= id; i++) {
-            totals[i] = 0;
-            counts[i] = 0;
-        }
-        starts.resize(id + 1);
-    }
-    starts[id] = QTime::currentTime();
-}
-
-void StopWatch::check(int id)
-{
-    if (id >= starts.size())
-        return;
-    double time = starts[id].msecsTo(QTime::currentTime()) / 1000.0;
-    totals[id] += time;
-    counts[id]++;
-    qDebug() << Q_FUNC_INFO << "Timer_" << id << ": " << time << " s    [" << counts[id] << " times, total: " << totals[id]
-             << " s, average: " << totals[id] / counts[id] << " s]" << Qt::endl;
-}
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 QString Tools::textToHTML(const QString &text)
 {
@@ -246,14 +227,15 @@ QString Tools::crossReferenceForHtml(const QStringList &linkParts, HTMLExporter
     if (url.isEmpty())
         return {};
 
-    BasketScene *basket = Global::bnpView->basketForFolderName(url);
+    // if the basket we're trying to link to is the basket that was exported then
+    // we have to use a special way to refer to it for the links.
+    // Compare the folder names: basketbatch exports without BNPView to look the basket up.
+    const bool isExportedBasket = ((url.endsWith(QLatin1Char('/')) ? url : url + QLatin1Char('/')) == exporter->exportedBasket->folderName());
 
     // remove the trailing slash.
     url = url.left(url.length() - 1);
 
-    // if the basket we're trying to link to is the basket that was exported then
-    // we have to use a special way to refer to it for the links.
-    if (basket == exporter->exportedBasket)
+    if (isExportedBasket)
         url = QStringLiteral("../../") + exporter->fileName;
     else {
         // if we're in the exported basket then the links have to include
@@ -693,6 +675,8 @@ void Tools::deleteRecursively(const QString &folderOrFile)
     } else
         // Delete the file:
         QFile::remove(folderOrFile);
+
+    FileNameAllocator::release(folderOrFile);
 }
 
 void Tools::deleteMetadataRecursively(const QString &folderOrFile)
@@ -718,47 +702,60 @@ void Tools::trashRecursively(const QString &folderOrFile)
 
 QString Tools::fileNameForNewFile(const QString &wantedName, const QString &destFolder)
 {
-    QString fileName = wantedName;
-    QString fullName = destFolder + fileName;
-    QString extension = QString();
-    int number = 2;
-    QDir dir;
-
-    // First check if the file do not exists yet (simpler and more often case)
-    dir = QDir(fullName);
-    if (!dir.exists(fullName))
-        return fileName;
-
-    // Find the file extension, if it exists : Split fileName in fileName and extension
-    // Example : fileName == "note5-3.txt" => fileName = "note5-3" and extension = ".txt"
-    int extIndex = fileName.lastIndexOf(QLatin1Char('.'));
-    if (extIndex != -1 && extIndex != int(fileName.length() - 1)) { // Extension found and fileName do not ends with '.' !
-        extension = fileName.mid(extIndex);
-        fileName.truncate(extIndex);
-    } // else fileName = fileName and extension = QString()
-
-    // Find the file number, if it exists : Split fileName in fileName and number
-    // Example : fileName == "note5-3" => fileName = "note5" and number = 3
-    int extNumber = fileName.lastIndexOf(QLatin1Char('-'));
-    if (extNumber != -1 && extNumber != int(fileName.length() - 1)) { // Number found and fileName do not ends with '-' !
-        bool isANumber;
-        int theNumber = fileName.mid(extNumber + 1).toInt(&isANumber);
-        if (isANumber) {
-            number = theNumber;
-            fileName.truncate(extNumber);
-        } // else :
-    } // else fileName = fileName and number = 2 (because if the file already exists, the generated name is at last the 2nd)
-
-    QString finalName;
-    for (/*int number = 2*/;; ++number) { // TODO: FIXME: If overflow ???
-        finalName = fileName + QLatin1Char('-') + QString::number(number) + extension;
-        fullName = destFolder + finalName;
-        dir = QDir(fullName);
-        if (!dir.exists(fullName))
-            break;
+    return FileNameAllocator::allocate(destFolder, wantedName);
+}
+
+bool Tools::copyFile(const QString &source, const QString &destination)
+{
+#ifdef Q_OS_LINUX
+    int sourceFd = ::open(QFile::encodeName(source).constData(), O_RDONLY | O_CLOEXEC);
+    if (sourceFd >= 0) {
+        struct stat sourceStat;
+        int destinationFd = -1;
+        if (::fstat(sourceFd, &sourceStat) == 0 && S_ISREG(sourceStat.st_mode))
+            destinationFd = ::open(QFile::encodeName(destination).constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (destinationFd >= 0) {
+            // Share the data blocks when the filesystem supports it (Btrfs, XFS...), or let the kernel copy them:
+            bool success = (::ioctl(destinationFd, FICLONE, sourceFd) == 0);
+            if (!success) {
+                off_t remaining = sourceStat.st_size;
+                while (remaining > 0) {
+                    ssize_t copied = ::copy_file_range(sourceFd, nullptr, destinationFd, nullptr, remaining, 0);
+                    if (copied <= 0)
+                        break;
+                    remaining -= copied;
+                }
+                success = (remaining == 0);
+            }
+            ::close(destinationFd);
+            ::close(sourceFd);
+            if (success)
+                return true;
+        } else {
+            ::close(sourceFd);
+        }
     }
+#endif
 
-    return finalName;
+    // Portable fallback (QFile::copy() refuses to overwrite):
+    if (QFile::exists(destination))
+        QFile::remove(destination);
+    return QFile::copy(source, destination);
+}
+
+bool Tools::copyRecursively(const QString &source, const QString &destination)
+{
+    QFileInfo info(source);
+    if (!info.isDir())
+        return copyFile(source, destination);
+
+    if (!QDir().mkpath(destination))
+        return false;
+    bool success = true;
+    const QFileInfoList children = QDir(source).entryInfoList(QDir::Dirs | QDir::Files | QDir::NoSymLinks | QDir::NoDotAndDotDot | QDir::Hidden);
+    for (const QFileInfo &child : children)
+        success = copyRecursively(child.absoluteFilePath(), destination + QLatin1Char('/') + child.fileName()) && success;
+    return success;
 }
 
 qint64 Tools::computeSizeRecursively(const QString &path)
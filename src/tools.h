@@ -18,23 +18,10 @@ class QMimeData;
 class QObject;
 class QPixmap;
 class QString;
-class QTime;
 class QTextDocument;
 
 class HTMLExporter;
 
-class StopWatch
-{
-public:
-    static void start(int id);
-    static void check(int id);
-
-private:
-    static QVector<QTime> starts;
-    static QVector<double> totals;
-    static QVector<uint> counts;
-};
-
 /** Some useful functions for that application.
  * @author Sébastien Laoût
  */
@@ -114,6 +101,17 @@ BASKET_EXPORT void deleteMetadataRecursively(const QString &folderOrFile);
  */
 BASKET_EXPORT QString fileNameForNewFile(const QString &wantedName, const QString &destFolder);
 
+/** Synchronously copy the file @p source to @p destination, overwriting it.
+ * On Linux, the data is cloned (reflink) when the filesystem allows it, or copied in the kernel with copy_file_range().
+ * @return true on success.
+ */
+BASKET_EXPORT bool copyFile(const QString &source, const QString &destination);
+
+/** Synchronously copy the file or folder @p source, with its content, to @p destination. Symbolic links are skipped.
+ * @return true on success.
+ */
+BASKET_EXPORT bool copyRecursively(const QString &source, const QString &destination);
+
 //! @returns Total size in bytes of all files and subdirectories
 BASKET_EXPORT qint64 computeSizeRecursively(const QString &path);
 
@@ -0,0 +1,227 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "tracing.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+namespace
+{
+struct Event {
+    const char *name;
+    qint64 startNs;
+    qint64 endNs;
+};
+
+/// The spans of one thread. Only that thread writes the events and the head, so recording needs no lock
+struct Ring {
+    std::array<Event, Tracing::RING_SIZE> events;
+    std::atomic<quint64> head{0}; ///< Number of spans recorded by the thread
+    std::atomic<quint64> clearedHead{0}; ///< The head when clear() was last called: the spans before it are not shown anymore
+    int threadId = 0;
+    QString threadName; ///< Changed when the ring is given to another thread: read it with ringsMutex locked
+};
+
+std::atomic<bool> enabled{false};
+
+// The rings of finished threads are kept, so their spans can still be exported, until a new thread needs a ring:
+// there are as many rings as threads that recorded spans at the same time, not as threads ever started.
+QMutex ringsMutex;
+QList<Ring *> rings;
+QList<Ring *> freeRings; ///< The rings of the finished threads
+
+/// Give the ring of a thread back when the thread finishes
+struct RingOwner {
+    Ring *ring = nullptr;
+
+    ~RingOwner()
+    {
+        if (ring) {
+            QMutexLocker locker(&ringsMutex);
+            freeRings.append(ring);
+            ring = nullptr;
+        }
+    }
+};
+thread_local RingOwner threadRing;
+
+QElapsedTimer &clock()
+{
+    static QElapsedTimer timer = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return timer;
+}
+
+Ring *ringOfThisThread()
+{
+    if (!threadRing.ring) {
+        QThread *thread = QThread::currentThread();
+        QString threadName = thread->objectName();
+        if (qApp && thread == qApp->thread())
+            threadName = QStringLiteral("GUI thread");
+
+        QMutexLocker locker(&ringsMutex);
+        Ring *ring;
+        if (!freeRings.isEmpty()) {
+            ring = freeRings.takeLast();
+            // Like clear(): the spans of the finished thread would be shown as spans of this one
+            ring->clearedHead.store(ring->head.load(std::memory_order_relaxed), std::memory_order_release);
+        } else {
+            ring = new Ring;
+            rings.append(ring);
+            ring->threadId = rings.size();
+        }
+        ring->threadName = (threadName.isEmpty() ? QStringLiteral("Thread %1").arg(ring->threadId) : threadName);
+        threadRing.ring = ring;
+    }
+    return threadRing.ring;
+}
+
+/// Copy the spans of @p ring, from another thread than the one recording them
+QList<Event> snapshot(const Ring *ring)
+{
+    const quint64 head = ring->head.load(std::memory_order_acquire);
+    const quint64 first = qMax(ring->clearedHead.load(std::memory_order_acquire), head > quint64(Tracing::RING_SIZE) ? head - Tracing::RING_SIZE : 0);
+    QList<Event> events;
+    events.reserve(head - first);
+    for (quint64 i = first; i < head; ++i)
+        events.append(ring->events[i % Tracing::RING_SIZE]);
+
+    // The spans overwritten by the recording thread while we were copying them are dropped:
+    const quint64 newHead = ring->head.load(std::memory_order_acquire);
+    const quint64 newFirst = (newHead > quint64(Tracing::RING_SIZE) ? newHead - Tracing::RING_SIZE : 0);
+    if (newFirst > first)
+        events.remove(0, qMin<qsizetype>(events.size(), newFirst - first));
+    return events;
+}
+}
+
+void Tracing::setEnabled(bool enable)
+{
+    clock(); // Start the clock now, not during the first span
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool Tracing::isEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+qint64 Tracing::now()
+{
+    return clock().nsecsElapsed();
+}
+
+void Tracing::record(const char *name, qint64 startNs, qint64 endNs)
+{
+    Ring *ring = ringOfThisThread();
+    const quint64 head = ring->head.load(std::memory_order_relaxed);
+    ring->events[head % RING_SIZE] = {name, startNs, endNs};
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void Tracing::clear()
+{
+    // The recording threads keep their head: moving the mark instead of resetting the head cannot be undone by a concurrent record()
+    QMutexLocker locker(&ringsMutex);
+    for (Ring *ring : std::as_const(rings))
+        ring->clearedHead.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+QList<Tracing::Summary> Tracing::summaries()
+{
+    QList<Ring *> allRings;
+    {
+        QMutexLocker locker(&ringsMutex);
+        allRings = rings;
+    }
+
+    QHash<QByteArray, Summary> byName;
+    for (const Ring *ring : std::as_const(allRings)) {
+        const QList<Event> events = snapshot(ring);
+        for (const Event &event : events) {
+            Summary &summary = byName[QByteArray(event.name)];
+            const qint64 duration = event.endNs - event.startNs;
+            ++summary.count;
+            summary.totalNs += duration;
+            summary.maxNs = qMax(summary.maxNs, duration);
+        }
+    }
+
+    QList<Summary> result;
+    result.reserve(byName.size());
+    for (auto it = byName.begin(); it != byName.end(); ++it) {
+        it->name = QString::fromLatin1(it.key());
+        result.append(it.value());
+    }
+    std::sort(result.begin(), result.end(), [](const Summary &a, const Summary &b) {
+        return a.totalNs > b.totalNs;
+    });
+    return result;
+}
+
+QByteArray Tracing::chromeTrace()
+{
+    QList<Ring *> allRings;
+    {
+        QMutexLocker locker(&ringsMutex);
+        allRings = rings;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    for (const Ring *ring : std::as_const(allRings)) {
+        QString threadName;
+        {
+            QMutexLocker locker(&ringsMutex);
+            threadName = ring->threadName;
+        }
+        traceEvents.append(QJsonObject{{QStringLiteral("name"), QStringLiteral("thread_name")},
+                                       {QStringLiteral("ph"), QStringLiteral("M")},
+                                       {QStringLiteral("pid"), pid},
+                                       {QStringLiteral("tid"), ring->threadId},
+                                       {QStringLiteral("args"), QJsonObject{{QStringLiteral("name"), threadName}}}});
+
+        const QList<Event> events = snapshot(ring);
+        for (const Event &event : events) {
+            // Complete events ("X"), with times in microseconds:
+            traceEvents.append(QJsonObject{{QStringLiteral("name"), QString::fromLatin1(event.name)},
+                                           {QStringLiteral("ph"), QStringLiteral("X")},
+                                           {QStringLiteral("ts"), event.startNs / 1000.0},
+                                           {QStringLiteral("dur"), (event.endNs - event.startNs) / 1000.0},
+                                           {QStringLiteral("pid"), pid},
+                                           {QStringLiteral("tid"), ring->threadId}});
+        }
+    }
+
+    QJsonObject trace{{QStringLiteral("traceEvents"), traceEvents}, {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")}};
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+bool Tracing::saveChromeTrace(const QString &path)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(chromeTrace());
+    return file.commit();
+}
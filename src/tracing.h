@@ -0,0 +1,83 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Basket Developers
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+#include "basket_export.h"
+#include "config.h"
+
+/** Timing of the hot paths (loading, layout, drawing, filtering, saving...), for profiling.
+ * Put BASKET_TRACE("Class::method"); at the start of a scope: the time spent until the end of the scope is recorded as a span.
+ * Spans are only recorded while tracing is enabled (the debug window enables it), in a fixed-size ring buffer per thread,
+ * without any lock: only the last RING_SIZE spans of each thread are kept. The ring of a finished thread is reused by the next new one.
+ * With ENABLE_TRACING turned off in CMake, BASKET_TRACE() compiles to nothing.
+ */
+namespace Tracing
+{
+const int RING_SIZE = 8192;
+
+/// Summary of the recorded spans that have the same name
+struct Summary {
+    QString name;
+    int count = 0;
+    qint64 totalNs = 0;
+    qint64 maxNs = 0;
+};
+
+BASKET_EXPORT void setEnabled(bool enabled);
+BASKET_EXPORT bool isEnabled();
+
+/// Forget every recorded span. Can be called while other threads record spans
+BASKET_EXPORT void clear();
+
+/// Summaries of the spans still in the ring buffers, the most time-consuming first
+BASKET_EXPORT QList<Summary> summaries();
+
+/// The spans still in the ring buffers, in the Chrome trace-event format (to load in chrome://tracing or ui.perfetto.dev)
+BASKET_EXPORT QByteArray chromeTrace();
+BASKET_EXPORT bool saveChromeTrace(const QString &path);
+
+BASKET_EXPORT void record(const char *name, qint64 startNs, qint64 endNs);
+BASKET_EXPORT qint64 now();
+
+/// Record the time spent between its construction and its destruction. @p name must be a string literal
+class Span
+{
+public:
+    explicit Span(const char *name)
+        : m_name(name)
+        , m_start(isEnabled() ? now() : -1)
+    {
+    }
+    ~Span()
+    {
+        if (m_start >= 0)
+            record(m_name, m_start, now());
+    }
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+private:
+    const char *m_name;
+    qint64 m_start;
+};
+}
+
+#if ENABLE_TRACING
+#define BASKET_TRACE_CONCAT2(a, b) a##b
+#define BASKET_TRACE_CONCAT(a, b) BASKET_TRACE_CONCAT2(a, b)
+#define BASKET_TRACE(name) const Tracing::Span BASKET_TRACE_CONCAT(basketTraceSpan, __LINE__)(name)
+#else
+#define BASKET_TRACE(name) (void)0
+#endif
+
+#endif // TRACING_H
@@ -103,3 +103,19 @@ void XMLWork::setupXmlStream(QXmlStreamWriter &stream, QString startElement)
     stream.writeDTD(QStringLiteral("<!DOCTYPE ") + startElement + QLatin1Char('>'));
     stream.writeStartElement(startElement);
 }
+
+void XMLWork::writeElement(QXmlStreamWriter &stream, const QDomElement &element)
+{
+    stream.writeStartElement(element.tagName());
+    const QDomNamedNodeMap attributes = element.attributes();
+    for (int i = 0; i < attributes.count(); ++i) {
+        const QDomAttr attribute = attributes.item(i).toAttr();
+        stream.writeAttribute(attribute.name(), attribute.value());
+    }
+    for (QDomNode n = element.firstChild(); !n.isNull(); n = n.nextSibling())
+        if (n.isElement())
+            writeElement(stream, n.toElement());
+        else if (n.isText())
+            stream.writeCharacters(n.toText().data());
+    stream.writeEndElement();
+}
@@ -10,6 +10,8 @@
 #include <QString>
 #include <QXmlStreamWriter>
 
+#include "basket_export.h"
+
 class QDomDocument;
 class QDomElement;
 
@@ -25,10 +27,11 @@ QDomElement getElement(const QDomElement &startElement, const QString &elementPa
 QString getElementText(const QDomElement &startElement, const QString &elementPath, const QString &defaultTxt = QString());
 void addElement(QDomDocument &document, QDomElement &parent, const QString &name, const QString &text);
 QString innerXml(QDomElement &element);
-void setupXmlStream(QXmlStreamWriter &stream, QString startElement); ///< Set XML options and write document start
+BASKET_EXPORT void setupXmlStream(QXmlStreamWriter &stream, QString startElement); ///< Set XML options and write document start
+void writeElement(QXmlStreamWriter &stream, const QDomElement &element); ///< Write back an element read from a document, with its attributes and children
 // Not directly related to XML :
 bool trueOrFalse(const QString &value, bool defaultValue = true);
-QString trueOrFalse(bool value);
+BASKET_EXPORT QString trueOrFalse(bool value);
 }
 
 #endif // XMLWORKXMLWORK_H